@@ -2,16 +2,30 @@
 // SPDX-License-Identifier: MIT-0
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <stop_token>
+#include <string>
 #include <thread>
+#include <vector>
 
+#include <fmt/chrono.h>
 #include <fmt/ranges.h>
 #include <fmt/std.h>
 #include <gflags/gflags.h>
+#include <monitor/InterfaceSnapshots.hpp>
+#include <monitor/MonitorHub.hpp>
+#include <monitor/NamespaceMonitorPool.hpp>
 #include <monitor/NetworkInterfaceStatusTracker.hpp>
 #include <monitor/NetworkMonitor.hpp>
 #include <network/Address.hpp>
+#include <net/if.h>
 #include <network/Interface.hpp>
+#include <poll.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include <unistd.h>
@@ -25,6 +39,51 @@ DEFINE_bool(dumppackets, false, "Enable dumping of rtnl packets");
 DEFINE_bool(exit_after_enumeration, false, "Exit after enumeration is done");
 
 DEFINE_bool(include_non_ieee802, false, "Include non IEEE 802.X interfaces in the enumeration");
+DEFINE_bool(batched_receive, false, "Receive rtnl packets in batches using recvmmsg");
+DEFINE_bool(adaptive_receive_buffer, false, "Grow and shrink the receive buffer according to the received packets");
+DEFINE_bool(parallel_enumeration, false, "Run the link, address and route dumps at once on separate sockets");
+DEFINE_bool(dump_subscribed_interfaces_only,
+            false,
+            "Dump addresses and routes only for subscribed interfaces, applies to resyncs as the cli subscribes after "
+            "enumeration");
+DEFINE_bool(default_routes_only, false, "Track gateways of default routes in the main table only");
+DEFINE_bool(filter_events_in_kernel, false, "Drop unwanted change notifications in the kernel using a socket filter");
+DEFINE_bool(prioritize_link_events, false, "Receive link notifications on a separate socket drained first");
+DEFINE_bool(io_uring_receive, false, "Receive rtnl packets through a multishot receive of io_uring, if built with it");
+DEFINE_bool(pipelined_receive, false, "Receive rtnl packets on a separate thread, processing them on the main thread");
+DEFINE_uint64(receive_ring_depth, 64U, "How many packets the receive thread queues at most with --pipelined_receive");
+DEFINE_bool(sharded_processing, false, "Apply the messages of --batched_receive batches on a pool of threads");
+DEFINE_uint64(processing_shards, 0, "How many threads --sharded_processing uses, 0 takes one per core");
+DEFINE_bool(listen_all_namespaces, false, "Also monitor the interfaces of all network namespaces with an nsid");
+DEFINE_string(namespaces,
+              "",
+              "Comma separated network namespaces to monitor instead of the own one, by name in /run/netns or by path");
+DEFINE_uint64(namespace_threads, 0, "How many threads monitor the --namespaces, 0 takes one per core");
+DEFINE_uint64(hub_handles,
+              0,
+              "Share one monitor between this many handles of a hub, as components of a process would, the handles "
+              "narrow it down by the given filters and take turns preferring IPv4, IPv6 and no family unless one is "
+              "given");
+DEFINE_bool(publish_snapshots, false, "Publish interface snapshots and log them from a separate thread once a second");
+DEFINE_string(shared_snapshots,
+              "",
+              "Publish interface snapshots into shared memory created at this path, e.g. /dev/shm/monkas");
+DEFINE_string(read_shared_snapshots,
+              "",
+              "Instead of monitoring, log the snapshots another instance publishes with --shared_snapshots whenever "
+              "they change");
+DEFINE_bool(event_loop, false, "Drive the monitor from a poll loop using fileDescriptor() and processPending()");
+DEFINE_bool(ignore_addresses, false, "Subscribe without interest in addresses, leaving their multicast groups");
+DEFINE_bool(ignore_gateways, false, "Subscribe without interest in gateways, leaving the route multicast groups");
+DEFINE_bool(ignore_other_interfaces,
+            false,
+            "Subscribe without being told about interfaces other than the enumerated ones coming and going");
+DEFINE_string(match_interfaces,
+              "",
+              "Comma separated name globs, e.g. veth*,eth?, to subscribe to the matching interfaces, also the ones "
+              "added later, instead of the enumerated ones");
+DEFINE_uint64(receive_buffer_ceiling, 32U * 1024U, "Upper bound of the adaptive receive buffer in bytes");
+DEFINE_uint32(socket_receive_buffer, 0, "Socket receive buffer size in bytes, 0 keeps the kernel default");
 DEFINE_bool(log_to_file, false, "Enable logging to file");
 
 DEFINE_uint32(family, 0, "Preferred address family <0|4|6>");
@@ -46,6 +105,182 @@ using namespace monkas::network;
 // NOLINTNEXTLINE(google-build-*)
 using namespace monkas;
 
+namespace
+{
+/**
+ * @brief Stands in for the event loop of an application embedding the monitor, which never returns.
+ */
+[[noreturn]] void runEventLoop(NetworkMonitor& mon)
+{
+    pollfd pfd {mon.fileDescriptor(), POLLIN, 0};
+    while (true) {
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            spdlog::critical("poll failed: {}", std::strerror(errno));
+            std::exit(EXIT_FAILURE);
+        }
+        std::ignore = mon.processPending();
+    }
+}
+
+struct Sub final : monitor::Subscriber
+{
+    void onInterfaceAdded(const Interface& iface) override { spdlog::info("Interface added: {}", iface); }
+
+    void onInterfaceRemoved(const Interface& iface) override { spdlog::info("Interface removed: {}", iface); }
+
+    void onInterfaceNameChanged(const Interface& iface) override
+    {
+        spdlog::info("{} changed name to {}", iface, iface.name());
+    }
+
+    void onLinkFlagsChanged(const Interface& iface, const LinkFlags& flags) override
+    {
+        spdlog::info("{} changed link flags to {}", iface, flags);
+    }
+
+    void onOperationalStateChanged(const Interface& iface, OperationalState state) override
+    {
+        spdlog::info("{} changed operational state to {}", iface, state);
+    }
+
+    void onNetworkAddressesChanged(const Interface& iface, const Addresses& addresses) override
+    {
+        spdlog::info("{} changed addresses to {}", iface, fmt::join(addresses, ", "));
+    }
+
+    void onGatewayAddressChanged(const Interface& iface, const std::optional<ip::Address>& gateway) override
+    {
+        spdlog::info("{} changed gateway address to {}",
+                     iface,
+                     gateway.transform([](const auto& a) { return a.toString(); }).value_or("None"));
+    }
+
+    void onMacAddressChanged(const Interface& iface, const ethernet::Address& mac) override
+    {
+        spdlog::info("{} changed MAC address to {}", iface, mac);
+    }
+
+    void onBroadcastAddressChanged(const Interface& iface, const ethernet::Address& broadcast) override
+    {
+        spdlog::info("{} changed broadcast address to {}", iface, broadcast);
+    }
+};
+
+/**
+ * @brief Monitors the namespaces given by --namespaces instead of the own one, until killed.
+ */
+auto runNamespaceMonitorPool(const RuntimeFlags& options, const Tunables& tunables) -> int
+{
+    std::vector<std::string> paths;
+    for (const auto name : std::views::split(FLAGS_namespaces, ',')) {
+        const std::string path(name.begin(), name.end());
+        paths.push_back(path.contains('/') ? path : "/run/netns/" + path);
+    }
+    NamespaceMonitorPool pool(paths, options, tunables, FLAGS_namespace_threads);
+    pool.subscribe(std::make_shared<Sub>());
+    const auto intfs = pool.enumerateInterfaces();
+    const auto stats = pool.statistics();
+    spdlog::info("Found {} interfaces in {} of {} namespaces in {}",
+                 intfs.size(),
+                 stats.namespaces - stats.unavailableNamespaces,
+                 stats.namespaces,
+                 stats.startupDuration);
+    if (FLAGS_exit_after_enumeration) {
+        spdlog::info("Exiting after enumeration is done");
+        return EXIT_SUCCESS;
+    }
+    pool.run();
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Stands in for the components of a process sharing the monitor of a hub, until killed.
+ */
+auto runMonitorHub(const RuntimeFlags& options, const Tunables& tunables) -> int
+{
+    const auto hub = MonitorHub::processWide(tunables);
+    constexpr std::array FILTERS {RuntimeFlag::PreferredFamilyV4, RuntimeFlag::PreferredFamilyV6};
+    const auto familyGiven =
+        options.test(RuntimeFlag::PreferredFamilyV4) || options.test(RuntimeFlag::PreferredFamilyV6);
+    std::vector<std::unique_ptr<MonitorHub::Handle>> handles;
+    for (std::size_t i = 0; i < FLAGS_hub_handles; ++i) {
+        // the handles narrow down the hub by the options given
+        RuntimeFlags filters = options;
+        if (!familyGiven && i % (FILTERS.size() + 1) < FILTERS.size()) {
+            filters.set(FILTERS.at(i % (FILTERS.size() + 1)));
+        }
+        auto& handle = handles.emplace_back(hub->connect(filters));
+        handle->subscribe(handle->interfaces(), std::make_shared<Sub>());
+    }
+    spdlog::info("{} handles share one monitor", hub->handles());
+    if (FLAGS_exit_after_enumeration) {
+        spdlog::info("Exiting after enumeration is done");
+        return EXIT_SUCCESS;
+    }
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+/**
+ * @brief Stands in for a thread of an application reading the snapshots, without synchronizing with the monitor.
+ */
+auto readSnapshots(std::shared_ptr<const InterfaceSnapshots> snapshots, const Interfaces& intfs) -> std::jthread
+{
+    return std::jthread(
+        [snapshots = std::move(snapshots), intfs](const std::stop_token& stop)
+        {
+            while (!stop.stop_requested()) {
+                for (const auto& intf : intfs) {
+                    if (const auto snapshot = snapshots->find(intf.index()); snapshot.has_value()) {
+                        spdlog::info("Snapshot of {}: {}, addresses {}, gateway {}",
+                                     intf,
+                                     snapshot->operationalState,
+                                     fmt::join(snapshot->networkAddresses(), ", "),
+                                     snapshot->gatewayAddress.transform([](const auto& a) { return a.toString(); })
+                                         .value_or("None"));
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        });
+}
+
+/**
+ * @brief Stands in for another process reading the snapshots of a monitor, it only makes system calls to wait.
+ */
+auto readSharedSnapshots() -> int
+{
+    const auto snapshots = InterfaceSnapshots::openShared(FLAGS_read_shared_snapshots);
+    if (!snapshots) {
+        return EXIT_FAILURE;
+    }
+    constexpr auto WAIT_TIMEOUT = std::chrono::seconds(1);
+    auto generation = snapshots->generation();
+    while (!snapshots->isClosed()) {
+        // the indexes of the interfaces of the own namespace, as the snapshots are not enumerable
+        auto* const names = if_nameindex();
+        for (const auto* name = names; name != nullptr && name->if_index != 0; ++name) {
+            if (const auto snapshot = snapshots->find(name->if_index); snapshot.has_value()) {
+                spdlog::info("Shared snapshot {} of {}: {}, addresses {}",
+                             generation,
+                             snapshot->name(),
+                             snapshot->operationalState,
+                             fmt::join(snapshot->networkAddresses(), ", "));
+            }
+        }
+        if_freenameindex(names);
+        auto current = generation;
+        while (current == generation && !snapshots->isClosed()) {
+            current = snapshots->waitForChange(generation, WAIT_TIMEOUT);
+        }
+        generation = current;
+    }
+    spdlog::info("The publisher closed the shared snapshots");
+    return EXIT_SUCCESS;
+}
+}  // namespace
+
 /**
  * @brief Runs the rtnetlink network monitor CLI application.
  *
@@ -104,6 +339,57 @@ auto main(int argc, char* argv[]) -> int
     if (FLAGS_include_non_ieee802) {
         options.set(RuntimeFlag::IncludeNonIeee802);
     }
+    if (FLAGS_batched_receive) {
+        options.set(RuntimeFlag::BatchedReceive);
+    }
+    if (FLAGS_adaptive_receive_buffer) {
+        options.set(RuntimeFlag::AdaptiveReceiveBuffer);
+    }
+    if (FLAGS_parallel_enumeration) {
+        options.set(RuntimeFlag::ParallelEnumeration);
+    }
+    if (FLAGS_dump_subscribed_interfaces_only) {
+        options.set(RuntimeFlag::DumpSubscribedInterfacesOnly);
+    }
+    if (FLAGS_default_routes_only) {
+        options.set(RuntimeFlag::DefaultRoutesOnly);
+    }
+    if (FLAGS_filter_events_in_kernel) {
+        options.set(RuntimeFlag::FilterEventsInKernel);
+    }
+    if (FLAGS_prioritize_link_events) {
+        options.set(RuntimeFlag::PrioritizeLinkEvents);
+    }
+    if (FLAGS_io_uring_receive) {
+        options.set(RuntimeFlag::IoUringReceive);
+    }
+    if (FLAGS_pipelined_receive) {
+        options.set(RuntimeFlag::PipelinedReceive);
+    }
+    if (FLAGS_publish_snapshots) {
+        options.set(RuntimeFlag::PublishSnapshots);
+    }
+    if (FLAGS_sharded_processing) {
+        options.set(RuntimeFlag::ShardedProcessing);
+    }
+    if (FLAGS_listen_all_namespaces) {
+        options.set(RuntimeFlag::ListenAllNamespaces);
+    }
+    Tunables tunables;
+    tunables.receiveBufferCeiling = FLAGS_receive_buffer_ceiling;
+    tunables.receiveSocketBufferSize = static_cast<int>(FLAGS_socket_receive_buffer);
+    tunables.receiveRingDepth = FLAGS_receive_ring_depth;
+    tunables.processingShards = FLAGS_processing_shards;
+
+    if (!FLAGS_namespaces.empty()) {
+        return runNamespaceMonitorPool(options, tunables);
+    }
+    if (FLAGS_hub_handles > 0) {
+        return runMonitorHub(options, tunables);
+    }
+    if (!FLAGS_read_shared_snapshots.empty()) {
+        return readSharedSnapshots();
+    }
 
     if (FLAGS_enum_loop > 1 || FLAGS_enum_loop == 0) {
         auto loop = FLAGS_enum_loop;
@@ -114,69 +400,52 @@ auto main(int argc, char* argv[]) -> int
                 "Running enumeration loop {} times with loop delay of {}µs", FLAGS_enum_loop, FLAGS_loop_delay_us);
         }
         while (FLAGS_enum_loop == 0 || loop > 1) {
-            NetworkMonitor mon(options);
+            NetworkMonitor mon(options, tunables);
             std::ignore = mon.enumerateInterfaces();
             loop--;
             std::this_thread::sleep_for(std::chrono::microseconds(FLAGS_loop_delay_us));
         }
     }
 
-    NetworkMonitor mon(options);
+    NetworkMonitor mon(options, tunables);
+    if (!FLAGS_shared_snapshots.empty()) {
+        mon.publishSnapshotsTo(InterfaceSnapshots::createShared(FLAGS_shared_snapshots, tunables.snapshotCapacity));
+    }
 
     const auto intfs = mon.enumerateInterfaces();
     spdlog::info("Found {} interfaces: {}", intfs.size(), fmt::join(intfs, ", "));
 
-    struct Sub final : monitor::Subscriber
-    {
-        void onInterfaceAdded(const Interface& iface) override { spdlog::info("Interface added: {}", iface); }
-
-        void onInterfaceRemoved(const Interface& iface) override { spdlog::info("Interface removed: {}", iface); }
-
-        void onInterfaceNameChanged(const Interface& iface) override
-        {
-            spdlog::info("{} changed name to {}", iface, iface.name());
-        }
-
-        void onLinkFlagsChanged(const Interface& iface, const LinkFlags& flags) override
-        {
-            spdlog::info("{} changed link flags to {}", iface, flags);
-        }
-
-        void onOperationalStateChanged(const Interface& iface, OperationalState state) override
-        {
-            spdlog::info("{} changed operational state to {}", iface, state);
-        }
-
-        void onNetworkAddressesChanged(const Interface& iface, const Addresses& addresses) override
-        {
-            spdlog::info("{} changed addresses to {}", iface, fmt::join(addresses, ", "));
-        }
-
-        void onGatewayAddressChanged(const Interface& iface, const std::optional<ip::Address>& gateway) override
-        {
-            spdlog::info("{} changed gateway address to {}",
-                         iface,
-                         gateway.transform([](const auto& a) { return a.toString(); }).value_or("None"));
-        }
-
-        void onMacAddressChanged(const Interface& iface, const ethernet::Address& mac) override
-        {
-            spdlog::info("{} changed MAC address to {}", iface, mac);
-        }
-
-        void onBroadcastAddressChanged(const Interface& iface, const ethernet::Address& broadcast) override
-        {
-            spdlog::info("{} changed broadcast address to {}", iface, broadcast);
-        }
-    };
-
     auto sub = std::make_shared<Sub>();
-    mon.subscribe(intfs, sub);
+    auto interest = ChangedFlags::all();
+    if (FLAGS_ignore_addresses) {
+        interest.reset(ChangedFlag::NetworkAddresses);
+    }
+    if (FLAGS_ignore_gateways) {
+        interest.reset(ChangedFlag::GatewayAddress);
+    }
+    const auto events = FLAGS_ignore_other_interfaces ? InterfaceEvents {} : InterfaceEvents::all();
+    if (FLAGS_match_interfaces.empty()) {
+        mon.subscribe(intfs, sub, interest, events);
+    } else {
+        std::vector<InterfacePattern> patterns;
+        for (const auto glob : std::views::split(FLAGS_match_interfaces, ',')) {
+            patterns.push_back({.name = std::string(glob.begin(), glob.end())});
+        }
+        mon.subscribeMatching(patterns, sub, interest, events);
+    }
+    std::jthread snapshotReader;
+    if (const auto snapshots = mon.snapshots(); snapshots) {
+        snapshotReader = readSnapshots(snapshots, intfs);
+    }
     if (FLAGS_exit_after_enumeration) {
         spdlog::info("Exiting after enumeration is done");
         mon.stop();
     }
 
-    mon.run();
+    if (FLAGS_event_loop && !FLAGS_exit_after_enumeration) {
+        runEventLoop(mon);
+    } else {
+        mon.run();
+    }
     return EXIT_SUCCESS;
 }
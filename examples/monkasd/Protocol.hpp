@@ -0,0 +1,91 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief The messages monkasd sends its clients, one per SOCK_SEQPACKET record.
+ *
+ * Every message starts with a MessageHeader. A client first receives SnapshotBegin, an Interface message for every
+ * interface and SnapshotEnd, afterwards an Interface message whenever an interface changed and InterfaceRemoved once
+ * one is gone. An Interface message always carries the complete state of the interface, changed tells what changed
+ * since the client was sent the interface before, all of it for an interface it does not know. The changes of a client
+ * that does not keep up are coalesced, it is sent the latest state of the interfaces that changed meanwhile only.
+ *
+ * The structures have no implicit padding and are sent in the byte order of the host, as the socket is local.
+ * Addresses are in network byte order, IPv4 addresses take the first 4 bytes of their field.
+ */
+namespace monkasd::protocol
+{
+
+constexpr uint8_t VERSION = 1;
+
+enum class MessageType : uint8_t
+{
+    SnapshotBegin,
+    SnapshotEnd,
+    // followed by an InterfaceRecord and MessageHeader::addressCount AddressRecords
+    Interface,
+    InterfaceRemoved,
+};
+
+enum class Family : uint8_t
+{
+    None,
+    IPv4,
+    IPv6,
+};
+
+struct MessageHeader
+{
+    uint8_t version {VERSION};
+    MessageType type {};
+    uint16_t addressCount {};
+    // 0 for the snapshot markers
+    uint32_t ifIndex {};
+};
+
+struct InterfaceRecord
+{
+    // monitor::ChangedFlags
+    uint32_t changed {};
+    // monitor::LinkFlags
+    uint32_t linkFlags {};
+    // monitor::OperationalState
+    uint8_t operationalState {};
+    Family gatewayFamily {Family::None};
+    std::array<uint8_t, 6> macAddress {};
+    std::array<uint8_t, 6> broadcastAddress {};
+    // null terminated
+    std::array<char, 16> name {};
+    std::array<uint8_t, 16> gatewayAddress {};
+    std::array<uint8_t, 2> reserved {};
+};
+
+struct AddressRecord
+{
+    Family family {Family::None};
+    uint8_t prefixLength {};
+    // network::Scope
+    uint8_t scope {};
+    // network::AddressAssignmentProtocol
+    uint8_t protocol {};
+    // network::AddressFlags
+    uint32_t flags {};
+    std::array<uint8_t, 16> address {};
+    // all zeroes without a broadcast address
+    std::array<uint8_t, 16> broadcastAddress {};
+};
+
+static_assert(sizeof(MessageHeader) == 8 && sizeof(InterfaceRecord) == 56 && sizeof(AddressRecord) == 40,
+              "the records are read by clients in other languages, they must not change by accident");
+static_assert(std::is_trivially_copyable_v<MessageHeader> && std::is_trivially_copyable_v<InterfaceRecord>
+                  && std::is_trivially_copyable_v<AddressRecord>,
+              "the records are sent as they are in memory");
+
+}  // namespace monkasd::protocol
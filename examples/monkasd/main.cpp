@@ -0,0 +1,533 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fmt/ranges.h>
+#include <gflags/gflags.h>
+#include <monitor/NetworkMonitor.hpp>
+#include <network/Address.hpp>
+#include <network/Interface.hpp>
+#include <spdlog/spdlog.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Protocol.hpp"
+
+namespace
+{
+DEFINE_string(socket, "/run/monkasd.sock", "The path of the SOCK_SEQPACKET socket clients connect to");
+DEFINE_bool(client, false, "Instead of serving, connect to a running monkasd and log the messages it sends");
+DEFINE_bool(include_non_ieee802, false, "Include non IEEE 802.X interfaces");
+DEFINE_string(log_level, "info", "Set log level: trace, debug, info, warn, err, critical, off");
+}  // namespace
+
+// NOLINTNEXTLINE(google-build-*)
+using namespace monkas::monitor;
+// NOLINTNEXTLINE(google-build-*)
+using namespace monkas;
+namespace protocol = monkasd::protocol;
+
+namespace
+{
+// large enough for an interface with about 1600 addresses
+constexpr std::size_t MAX_MESSAGE_SIZE = 64U * 1024U;
+constexpr int MAX_EVENTS = 64;
+
+[[noreturn]] void pfatal(const char* msg)
+{
+    const auto err = errno;
+    spdlog::critical("{} failed: {}[{}]", msg, strerror(err), err);
+    std::exit(EXIT_FAILURE);
+}
+
+auto toFamily(const std::optional<ip::Address>& address) -> protocol::Family
+{
+    if (!address) {
+        return protocol::Family::None;
+    }
+    return address->isV4() ? protocol::Family::IPv4 : protocol::Family::IPv6;
+}
+
+void copyAddress(const std::optional<ip::Address>& address, std::array<uint8_t, ip::IPV6_ADDR_LEN>& field)
+{
+    if (address) {
+        std::ranges::copy(address->bytes(), field.begin());
+    }
+}
+
+template<typename Record>
+void append(std::vector<uint8_t>& buffer, const Record& record)
+{
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(Record));
+}
+
+struct InterfaceState
+{
+    std::string name;
+    LinkFlags linkFlags;
+    OperationalState operationalState {OperationalState::Unknown};
+    ethernet::Address macAddress;
+    ethernet::Address broadcastAddress;
+    std::optional<ip::Address> gatewayAddress;
+    Addresses networkAddresses;
+};
+
+/**
+ * @brief Keeps the state of every interface and serves it to the clients, with what changed of it for every client.
+ *
+ * Only the interfaces that changed since a client was last sent anything are remembered for it, with what changed of
+ * them. While a client does not keep up, the changes of an interface add up to a single message with its latest
+ * state, so a slow client never holds up the others or the monitor.
+ */
+class Daemon final : public Subscriber
+{
+  public:
+    explicit Daemon(const int epollFd)
+        : m_epollFd {epollFd}
+    {
+    }
+
+    ~Daemon() override
+    {
+        for (const auto& [fd, client] : m_clients) {
+            close(fd);
+        }
+    }
+
+    Daemon(const Daemon&) = delete;
+    Daemon(Daemon&&) = delete;
+    auto operator=(const Daemon&) -> Daemon& = delete;
+    auto operator=(Daemon&&) -> Daemon& = delete;
+
+    void onInterfaceAdded(const network::Interface& intf) override
+    {
+        m_states.try_emplace(intf.index());
+        changed(intf.index(), ChangedFlags::all());
+    }
+
+    void onInterfaceRemoved(const network::Interface& intf) override
+    {
+        m_states.erase(intf.index());
+        changed(intf.index(), ChangedFlags::all());
+    }
+
+    [[nodiscard]] auto wantsChangesBatch() const -> bool override { return true; }
+
+    /* @note: a client is told what changed of an interface at once, however many fields changed */
+    void onChangesBatch(const std::span<const InterfaceChange> changes) override
+    {
+        for (const auto& change : changes) {
+            const auto& tracker = *change.tracker;
+            // subscribing tells the full state of every interface, only what differs is sent
+            auto& state = m_states[change.interface.index()];
+            ChangedFlags flags;
+            update(change, flags, ChangedFlag::Name, state.name, change.interface.name());
+            update(change, flags, ChangedFlag::LinkFlags, state.linkFlags, tracker.linkFlags());
+            update(change, flags, ChangedFlag::OperationalState, state.operationalState, tracker.operationalState());
+            update(change, flags, ChangedFlag::NetworkAddresses, state.networkAddresses, tracker.networkAddresses());
+            update(change, flags, ChangedFlag::GatewayAddress, state.gatewayAddress, tracker.gatewayAddress());
+            update(change, flags, ChangedFlag::MacAddress, state.macAddress, tracker.macAddress());
+            update(change, flags, ChangedFlag::BroadcastAddress, state.broadcastAddress, tracker.broadcastAddress());
+            if (flags.any()) {
+                changed(change.interface.index(), flags);
+            }
+        }
+    }
+
+    /* @note: a new client is sent a snapshot of all interfaces first */
+    void accept(const int listenFd)
+    {
+        for (;;) {
+            const auto fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EINTR) {
+                    spdlog::warn("accept failed: {}", strerror(errno));
+                }
+                return;
+            }
+            auto& client = m_clients[fd];
+            for (const auto& [index, state] : m_states) {
+                client.pending.emplace(index, ChangedFlags::all());
+            }
+            watch(fd, EPOLL_CTL_ADD, EPOLLIN | EPOLLRDHUP);
+            spdlog::info("Client {} connected, serving {} clients", fd, m_clients.size());
+            flush(fd, client);
+        }
+    }
+
+    [[nodiscard]] auto isClient(const int fd) const -> bool { return m_clients.contains(fd); }
+
+    /* @note: clients are not expected to send anything, whatever they send is dropped */
+    void onClientEvent(const int fd, const uint32_t events)
+    {
+        auto& client = m_clients.at(fd);
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+            std::array<uint8_t, MAX_MESSAGE_SIZE> discard {};
+            const auto received = recv(fd, discard.data(), discard.size(), MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+                disconnect(fd);
+                return;
+            }
+        }
+        if ((events & EPOLLOUT) != 0) {
+            client.blocked = false;
+            watch(fd, EPOLL_CTL_MOD, EPOLLIN | EPOLLRDHUP);
+            flush(fd, client);
+        }
+    }
+
+    /* @note: sends every client what changed, as far as their sockets take it */
+    void flush()
+    {
+        for (auto it = m_clients.begin(); it != m_clients.end();) {
+            auto& [fd, client] = *it++;
+            flush(fd, client);
+        }
+    }
+
+  private:
+    struct Client
+    {
+        // the interfaces that changed since they were last sent to the client, with what changed of them
+        std::map<uint32_t, ChangedFlags> pending;
+        // until SnapshotBegin is sent, and until SnapshotEnd is sent
+        bool snapshotBegun {false};
+        bool inSnapshot {true};
+        // while waiting for the socket to become writable again
+        bool blocked {false};
+        // the changes that were merged into changes not sent yet
+        uint64_t coalesced {};
+    };
+
+    enum class SendResult : uint8_t
+    {
+        Sent,
+        Blocked,
+        Failed,
+    };
+
+    template<typename Value>
+    static void update(
+        const InterfaceChange& change, ChangedFlags& flags, const ChangedFlag flag, Value& field, const Value& value)
+    {
+        if (change.changed.test(flag) && field != value) {
+            field = value;
+            flags.set(flag);
+        }
+    }
+
+    void changed(const uint32_t ifIndex, const ChangedFlags& flags)
+    {
+        for (auto& [fd, client] : m_clients) {
+            const auto [it, inserted] = client.pending.try_emplace(ifIndex, flags);
+            if (!inserted) {
+                it->second = it->second | flags;
+                client.coalesced++;
+            }
+        }
+    }
+
+    void flush(const int fd, Client& client)
+    {
+        if (client.blocked) {
+            return;
+        }
+        if (!client.snapshotBegun) {
+            if (!send(fd, client, encodeMarker(protocol::MessageType::SnapshotBegin))) {
+                return;
+            }
+            client.snapshotBegun = true;
+        }
+        while (!client.pending.empty()) {
+            const auto it = client.pending.begin();
+            if (!send(fd, client, encode(it->first, it->second))) {
+                return;
+            }
+            client.pending.erase(it);
+        }
+        if (client.inSnapshot) {
+            if (!send(fd, client, encodeMarker(protocol::MessageType::SnapshotEnd))) {
+                return;
+            }
+            client.inSnapshot = false;
+        }
+    }
+
+    /* @note: false if the message was not sent, a client that failed is disconnected */
+    auto send(const int fd, Client& client, const std::span<const uint8_t> message) -> bool
+    {
+        switch (trySend(fd, message)) {
+            case SendResult::Sent:
+                return true;
+            case SendResult::Blocked:
+                client.blocked = true;
+                watch(fd, EPOLL_CTL_MOD, EPOLLIN | EPOLLRDHUP | EPOLLOUT);
+                return false;
+            case SendResult::Failed:
+                disconnect(fd);
+                return false;
+        }
+        return false;
+    }
+
+    static auto trySend(const int fd, const std::span<const uint8_t> message) -> SendResult
+    {
+        for (;;) {
+            if (::send(fd, message.data(), message.size(), MSG_DONTWAIT | MSG_NOSIGNAL) >= 0) {
+                return SendResult::Sent;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                return SendResult::Blocked;
+            }
+            spdlog::debug("send to client {} failed: {}", fd, strerror(errno));
+            return SendResult::Failed;
+        }
+    }
+
+    void disconnect(const int fd)
+    {
+        const auto it = m_clients.find(fd);
+        if (it == m_clients.end()) {
+            return;
+        }
+        spdlog::info("Client {} disconnected, {} of its changes were coalesced", fd, it->second.coalesced);
+        close(fd);
+        m_clients.erase(it);
+    }
+
+    void watch(const int fd, const int operation, const uint32_t events) const
+    {
+        epoll_event event {.events = events, .data = {.fd = fd}};
+        if (epoll_ctl(m_epollFd, operation, fd, &event) < 0) {
+            pfatal("epoll_ctl");
+        }
+    }
+
+    auto encodeMarker(const protocol::MessageType type) -> std::span<const uint8_t>
+    {
+        m_buffer.clear();
+        append(m_buffer, protocol::MessageHeader {.type = type});
+        return m_buffer;
+    }
+
+    /* @note: an interface without a state is gone */
+    auto encode(const uint32_t ifIndex, const ChangedFlags& changed) -> std::span<const uint8_t>
+    {
+        m_buffer.clear();
+        const auto it = m_states.find(ifIndex);
+        if (it == m_states.end()) {
+            append(m_buffer,
+                   protocol::MessageHeader {.type = protocol::MessageType::InterfaceRemoved, .ifIndex = ifIndex});
+            return m_buffer;
+        }
+        const auto& state = it->second;
+        constexpr auto MAX_ADDRESSES =
+            (MAX_MESSAGE_SIZE - sizeof(protocol::MessageHeader) - sizeof(protocol::InterfaceRecord))
+            / sizeof(protocol::AddressRecord);
+        const auto addressCount = std::min(state.networkAddresses.size(), MAX_ADDRESSES);
+        append(m_buffer,
+               protocol::MessageHeader {.type = protocol::MessageType::Interface,
+                                        .addressCount = static_cast<uint16_t>(addressCount),
+                                        .ifIndex = ifIndex});
+        protocol::InterfaceRecord record {
+            .changed = changed.toU32(),
+            .linkFlags = state.linkFlags.toU32(),
+            .operationalState = static_cast<uint8_t>(state.operationalState),
+            .gatewayFamily = toFamily(state.gatewayAddress),
+            .macAddress = state.macAddress.bytes(),
+            .broadcastAddress = state.broadcastAddress.bytes(),
+        };
+        std::copy_n(state.name.begin(), std::min(state.name.size(), record.name.size() - 1), record.name.begin());
+        copyAddress(state.gatewayAddress, record.gatewayAddress);
+        append(m_buffer, record);
+        for (const auto& address : state.networkAddresses | std::views::take(addressCount)) {
+            protocol::AddressRecord addressRecord {
+                .family = toFamily(address.ip()),
+                .prefixLength = address.prefixLength(),
+                .scope = static_cast<uint8_t>(address.scope()),
+                .protocol = static_cast<uint8_t>(address.addressAssignmentProtocol()),
+                .flags = address.flags().toU32(),
+            };
+            copyAddress(address.ip(), addressRecord.address);
+            copyAddress(address.broadcast(), addressRecord.broadcastAddress);
+            append(m_buffer, addressRecord);
+        }
+        return m_buffer;
+    }
+
+    int m_epollFd;
+    std::map<uint32_t, InterfaceState> m_states;
+    std::map<int, Client> m_clients;
+    // reused for every message
+    std::vector<uint8_t> m_buffer;
+};
+
+auto socketAddress() -> sockaddr_un
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (FLAGS_socket.size() >= sizeof(address.sun_path)) {
+        spdlog::critical("Socket path {} is too long", FLAGS_socket);
+        std::exit(EXIT_FAILURE);
+    }
+    std::ranges::copy(FLAGS_socket, std::begin(address.sun_path));
+    return address;
+}
+
+/**
+ * @brief Stands in for a client of the daemon, which would usually be written in another language.
+ */
+auto runClient() -> int
+{
+    const auto fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    const auto address = socketAddress();
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        pfatal("connect");
+    }
+    std::vector<uint8_t> message(MAX_MESSAGE_SIZE);
+    for (;;) {
+        const auto received = recv(fd, message.data(), message.size(), 0);
+        if (received <= 0) {
+            spdlog::info("monkasd closed the connection");
+            return EXIT_SUCCESS;
+        }
+        protocol::MessageHeader header;
+        std::memcpy(&header, message.data(), sizeof(header));
+        switch (header.type) {
+            case protocol::MessageType::SnapshotBegin:
+                spdlog::info("Snapshot begins");
+                break;
+            case protocol::MessageType::SnapshotEnd:
+                spdlog::info("Snapshot ends");
+                break;
+            case protocol::MessageType::InterfaceRemoved:
+                spdlog::info("Interface {} removed", header.ifIndex);
+                break;
+            case protocol::MessageType::Interface: {
+                protocol::InterfaceRecord record;
+                std::memcpy(&record, message.data() + sizeof(header), sizeof(record));
+                spdlog::info("Interface {} {}: changed {}, {}, {} addresses",
+                             header.ifIndex,
+                             record.name.data(),
+                             ChangedFlags {record.changed},
+                             static_cast<OperationalState>(record.operationalState),
+                             header.addressCount);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Serves the interfaces of one monitor to all clients until SIGINT or SIGTERM.
+ */
+auto runDaemon() -> int
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    const auto signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    const auto listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const auto address = socketAddress();
+    unlink(FLAGS_socket.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0
+        || listen(listenFd, SOMAXCONN) < 0)
+    {
+        pfatal("listen");
+    }
+
+    RuntimeFlags options;
+    if (FLAGS_include_non_ieee802) {
+        options.set(RuntimeFlag::IncludeNonIeee802);
+    }
+    NetworkMonitor mon(options);
+    const auto epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0 || signalFd < 0) {
+        pfatal("epoll_create1");
+    }
+    auto daemon = std::make_shared<Daemon>(epollFd);
+    for (const auto fd : {mon.fileDescriptor(), listenFd, signalFd}) {
+        epoll_event event {.events = EPOLLIN, .data = {.fd = fd}};
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            pfatal("epoll_ctl");
+        }
+    }
+
+    const auto intfs = mon.enumerateInterfaces();
+    // an empty pattern matches every interface, the present ones and the ones added later
+    mon.subscribeMatching({InterfacePattern {}}, daemon);
+    spdlog::info("Serving {} interfaces on {}", intfs.size(), FLAGS_socket);
+
+    std::array<epoll_event, MAX_EVENTS> events {};
+    bool running = true;
+    while (running) {
+        const auto ready = epoll_wait(epollFd, events.data(), MAX_EVENTS, -1);
+        if (ready < 0 && errno != EINTR) {
+            pfatal("epoll_wait");
+        }
+        for (const auto& event : std::span(events).first(static_cast<std::size_t>(std::max(ready, 0)))) {
+            if (event.data.fd == mon.fileDescriptor()) {
+                std::ignore = mon.processPending();
+            } else if (event.data.fd == listenFd) {
+                daemon->accept(listenFd);
+            } else if (event.data.fd == signalFd) {
+                running = false;
+            } else if (daemon->isClient(event.data.fd)) {
+                daemon->onClientEvent(event.data.fd, event.events);
+            }
+        }
+        daemon->flush();
+    }
+    spdlog::info("Stopping");
+    unlink(FLAGS_socket.c_str());
+    close(listenFd);
+    close(signalFd);
+    close(epollFd);
+    return EXIT_SUCCESS;
+}
+}  // namespace
+
+/**
+ * @brief Runs one network monitor for many local clients, see Protocol.hpp for what they are sent.
+ */
+auto main(int argc, char* argv[]) -> int
+{
+    gflags::SetUsageMessage("<flags>\n");
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    std::ranges::transform(FLAGS_log_level, FLAGS_log_level.begin(), ::tolower);
+    if (const auto level = spdlog::level::from_str(FLAGS_log_level);
+        level == spdlog::level::off && FLAGS_log_level != "off")
+    {
+        SPDLOG_ERROR("invalid log level '{}', using 'info' instead", FLAGS_log_level);
+        spdlog::set_level(spdlog::level::info);
+    } else {
+        spdlog::set_level(level);
+    }
+    if (FLAGS_client) {
+        return runClient();
+    }
+    return runDaemon();
+}
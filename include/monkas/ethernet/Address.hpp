@@ -26,6 +26,8 @@ class Address
     [[nodiscard]] auto isBroadcast() const -> bool;
     [[nodiscard]] auto toString() const -> std::string;
 
+    [[nodiscard]] auto bytes() const -> const Bytes& { return m_bytes; }
+
     auto operator<=>(const Address& other) const noexcept = default;
     auto operator==(const Address& other) const noexcept -> bool = default;
 
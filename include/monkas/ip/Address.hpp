@@ -7,6 +7,7 @@
 #include <compare>
 #include <cstddef>
 #include <iosfwd>
+#include <span>
 #include <string>
 #include <variant>
 
@@ -53,6 +54,8 @@ class Address
     [[nodiscard]] auto isBroadcast() const -> bool;
 
     [[nodiscard]] auto family() const -> Family;
+    // in network byte order, 4 bytes for IPv4 and 16 for IPv6
+    [[nodiscard]] auto bytes() const -> std::span<const uint8_t>;
 
     [[nodiscard]] auto operator<=>(const Address& rhs) const = default;
     [[nodiscard]] auto operator==(const Address& rhs) const -> bool = default;
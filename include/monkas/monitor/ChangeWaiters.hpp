@@ -0,0 +1,117 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <monitor/NetworkInterfaceStatusTracker.hpp>
+#include <network/Interface.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief What a coroutine waiting for changes of an interface is resumed with, and what Subscriber::onChangesBatch()
+ * is told for every changed interface.
+ */
+struct InterfaceChange
+{
+    network::Interface interface;
+    // the changes waited for or subscribed to that happened, none if the interface was removed
+    ChangedFlags changed;
+    // the state after the changes, valid until the coroutine suspends again or the batch callback returns, nullptr if
+    // the interface was removed
+    const NetworkInterfaceStatusTracker* tracker {nullptr};
+};
+
+class ChangeWaiters;
+
+/**
+ * @brief Suspends a coroutine until one of the given changes of an interface was notified, see
+ * NetworkMonitor::nextChange().
+ *
+ * Destroying a suspended coroutine stops waiting.
+ */
+class ChangeAwaiter
+{
+  public:
+    ChangeAwaiter(ChangeWaiters& waiters, const network::Interface& intf, const ChangedFlags& interest);
+    ~ChangeAwaiter();
+    ChangeAwaiter(const ChangeAwaiter&) = delete;
+    ChangeAwaiter(ChangeAwaiter&&) = delete;
+    auto operator=(const ChangeAwaiter&) -> ChangeAwaiter& = delete;
+    auto operator=(ChangeAwaiter&&) -> ChangeAwaiter& = delete;
+
+    [[nodiscard]] static auto await_ready() noexcept -> bool { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    [[nodiscard]] auto await_resume() const -> InterfaceChange { return m_change; }
+
+  private:
+    friend class ChangeWaiters;
+
+    enum class State : uint8_t
+    {
+        Idle,
+        Waiting,
+        Resuming,
+    };
+
+    ChangeWaiters* m_waiters;
+    ChangedFlags m_interest;
+    std::coroutine_handle<> m_handle;
+    InterfaceChange m_change;
+    State m_state {State::Idle};
+};
+
+/**
+ * @brief Keeps track of the coroutines waiting for changes, by interface.
+ *
+ * Coroutines are resumed right from the notification of the changes they wait for, in the order they started waiting.
+ * Those still waiting when the waiters are destroyed are never resumed.
+ */
+class ChangeWaiters
+{
+  public:
+    ChangeWaiters() = default;
+    ~ChangeWaiters();
+    ChangeWaiters(const ChangeWaiters&) = delete;
+    ChangeWaiters(ChangeWaiters&&) = delete;
+    auto operator=(const ChangeWaiters&) -> ChangeWaiters& = delete;
+    auto operator=(ChangeWaiters&&) -> ChangeWaiters& = delete;
+
+    [[nodiscard]] auto empty() const -> bool { return m_count == 0; }
+
+    [[nodiscard]] auto size() const -> std::size_t { return m_count; }
+
+    // resumes the coroutines waiting for any of the changes the tracker reports
+    void resume(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker);
+    // resumes the coroutines waiting for any of the given changes, e.g. of a tracker whose changes were cleared already
+    void resume(const network::Interface& intf,
+                const NetworkInterfaceStatusTracker& tracker,
+                const ChangedFlags& changed);
+    // resumes every coroutine waiting for the interface
+    void resumeRemoved(const network::Interface& intf);
+
+  private:
+    friend class ChangeAwaiter;
+
+    void add(ChangeAwaiter* awaiter);
+    void remove(ChangeAwaiter* awaiter);
+    void resume(const network::Interface& intf,
+                const NetworkInterfaceStatusTracker* tracker,
+                const ChangedFlags& changed);
+
+    std::map<network::Interface, std::vector<ChangeAwaiter*>> m_waiting;
+    // awaiters taken from m_waiting but not resumed yet, entries of destroyed ones are reset
+    std::vector<ChangeAwaiter*> m_resuming;
+    std::size_t m_count {};
+};
+
+}  // namespace monkas::monitor
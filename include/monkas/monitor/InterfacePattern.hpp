@@ -0,0 +1,34 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include <monitor/NetworkInterfaceStatusTracker.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Which interfaces a subscription by patterns matches, see NetworkMonitor::subscribeMatching().
+ *
+ * An interface matches if it satisfies every predicate of the pattern, an empty predicate is satisfied by every
+ * interface. The predicates are checked when the interface is learned, and again when its name or link flags change.
+ */
+struct InterfacePattern
+{
+    // a glob of the name, * matches any number of characters and ? exactly one, e.g. veth* or eth?
+    std::string name {};
+    // ARPHRD_* types of the link, e.g. ARPHRD_ETHER
+    std::set<uint16_t> linkTypes {};
+    // IFLA_INFO_KIND of the link, e.g. veth or bridge, links without a kind match none
+    std::set<std::string> linkKinds {};
+    // the link flags an interface must have all of, and the ones it must have none of
+    NetworkInterfaceStatusTracker::LinkFlags requiredFlags {};
+    NetworkInterfaceStatusTracker::LinkFlags excludedFlags {};
+};
+
+}  // namespace monkas::monitor
@@ -0,0 +1,150 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <ethernet/Address.hpp>
+#include <ip/Address.hpp>
+#include <monitor/NetworkInterfaceStatusTracker.hpp>
+#include <network/Address.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief A copy of the state of an interface, as of the last batch of changes the monitor processed.
+ */
+struct InterfaceSnapshot
+{
+    // IFNAMSIZ, including the terminating null character
+    static constexpr std::size_t MAX_NAME_SIZE = 16;
+    static constexpr std::size_t MAX_ADDRESSES = 16;
+
+    [[nodiscard]] auto name() const -> std::string_view { return {nameBuffer.data()}; }
+
+    [[nodiscard]] auto networkAddresses() const -> std::span<const network::Address>
+    {
+        return {addressBuffer.data(), addressCount};
+    }
+
+    uint32_t index {};
+    std::array<char, MAX_NAME_SIZE> nameBuffer {};
+    NetworkInterfaceStatusTracker::OperationalState operationalState {
+        NetworkInterfaceStatusTracker::OperationalState::Unknown};
+    NetworkInterfaceStatusTracker::LinkFlags linkFlags;
+    ethernet::Address macAddress;
+    ethernet::Address broadcastAddress;
+    std::optional<ip::Address> gatewayAddress;
+    // the first MAX_ADDRESSES network addresses in the order of the tracker
+    std::array<network::Address, MAX_ADDRESSES> addressBuffer {};
+    std::size_t addressCount {};
+    // whether the interface has more network addresses than fit
+    bool addressesTruncated {false};
+};
+
+/**
+ * @brief Per interface snapshots the monitor publishes for other threads, see NetworkMonitor::snapshots().
+ *
+ * Readers on any thread look up an interface without locks and get a consistent snapshot. The monitor never waits for
+ * them, a reader copies a snapshot again if the monitor published a newer one of the same interface meanwhile.
+ * Interfaces are found by index, resolve a name once with network::Interface::fromName().
+ *
+ * The snapshots can as well be kept in shared memory, see createShared(), for other processes to read them the same
+ * way through openShared(), without any system call.
+ */
+class InterfaceSnapshots
+{
+  public:
+    /* @note: the capacity is rounded up to a power of two */
+    explicit InterfaceSnapshots(std::size_t capacity);
+    ~InterfaceSnapshots();
+    InterfaceSnapshots(const InterfaceSnapshots&) = delete;
+    InterfaceSnapshots(InterfaceSnapshots&&) = delete;
+    auto operator=(const InterfaceSnapshots&) -> InterfaceSnapshots& = delete;
+    auto operator=(InterfaceSnapshots&&) -> InterfaceSnapshots& = delete;
+
+    /**
+     * @brief Creates snapshots in a shared memory segment, to be published by a monitor, see
+     * NetworkMonitor::publishSnapshotsTo().
+     *
+     * @param path the file to create the segment as, e.g. /dev/shm/monkas, an existing file is replaced. An empty path
+     * creates an anonymous segment, which other processes open through /proc/<pid>/fd/<sharedMemoryFd()> or a
+     * descriptor passed to them.
+     * @return nullptr if the segment could not be created.
+     */
+    static auto createShared(const std::string& path, std::size_t capacity) -> std::shared_ptr<InterfaceSnapshots>;
+
+    /**
+     * @brief Opens the snapshots another process publishes in shared memory, read only.
+     *
+     * @return nullptr if the segment could not be opened or was not created by createShared() of this version.
+     */
+    static auto openShared(const std::string& path) -> std::shared_ptr<const InterfaceSnapshots>;
+
+    /* @note: the descriptor of a shared memory segment, -1 if the snapshots are not shared */
+    [[nodiscard]] auto sharedMemoryFd() const -> int;
+
+    /* @note: thread safe, std::nullopt if the interface is not known */
+    [[nodiscard]] auto find(uint32_t ifIndex) const -> std::optional<InterfaceSnapshot>;
+
+    [[nodiscard]] auto capacity() const -> std::size_t { return m_capacity; }
+
+    /* @note: thread safe */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /* @note: thread safe, changes once per batch of changes the monitor published, see commit() */
+    [[nodiscard]] auto generation() const -> uint32_t;
+
+    /**
+     * @brief Waits until the generation is no longer the given one, also in another process than the monitor.
+     *
+     * @return the current generation, unchanged if the timeout passed.
+     * @note: the waiting is done on a futex shared between processes, finding snapshots needs no system call
+     */
+    auto waitForChange(uint32_t generation, std::chrono::milliseconds timeout) const -> uint32_t;
+
+    /* @note: thread safe, whether the monitor publishing into shared memory is done with the segment */
+    [[nodiscard]] auto isClosed() const -> bool;
+
+    /**
+     * @brief Publishes the current state of an interface, for the thread running the monitor only.
+     *
+     * @return false if all slots are taken by other interfaces.
+     */
+    auto publish(uint32_t ifIndex, const NetworkInterfaceStatusTracker& tracker) -> bool;
+    // for the thread running the monitor only
+    void remove(uint32_t ifIndex);
+    // for the thread running the monitor only, completes a batch of changes and wakes the waiting readers
+    void commit();
+
+  private:
+    struct Header;
+    struct Slot;
+    struct Storage;
+
+    InterfaceSnapshots(std::unique_ptr<Storage> storage, std::size_t capacity);
+
+    [[nodiscard]] auto allocateSlot(uint32_t ifIndex) -> Slot*;
+
+    std::size_t m_capacity;
+    // the header and the slots, on the heap or in shared memory
+    std::unique_ptr<Storage> m_storage;
+    Header* m_header;
+    Slot* m_slots;
+    // the slots of the published interfaces, the writer's own index
+    std::unordered_map<uint32_t, Slot*> m_published;
+};
+
+}  // namespace monkas::monitor
@@ -0,0 +1,45 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Counts latencies in power of two buckets of microseconds, cheap enough to record every change notification.
+ *
+ * Percentiles are reported as the upper bound of the bucket they fall into, the last bucket is bounded by the maximum.
+ */
+class LatencyHistogram
+{
+  public:
+    using Duration = std::chrono::microseconds;
+
+    // bucket 0 counts latencies below 1µs, bucket i those below 2^i µs, the last one everything above
+    static constexpr std::size_t BUCKET_COUNT = 24;
+
+    void record(Duration latency);
+
+    [[nodiscard]] auto count() const -> uint64_t { return m_count; }
+
+    [[nodiscard]] auto max() const -> Duration { return m_max; }
+
+    /* @note: expects a fraction between 0 and 1, returns 0 if nothing was recorded */
+    [[nodiscard]] auto percentile(double fraction) const -> Duration;
+
+    // merges the latencies recorded by another histogram, e.g. of another monitor
+    auto operator+=(const LatencyHistogram& other) -> LatencyHistogram&;
+
+  private:
+    std::array<uint64_t, BUCKET_COUNT> m_buckets {};
+    uint64_t m_count {};
+    Duration m_max {};
+};
+
+}  // namespace monkas::monitor
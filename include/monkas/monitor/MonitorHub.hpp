@@ -0,0 +1,131 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include <monitor/NetworkMonitor.hpp>
+#include <network/Interface.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Shares one NetworkMonitor, its netlink socket, its multicast groups and its cache, between the components
+ * of a process.
+ *
+ * The hub enumerates once and runs the monitor on a thread of its own. Every component connects for a Handle of its
+ * own, which subscribes through the hub and narrows down what its subscribers are told by filters of its own. A handle
+ * connecting late is told the state of its interfaces from the cache, without another dump.
+ */
+class MonitorHub : public std::enable_shared_from_this<MonitorHub>
+{
+  public:
+    class Handle;
+
+    /* @note: the options of the monitor, handles can only narrow them down, so they include everything by default */
+    static auto create(const RuntimeFlags& options = defaultOptions(), const Tunables& tunables = {})
+        -> std::shared_ptr<MonitorHub>;
+
+    /* @note: thread safe, the hub of the process, created with defaultOptions() for the handles of every component to
+     * narrow down, and the tunables of the first caller */
+    static auto processWide(const Tunables& tunables = {}) -> std::shared_ptr<MonitorHub>;
+
+    // IncludeNonIeee802 without a preferred family
+    static auto defaultOptions() -> RuntimeFlags;
+
+    /* @note: must not be destroyed from a subscriber, as that runs on the thread of the hub */
+    ~MonitorHub();
+    MonitorHub(const MonitorHub&) = delete;
+    MonitorHub(MonitorHub&&) = delete;
+    auto operator=(const MonitorHub&) -> MonitorHub& = delete;
+    auto operator=(MonitorHub&&) -> MonitorHub& = delete;
+
+    /**
+     * @brief A handle for a component, which keeps the hub alive.
+     *
+     * @param filters RuntimeFlag::IncludeNonIeee802, PreferredFamilyV4 and PreferredFamilyV6, in addition to the
+     * options of the hub, the other flags are ignored.
+     * @note: thread safe
+     */
+    auto connect(const RuntimeFlags& filters = {}) -> std::unique_ptr<Handle>;
+
+    [[nodiscard]] auto options() const -> const RuntimeFlags& { return m_options; }
+
+    /* @note: thread safe */
+    [[nodiscard]] auto handles() const -> std::size_t { return m_handles.load(std::memory_order_relaxed); }
+
+    /* @note: thread safe */
+    [[nodiscard]] auto statistics() const -> NetworkMonitor::Statistics;
+
+  private:
+    class FilteringSubscriber;
+
+    MonitorHub(const RuntimeFlags& options, const Tunables& tunables);
+
+    void run(const std::stop_token& stop);
+
+    RuntimeFlags m_options;
+    // serializes the thread of the hub with the handles, recursive for handles used from subscribers, the monitor
+    // keeps the filtering subscribers of a handle alive while it calls them
+    mutable std::recursive_mutex m_mutex;
+    std::unique_ptr<NetworkMonitor> m_monitor;
+    std::atomic<std::size_t> m_handles {0};
+    // declared last, so it is stopped before the monitor is destroyed
+    std::jthread m_thread;
+};
+
+/**
+ * @brief The subscriptions of a component through a MonitorHub, dropped with the handle.
+ *
+ * The subscribers are called on the thread of the hub, one call at a time across all handles.
+ */
+class MonitorHub::Handle
+{
+  public:
+    /* @note: must not be destroyed from a subscriber */
+    ~Handle();
+    Handle(const Handle&) = delete;
+    Handle(Handle&&) = delete;
+    auto operator=(const Handle&) -> Handle& = delete;
+    auto operator=(Handle&&) -> Handle& = delete;
+
+    /* @note: thread safe, the interfaces that pass the filters, from the cache */
+    [[nodiscard]] auto interfaces() const -> Interfaces;
+
+    /**
+     * @brief Subscribes to the given interfaces that pass the filters, told their current state from the cache first.
+     *
+     * Through a handle with a preferred family a batch of changes tells copies of the changed interfaces without the
+     * addresses and gateways of the other family. Interest in addresses or gateways that no other subscriber of the hub
+     * has costs the shared monitor a dump of all of them, and the subscriber is told nothing before it ends.
+     * @note: thread safe, also from a subscriber, a subscriber of this handle is subscribed anew
+     */
+    void subscribe(const Interfaces& interfaces,
+                   const SubscriberPtr& subscriber,
+                   const ChangedFlags& interest = ChangedFlags::all(),
+                   const InterfaceEvents& events = InterfaceEvents::all());
+    /* @note: thread safe, also from a subscriber, which may unsubscribe itself */
+    void unsubscribe(const SubscriberPtr& subscriber);
+
+    [[nodiscard]] auto filters() const -> const RuntimeFlags& { return m_filters; }
+
+  private:
+    friend class MonitorHub;
+
+    Handle(std::shared_ptr<MonitorHub> hub, const RuntimeFlags& filters);
+
+    std::shared_ptr<MonitorHub> m_hub;
+    RuntimeFlags m_filters;
+    // the subscribers of the handle, with the filter they are subscribed to the monitor through
+    std::map<SubscriberPtr, std::shared_ptr<FilteringSubscriber>> m_subscribers;
+};
+
+}  // namespace monkas::monitor
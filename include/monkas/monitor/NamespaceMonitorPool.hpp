@@ -0,0 +1,129 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <monitor/NetworkMonitor.hpp>
+#include <network/Interface.hpp>
+
+namespace monkas::util
+{
+class WorkStealingPool;
+}  // namespace monkas::util
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Monitors many network namespaces at once, with a NetworkMonitor of their own each, on a fixed pool of threads.
+ *
+ * The monitors are opened within their namespace through setns and enumerate all namespaces in parallel. Afterwards the
+ * monitors with pending notifications are processed as tasks of a work stealing pool, at most one task per monitor at
+ * a time. The notifications of all namespaces are merged into a single stream, the interfaces carry the position of
+ * their namespace in the list the pool was given as namespaceId().
+ */
+class NamespaceMonitorPool
+{
+  public:
+    struct Statistics
+    {
+        std::size_t namespaces {};
+        // the namespaces that could not be entered, or were not yet, and are not monitored
+        std::size_t unavailableNamespaces {};
+        // how long enumerating all namespaces took
+        std::chrono::milliseconds startupDuration {};
+        uint64_t tasksRun {};
+        uint64_t tasksStolen {};
+        // the statistics of all monitors added up
+        NetworkMonitor::Statistics monitors;
+    };
+
+    /**
+     * @param namespaces the network namespaces by path, e.g. /run/netns/<name> or /proc/<pid>/ns/net. Entering them
+     * needs CAP_SYS_ADMIN.
+     * @param threads the threads of the pool, 0 takes one per core.
+     * @note: RuntimeFlag::ListenAllNamespaces is ignored, the interfaces are tagged by the pool.
+     */
+    NamespaceMonitorPool(std::vector<std::string> namespaces,
+                         const RuntimeFlags& options,
+                         const Tunables& tunables = {},
+                         std::size_t threads = 0);
+    ~NamespaceMonitorPool();
+    NamespaceMonitorPool(const NamespaceMonitorPool&) = delete;
+    NamespaceMonitorPool(NamespaceMonitorPool&&) = delete;
+    auto operator=(const NamespaceMonitorPool&) -> NamespaceMonitorPool& = delete;
+    auto operator=(NamespaceMonitorPool&&) -> NamespaceMonitorPool& = delete;
+
+    /**
+     * @brief Opens and enumerates the monitors of all namespaces in parallel, once.
+     *
+     * @return the interfaces of all namespaces.
+     */
+    auto enumerateInterfaces() -> Interfaces;
+
+    /**
+     * @brief Subscribes to the changes of all interfaces of all namespaces.
+     *
+     * The subscribers are called on the threads of the pool, but one call at a time, also while enumerating. Subscribe
+     * before enumerateInterfaces() to be told the initial state of every interface.
+     * @note: must not be called from a subscriber
+     */
+    void subscribe(const SubscriberPtr& subscriber);
+    /* @note: must not be called from a subscriber */
+    void unsubscribe(const SubscriberPtr& subscriber);
+
+    /* @note: enumerates first if that did not happen yet, processes the notifications until stop() */
+    void run();
+    /* @note: thread safe, also from a subscriber */
+    void stop();
+
+    /* @note: the path of the namespace an interface belongs to, given its namespaceId() */
+    [[nodiscard]] auto namespacePath(int32_t namespaceId) const -> const std::string&;
+
+    /* @note: thread safe, the statistics of the monitors are as of the last time they processed something */
+    [[nodiscard]] auto statistics() const -> Statistics;
+
+  private:
+    struct Namespace;
+    class Forwarder;
+
+    void openMonitor(Namespace& ns);
+    void process(Namespace& ns);
+    void watch(const Namespace& ns, int operation) const;
+    void updateStatistics(Namespace& ns);
+
+    template<typename Notify>
+    void forward(const Notify& notify);
+
+    RuntimeFlags m_options;
+    Tunables m_tunables;
+    // the namespace of the thread that created the pool, the threads of the pool return to it
+    int m_ownNamespaceFd {-1};
+    // watches the monitors with pending notifications and the wakeup of stop()
+    int m_epollFd {-1};
+    int m_wakeupFd {-1};
+    std::atomic<bool> m_stopRequested {false};
+    bool m_enumerated {false};
+    std::atomic<std::chrono::milliseconds> m_startupDuration {};
+    // the tasks of run() still processing a monitor
+    std::atomic<std::size_t> m_inFlight {0};
+    std::vector<std::unique_ptr<Namespace>> m_namespaces;
+
+    // serializes the notifications of all namespaces
+    std::mutex m_streamMutex;
+    std::vector<SubscriberPtr> m_subscribers;
+
+    // declared last, so its threads are joined before anything they use is destroyed
+    std::unique_ptr<util::WorkStealingPool> m_pool;
+};
+
+}  // namespace monkas::monitor
@@ -5,9 +5,12 @@
 
 #include <bitset>
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ethernet/Address.hpp>
 #include <fmt/ostream.h>
@@ -39,6 +42,8 @@ class NetworkInterfaceStatusTracker
         LinkDown,
         RouteDeleted,
         AllIPv4AddressesRemoved,
+        MissingAfterResync,
+        Unfollowed,
     };
 
     enum class LinkFlag : uint8_t
@@ -81,6 +86,9 @@ class NetworkInterfaceStatusTracker
     };
     using ChangedFlags = util::FlagSet<ChangedFlag>;
 
+    // the trackers that changed since their changes were cleared, by nsid and index
+    using DirtyList = std::vector<std::pair<int32_t, uint32_t>>;
+
     NetworkInterfaceStatusTracker();
 
     [[nodiscard]] auto name() const -> const std::string&;
@@ -107,6 +115,18 @@ class NetworkInterfaceStatusTracker
     void updateLinkFlags(const LinkFlags& flags);
     [[nodiscard]] auto linkFlags() const -> const LinkFlags&;
 
+    // the ARPHRD_* type of the link, set once when the interface is learned
+    [[nodiscard]] auto linkType() const -> uint16_t;
+    void setLinkType(uint16_t linkType);
+    // whether the link is Ethernet or IEEE 802.11
+    [[nodiscard]] auto isIeee802() const -> bool;
+    // the IFLA_INFO_KIND of the link, e.g. veth or bridge, empty for links without one
+    [[nodiscard]] auto linkKind() const -> const std::string&;
+    void setLinkKind(const std::string& linkKind);
+    // whether the interface was matched against the patterns of the subscriptions, done once its link is known
+    [[nodiscard]] auto isMatched() const -> bool;
+    void setMatched();
+
     [[nodiscard]] auto age() const -> Duration;
 
     [[nodiscard]] auto hasName() const -> bool;
@@ -119,7 +139,18 @@ class NetworkInterfaceStatusTracker
     void clearChangedFlags();
     void logNerdstats() const;
 
+    /**
+     * @brief Has the tracker add its key to the list once it changes, and once more when it changes after its changes
+     * were cleared, for the changed trackers to be found without looking at all of them.
+     */
+    void setDirtyList(DirtyList* list, std::pair<int32_t, uint32_t> key);
+    /* @note: lists the tracker right away as if it changed, e.g. before it is changed on a thread of its own */
+    void markDirty();
+
   private:
+    // ARPHRD_NONE, without depending on the kernel headers here
+    static constexpr uint16_t ARPHRD_NONE_TYPE = 0xFFFE;
+
     void touch(ChangedFlag flag);
 
     std::string m_name;
@@ -131,6 +162,13 @@ class NetworkInterfaceStatusTracker
     std::chrono::time_point<std::chrono::steady_clock> m_lastChanged;
     ChangedFlags m_changedFlags;
     LinkFlags m_linkFlags;
+    uint16_t m_linkType {ARPHRD_NONE_TYPE};
+    std::string m_linkKind;
+    bool m_matched {false};
+    // where the tracker lists itself once it changes, until its changes are cleared
+    DirtyList* m_dirtyList {nullptr};
+    std::pair<int32_t, uint32_t> m_dirtyKey;
+    bool m_listed {false};
 
     // mutable for tracking const getters
     mutable struct Nerdstats
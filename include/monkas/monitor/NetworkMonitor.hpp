@@ -3,15 +3,27 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
+#include <span>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <ip/Address.hpp>
+#include <monitor/ChangeWaiters.hpp>
+#include <monitor/InterfacePattern.hpp>
+#include <monitor/InterfaceSnapshots.hpp>
+#include <monitor/LatencyHistogram.hpp>
 #include <monitor/NetworkInterfaceStatusTracker.hpp>
+#include <monitor/ReceiveBufferPolicy.hpp>
 #include <network/Interface.hpp>
 #include <sys/types.h>
 #include <util/FlagSet.hpp>
@@ -22,9 +34,18 @@ struct ifinfomsg;
 struct ifaddrmsg;
 struct rtmsg;
 
+namespace monkas::util
+{
+class ForkJoinPool;
+}  // namespace monkas::util
+
 namespace monkas::monitor
 {
 
+class InterfaceMatcher;
+class ReceiveThread;
+class UringReceiver;
+
 enum class RuntimeFlag : uint8_t
 {
     StatsForNerds,
@@ -33,12 +54,78 @@ enum class RuntimeFlag : uint8_t
     IncludeNonIeee802,
     DumpPackets,
     NonBlocking,
+    BatchedReceive,
+    AdaptiveReceiveBuffer,
+    ParallelEnumeration,
+    DumpSubscribedInterfacesOnly,
+    // tracks the gateways of default routes in the main table only, the route dump is restricted to the main table.
+    // Dumps cannot filter by destination length, so the whole main table is still transferred and only the parsing
+    // of the attributes of other routes is skipped
+    DefaultRoutesOnly,
+    FilterEventsInKernel,
+    // receives link notifications on a socket of their own, drained before every datagram of addresses and routes,
+    // which are then received one at a time, outside of enumerations it bypasses BatchedReceive and ShardedProcessing
+    PrioritizeLinkEvents,
+    // receives through a multishot receive of io_uring, if built WITH_IO_URING and supported by the kernel
+    IoUringReceive,
+    // receives on a thread of its own, which queues the datagrams for the thread running the monitor, takes precedence
+    // over IoUringReceive, BatchedReceive and AdaptiveReceiveBuffer
+    PipelinedReceive,
+    // publishes a snapshot of every changed interface for other threads to read, see NetworkMonitor::snapshots(), the
+    // addresses and gateways stay followed whatever the subscribers are interested in
+    PublishSnapshots,
+    // applies the address and route messages of a batch of RuntimeFlag::BatchedReceive on a pool of threads, sharded by
+    // interface, subscribers are still notified on the thread running the monitor
+    ShardedProcessing,
+    // also receives the change notifications of all network namespaces that have an nsid in the namespace of the
+    // monitor, which needs CAP_NET_BROADCAST in them. Their interfaces carry the nsid, their links and addresses are
+    // dumped by nsid after the own ones, which needs strict checking and CAP_NET_ADMIN in them, their gateways are only
+    // learned from notifications. Ignores IoUringReceive and FilterEventsInKernel, which cannot tell the namespaces
+    // apart, and ParallelEnumeration
+    ListenAllNamespaces,
     // NOTE: keep FlagsCount last
     FlagsCount,
 };
 
 using RuntimeFlags = util::FlagSet<RuntimeFlag>;
+
+/**
+ * @brief Numeric knobs of the NetworkMonitor, complementing the RuntimeFlags.
+ */
+struct Tunables
+{
+    // bounds of the receive buffer when RuntimeFlag::AdaptiveReceiveBuffer is set
+    std::size_t receiveBufferFloor {8U * 1024U};
+    std::size_t receiveBufferCeiling {32U * 1024U};
+    // SO_RCVBUFFORCE, falling back to SO_RCVBUF without CAP_NET_ADMIN, 0 keeps the kernel default
+    int receiveSocketBufferSize {0};
+    // with RuntimeFlag::DumpSubscribedInterfacesOnly, addresses and routes are dumped once per subscribed interface up
+    // to this many subscribed interfaces, beyond that a single unfiltered dump is cheaper
+    std::size_t maxFilteredDumpInterfaces {16U};
+    // with RuntimeFlag::PipelinedReceive, how many datagrams the receive thread queues at most, rounded up to a power
+    // of two, each takes a buffer of 32KiB
+    std::size_t receiveRingDepth {64U};
+    // with RuntimeFlag::PublishSnapshots, how many interfaces snapshots are published of at most, rounded up to a power
+    // of two, each takes about 1KiB
+    std::size_t snapshotCapacity {256U};
+    // with RuntimeFlag::ShardedProcessing, how many shards the messages are spread across, each but the first on a
+    // thread of its own, 0 takes one per core
+    std::size_t processingShards {0U};
+};
 using Interfaces = std::set<network::Interface>;
+
+// interfaces coming and going a subscriber is told about, the removal of its subscribed interfaces is always told
+enum class InterfaceEvent : uint8_t
+{
+    // every interface added
+    Added,
+    // every interface removed, not only the subscribed ones
+    Removed,
+    // NOTE: keep FlagsCount last
+    FlagsCount,
+};
+
+using InterfaceEvents = util::FlagSet<InterfaceEvent>;
 using LinkFlags = NetworkInterfaceStatusTracker::LinkFlags;
 using OperationalState = NetworkInterfaceStatusTracker::OperationalState;
 
@@ -71,6 +158,17 @@ struct Subscriber
     virtual void onMacAddressChanged(const network::Interface& /*unused*/, const ethernet::Address& /*unused*/) {}
 
     virtual void onBroadcastAddressChanged(const network::Interface& /*unused*/, const ethernet::Address& /*unused*/) {}
+
+    /* @note: asked once when subscribing, true is told onChangesBatch() instead of a call per changed field */
+    [[nodiscard]] virtual auto wantsChangesBatch() const -> bool { return false; }
+
+    /**
+     * @brief The subscribed interfaces that changed, once per batch of datagrams received, or per datagram without
+     * RuntimeFlag::BatchedReceive, and their current state when subscribing, with all flags set.
+     *
+     * Additions and removals are still told one by one, before the batch.
+     */
+    virtual void onChangesBatch(std::span<const InterfaceChange> /*unused*/) {}
 };
 
 using SubscriberPtr = std::shared_ptr<Subscriber>;
@@ -78,31 +176,253 @@ using SubscriberPtr = std::shared_ptr<Subscriber>;
 class NetworkMonitor
 {
   public:
-    explicit NetworkMonitor(const RuntimeFlags& options);
+    explicit NetworkMonitor(const RuntimeFlags& options, const Tunables& tunables = {});
+    ~NetworkMonitor();
+    NetworkMonitor(const NetworkMonitor&) = delete;
+    NetworkMonitor(NetworkMonitor&&) = delete;
+    auto operator=(const NetworkMonitor&) -> NetworkMonitor& = delete;
+    auto operator=(NetworkMonitor&&) -> NetworkMonitor& = delete;
+
     auto enumerateInterfaces() -> Interfaces;
-    void subscribe(const Interfaces& interfaces, const SubscriberPtr& subscriber);
+    /**
+     * @brief Subscribes to changes of the given interfaces.
+     *
+     * @param interest the changes the subscriber cares about, it is not called for the others. Addresses and gateways
+     * nobody is interested in are no longer followed, their multicast groups are left and the cached ones are forgotten
+     * until a subscriber is interested again. Then they are dumped again, and that subscriber is told nothing before
+     * the dump completes.
+     * @param events which interfaces coming and going the subscriber is told about, besides the removal of the
+     * subscribed ones.
+     */
+    void subscribe(const Interfaces& interfaces,
+                   const SubscriberPtr& subscriber,
+                   const ChangedFlags& interest = ChangedFlags::all(),
+                   const InterfaceEvents& events = InterfaceEvents::all());
+    /**
+     * @brief Subscribes to the interfaces matching any of the patterns, the present ones and the ones added later.
+     *
+     * Interfaces are matched when they are learned from their first link message, against the patterns of all
+     * subscriptions at once, and again whenever their name or link flags change. An interface matched anew is told all
+     * of its state with that change, one that no longer matches leaves the subscription without being told. A
+     * subscriber also told about added interfaces is told before the changes of a matched one. Removed interfaces leave
+     * the subscription, and are matched anew if they come back.
+     */
+    void subscribeMatching(const std::vector<InterfacePattern>& patterns,
+                           const SubscriberPtr& subscriber,
+                           const ChangedFlags& interest = ChangedFlags::all(),
+                           const InterfaceEvents& events = InterfaceEvents::all());
+    /* @note: keeps the interest, the events and the patterns of the subscription */
     void updateSubscription(const Interfaces& interfaces, const SubscriberPtr& subscriber);
     void unsubscribe(const SubscriberPtr& subscriber);
+    /**
+     * @brief Awaits the next of the given changes of an interface, e.g. co_await monitor.nextChange(intf, interest).
+     *
+     * The coroutine is resumed by run() or processPending() while they notify the changes, after the subscribers, and
+     * with an InterfaceChange that has no changes if the interface is removed. Coroutines waiting when the monitor is
+     * destroyed are not resumed. Like subscriptions, waiting for addresses or gateways keeps them followed, but only
+     * subscribed interfaces are followed with RuntimeFlag::DumpSubscribedInterfacesOnly or FilterEventsInKernel.
+     */
+    [[nodiscard]] auto nextChange(const network::Interface& intf, const ChangedFlags& interest = ChangedFlags::all())
+        -> ChangeAwaiter;
     void run();
+    /* @note: thread safe, unlike everything else */
     void stop();
 
+    /**
+     * @brief A file descriptor that becomes readable once processPending() has something to do, e.g. for epoll.
+     *
+     * Replaces run() for monitors driven by an external event loop. It is readable right after construction, for the
+     * first processPending() call to start the enumeration.
+     */
+    [[nodiscard]] auto fileDescriptor() const -> int { return m_epollFd; }
+
+    auto processPending(std::size_t budget = std::numeric_limits<std::size_t>::max()) -> std::size_t;
+
+    /**
+     * @brief The snapshots of the interfaces for threads other than the one running the monitor, nullptr without
+     * RuntimeFlag::PublishSnapshots.
+     *
+     * Every interface that changed is published once per datagram processed, after the subscribers were notified.
+     * Reading never blocks the monitor and the snapshots stay readable after the monitor is destroyed.
+     */
+    [[nodiscard]] auto snapshots() const -> std::shared_ptr<const InterfaceSnapshots> { return m_snapshots; }
+
+    /**
+     * @brief Publishes the snapshots into the given ones from now on, e.g. shared memory for other processes from
+     * InterfaceSnapshots::createShared(), as with RuntimeFlag::PublishSnapshots.
+     *
+     * The interfaces known already are published right away. The generation of the snapshots is bumped once per
+     * datagram that changed any of them. Addresses and gateways stay followed while snapshots are published.
+     * @note: for the thread running the monitor only
+     */
+    void publishSnapshotsTo(std::shared_ptr<InterfaceSnapshots> snapshots);
+
+    /* @note: the cached state of an interface, nullptr if it is not known, for the thread running the monitor only */
+    [[nodiscard]] auto interfaceState(const network::Interface& intf) const -> const NetworkInterfaceStatusTracker*;
+
+    // what parsing messages counted, counted per shard with RuntimeFlag::ShardedProcessing
+    struct ParseStatistics
+    {
+        uint64_t msgsDiscarded {};
+        uint64_t seenAttributes {};
+        uint64_t unknownAttributes {};
+        uint64_t addressMessagesSeen {};
+        uint64_t linkMessagesSeen {};
+        uint64_t routeMessagesSeen {};
+
+        auto operator+=(const ParseStatistics& other) -> ParseStatistics&;
+    };
+
+    // what the monitor counted, logged with RuntimeFlag::StatsForNerds
+    struct Statistics
+    {
+        std::chrono::time_point<std::chrono::steady_clock> startTime;
+        uint64_t bytesSent {};
+        uint64_t bytesReceived {};
+        uint64_t packetsSent {};
+        uint64_t packetsReceived {};
+        uint64_t batchesReceived {};
+        uint64_t packetsReceivedInBatches {};
+        uint64_t packetsReceivedThroughUring {};
+        uint64_t uringBuffersRanOut {};
+        uint64_t packetsReceivedThroughPipeline {};
+        uint64_t pipelineHighWaterMark {};
+        uint64_t pipelineStalls {};
+        uint64_t snapshotsPublished {};
+        uint64_t snapshotsUnpublished {};
+        uint64_t shardedMessages {};
+        uint64_t shardedRuns {};
+        uint64_t packetsFromOtherNamespaces {};
+        uint64_t receiveBufferPeeks {};
+        uint64_t receiveBufferGrows {};
+        uint64_t receiveBufferShrinks {};
+        // datagrams of addresses or routes of interfaces whose link message was still queued on the link socket
+        uint64_t linkSocketRedrains {};
+        uint64_t receiveOverflows {};
+        // datagrams that did not fit the receive buffer, they are lost like the ones of an overflow
+        uint64_t receiveTruncations {};
+        uint64_t resyncs {};
+        uint64_t parallelDumpRetries {};
+        uint64_t socketFilterUpdates {};
+        uint64_t membershipChanges {};
+        uint64_t eventBytesDelivered {};
+        uint64_t eventBytesAudited {};
+        uint64_t filterAuditOverflows {};
+        uint64_t msgsReceived {};
+        ParseStatistics parsing;
+        // how long change notifications waited at most since the receive loop saw their socket readable
+        LatencyHistogram linkLatency;
+        LatencyHistogram addressLatency;
+        LatencyHistogram routeLatency;
+
+        /* @note: adds up the counters of another monitor, keeping the earlier start and the higher high water mark */
+        auto operator+=(const Statistics& other) -> Statistics&;
+    };
+
+    /* @note: not thread safe, read it on the thread running the monitor */
+    [[nodiscard]] auto statistics() const -> const Statistics& { return m_stats; }
+
   private:
-    void receiveAndProcess();
+    // feeds the monitor made up messages in the tests
+    friend class NetworkMonitorTestPeer;
+
+    enum class CacheState : uint8_t
+    {
+        EnumeratingLinks,
+        EnumeratingAddresses,
+        EnumeratingRoutes,
+        WaitingForChanges
+    };
+
+    void setupEventPolling();
+    void waitForEvents();
+    void watchLinkSocket(bool watch);
+    void clearWakeup();
+    auto handleStopRequest() -> bool;
+    void closeSockets();
+    auto receiveAndProcess(std::size_t budget) -> std::size_t;
+    auto receive(int flags, int32_t& nsid) -> ssize_t;
+    void resizeReceiveBuffer(size_t size);
+    void handleReceiveError(std::optional<std::chrono::steady_clock::time_point>& backlogSince);
+    static void setReceiveSocketBufferSize(mnl_socket* socket, int size);
+    [[nodiscard]] auto multicastGroups() const -> unsigned;
+    void updateInterest();
+    auto updateMemberships() -> bool;
+    void forgetUnfollowed(bool addresses, bool gateways);
+    void setMembership(unsigned group, bool join);
+    void attachSocketFilter();
+    void auditFilteredEvents();
+    auto receiveAndProcessBatch(std::size_t budget) -> std::size_t;
+    auto receiveAndProcessPrioritized(std::size_t budget) -> std::size_t;
+    auto receiveAndProcessUring(std::size_t budget) -> std::size_t;
+    auto receiveAndProcessPipelined(std::size_t budget) -> std::size_t;
+    auto drainLinkSocket(std::size_t budget) -> std::size_t;
+    auto drainLinkSocketFor(const uint8_t* data, std::size_t size, int32_t nsid, std::size_t budget) -> std::size_t;
+    void trackBacklog(std::optional<std::chrono::steady_clock::time_point>& since, bool readable) const;
+    auto processDatagram(const uint8_t* data,
+                         size_t size,
+                         std::optional<std::chrono::steady_clock::time_point> waitingSince = std::nullopt,
+                         int32_t nsid = network::Interface::OWN_NAMESPACE) -> bool;
+    void recordLatency(uint16_t msgType, std::chrono::steady_clock::time_point waitingSince);
+    auto runCallbacks(const uint8_t* data, size_t size, uint32_t seqNo, uint32_t portid) -> int;
     auto interfacesFromCache() -> Interfaces;
     void updateStats(ssize_t receiveResult);
-    void dumpPacket(ssize_t receiveResult) const;
+    static void dumpPacket(const uint8_t* data, size_t size);
     auto handleCallbackResult(int callbackResult) -> bool;
 
+    void startEnumeration(CacheState first = CacheState::EnumeratingLinks,
+                          CacheState last = CacheState::EnumeratingRoutes);
+    auto enterEnumerationStep(CacheState step) -> bool;
+    [[nodiscard]] auto isFollowed(CacheState step) const -> bool;
+    void startDumps(uint16_t msgType);
+    auto sendNextFilteredDumpRequest() -> bool;
+    auto sendNextNamespaceDumpRequest() -> bool;
+    [[nodiscard]] auto dumpsOtherNamespaces() const -> bool;
+    auto finishEnumeration() -> bool;
+    auto dumpFilter(bool knownInterfacesOnly) const -> std::set<uint32_t>;
+    void enumerateInParallel();
+    void requestResync(CacheState first = CacheState::EnumeratingLinks,
+                       CacheState last = CacheState::EnumeratingRoutes);
+    void reconcileLinksAfterResync();
+    void reconcileAddressesAfterResync();
+    void reconcileGatewaysAfterResync();
+
     /* @note: only one such request can be in progress until the reply is received */
-    void sendDumpRequest(uint16_t msgType);
+    void sendDumpRequest(uint16_t msgType,
+                         uint32_t ifIndex = 0,
+                         int32_t nsid = network::Interface::OWN_NAMESPACE);
+    void sendDumpRequest(mnl_socket* socket,
+                         uint16_t msgType,
+                         uint32_t seqNo,
+                         uint32_t ifIndex = 0,
+                         int32_t nsid = network::Interface::OWN_NAMESPACE);
+    [[nodiscard]] auto dumpFamily(uint16_t msgType) const -> uint8_t;
     void retryLastDumpRequestWithNewSequenceNumber();
     auto nextDumpRequestSequenceNumber() -> uint32_t;
 
-    auto ensureNameCurrent(uint32_t ifIndex, const std::optional<std::string>& name) -> NetworkInterfaceStatusTracker&;
-
-    void parseLinkMessage(const nlmsghdr* nlhdr, const ifinfomsg* ifi);
-    void parseAddressMessage(const nlmsghdr* nlhdr, const ifaddrmsg* ifa);
-    void parseRouteMessage(const nlmsghdr* nlhdr, const rtmsg* rtm);
+    void enableListenAllNamespaces();
+    [[nodiscard]] auto findTracker(int32_t nsid, uint32_t ifIndex) -> NetworkInterfaceStatusTracker*;
+    // what a link message tells about its interface besides the name
+    struct LinkInfo
+    {
+        uint16_t type {};
+        std::optional<std::string> kind {};
+        NetworkInterfaceStatusTracker::LinkFlags flags {};
+    };
+
+    auto ensureNameCurrent(uint32_t ifIndex,
+                           const std::optional<std::string>& name,
+                           int32_t nsid,
+                           const LinkInfo* link = nullptr) -> NetworkInterfaceStatusTracker&;
+
+    void parseMessage(const nlmsghdr* n, int32_t nsid, ParseStatistics& stats);
+    void parseLinkMessage(const nlmsghdr* nlhdr, const ifinfomsg* ifi, int32_t nsid, ParseStatistics& stats);
+    void parseAddressMessage(const nlmsghdr* nlhdr, const ifaddrmsg* ifa, int32_t nsid, ParseStatistics& stats);
+    void parseRouteMessage(const nlmsghdr* nlhdr, const rtmsg* rtm, int32_t nsid, ParseStatistics& stats);
+    void parseNamespaceMessage(const nlmsghdr* nlhdr);
+    auto deferToShard(const nlmsghdr* n) -> bool;
+    void applyShardedMessages();
+    void applyShard(std::size_t index);
 
     void printStatsForNerdsIfEnabled();
 
@@ -121,48 +441,190 @@ class NetworkMonitor
     [[nodiscard]] auto isEnumeratingRoutes() const -> bool { return m_cacheState == CacheState::EnumeratingRoutes; }
 
     void notifyChanges();
-    void notifyChanges(Subscriber* subscriber, const Interfaces& intfs);
+    auto takeDirtyTrackers() -> NetworkInterfaceStatusTracker::DirtyList;
+    void notifyChanges(const network::Interface& intf, NetworkInterfaceStatusTracker& tracker);
+    void notifyChanges(Subscriber* subscriber, const Interfaces& intfs, const ChangedFlags& interest);
+    static void notifyChanges(Subscriber* subscriber, std::span<const InterfaceChange> changes, bool batched);
     static void notifyChanges(Subscriber* subscriber,
                               const network::Interface& intf,
                               const NetworkInterfaceStatusTracker& tracker,
-                              bool forceNotify = false);
+                              const ChangedFlags& changed);
     void notifyInterfaceAdded(const network::Interface& intf);
     void notifyInterfaceRemoved(const network::Interface& intf);
+    void publishSnapshot(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker);
 
     std::unique_ptr<mnl_socket, int (*)(mnl_socket*)> m_mnlSocket;
     std::vector<uint8_t> m_receiveBuffer;
+    std::vector<uint8_t> m_batchReceiveBuffer;
     std::vector<uint8_t> m_sendBuffer;
+    // only with RuntimeFlag::PrioritizeLinkEvents, m_mnlSocket does not join the link group then
+    std::unique_ptr<mnl_socket, int (*)(mnl_socket*)> m_linkSocket;
+    std::vector<uint8_t> m_linkReceiveBuffer;
+    // only with RuntimeFlag::IoUringReceive, replaces receiving from m_mnlSocket, shared with the receive loop to keep
+    // the datagram in process alive when stop() is called from a callback
+    std::shared_ptr<UringReceiver> m_uringReceiver;
+    // only with RuntimeFlag::PipelinedReceive, receives from m_mnlSocket instead, shared for the same reason
+    std::shared_ptr<ReceiveThread> m_receiveThread;
+    // when the receive loop first saw a socket readable without seeing it empty since, tracked for stats for nerds
+    std::optional<std::chrono::steady_clock::time_point> m_backlogSince;
+    std::optional<std::chrono::steady_clock::time_point> m_linkBacklogSince;
     bool m_running {false};
+    bool m_enumerationStarted {false};
+    // stop() wakes up the thread running the monitor through the eventfd, which m_epollFd watches with the sockets
+    int m_wakeupFd {-1};
+    int m_epollFd {-1};
+    std::atomic<bool> m_stopRequested {false};
+    std::atomic<std::thread::id> m_loopThread;
     uint32_t m_portid {};
     uint32_t m_sequenceNumber {};
+    bool m_strictCheck {false};
 
     std::map<uint32_t, NetworkInterfaceStatusTracker> m_trackers;
-
-    enum class CacheState : uint8_t
+    // only with RuntimeFlag::ListenAllNamespaces, the interfaces of other namespaces by nsid and index
+    std::map<std::pair<int32_t, uint32_t>, NetworkInterfaceStatusTracker> m_peerTrackers;
+    // the trackers that changed since they were last notified, which trackers list themselves in
+    NetworkInterfaceStatusTracker::DirtyList m_dirtyTrackers;
+    // the namespace of the datagram in process
+    int32_t m_datagramNamespace {network::Interface::OWN_NAMESPACE};
+
+    CacheState m_cacheState {CacheState::EnumeratingLinks};
+    // the last step of the ongoing enumeration, resyncs after joining groups again only dump what they follow
+    CacheState m_lastEnumerationStep {CacheState::EnumeratingRoutes};
+
+    // interfaces the address and route dumps are filtered by, empty if not filtered
+    std::set<uint32_t> m_dumpFilter;
+    std::deque<uint32_t> m_pendingDumpIfIndexes;
+    // the namespace the last dump request targeted, which the replies to it are attributed to
+    int32_t m_dumpNamespace {network::Interface::OWN_NAMESPACE};
+
+    // only with RuntimeFlag::ListenAllNamespaces, the links and addresses of the namespaces with an nsid are dumped
+    // after the own ones, one namespace after the other
+    struct NamespaceDumps
     {
-        EnumeratingLinks,
-        EnumeratingAddresses,
-        EnumeratingRoutes,
-        WaitingForChanges
-    } m_cacheState {CacheState::EnumeratingLinks};
-
-    struct Statistics
+        // the nsids the last RTM_GETNSID dump listed, none if it failed
+        std::optional<std::vector<int32_t>> listed;
+        // the listed namespaces the current step did not dump yet, the front one is being dumped
+        std::deque<int32_t> pending;
+        // the namespaces the current step dumped completely
+        std::set<int32_t> dumped;
+        // whether the current step is done with the dumps of the own namespace
+        bool started {false};
+        bool listing {false};
+        // whether the dump in progress failed, e.g. as its namespace went away
+        bool failed {false};
+
+        void restart()
+        {
+            pending.clear();
+            dumped.clear();
+            started = false;
+            listing = false;
+            failed = false;
+        }
+    } m_namespaceDumps;
+    // interfaces of all subscriptions as far as dumps and the socket filter care, empty if not filtered
+    std::set<uint32_t> m_interest;
+    // unfiltered socket joining the same groups, to tell how many bytes the socket filter saved in stats for nerds
+    std::unique_ptr<mnl_socket, int (*)(mnl_socket*)> m_filterAuditSocket;
+    // whether the address and route groups are joined, i.e. whether anybody is interested in addresses and gateways
+    bool m_addressGroupsJoined {true};
+    bool m_routeGroupsJoined {true};
+
+    bool m_resyncing {false};
+    bool m_resyncPending {false};
+
+    // what the dumps of a resync reported by nsid and index, everything else in the dumped namespaces went missing
+    // while overflowing
+    struct ResyncState
     {
-        std::chrono::time_point<std::chrono::steady_clock> startTime;
-        uint64_t bytesSent {};
-        uint64_t bytesReceived {};
-        uint64_t packetsSent {};
-        uint64_t packetsReceived {};
-        uint64_t msgsReceived {};
-        uint64_t msgsDiscarded {};
-        uint64_t seenAttributes {};
-        uint64_t unknownAttributes {};
-        uint64_t addressMessagesSeen {};
-        uint64_t linkMessagesSeen {};
-        uint64_t routeMessagesSeen {};
-    } m_stats;
+        std::set<std::pair<int32_t, uint32_t>> links;
+        std::map<std::pair<int32_t, uint32_t>, Addresses> addresses;
+        std::set<uint32_t> gateways;
+    } m_resync;
+
+    Statistics m_stats;
 
     RuntimeFlags m_runtimeOptions;
-    std::unordered_map<SubscriberPtr, Interfaces> m_subscribers;
+    ReceiveBufferPolicy m_receiveBufferPolicy;
+    std::size_t m_maxFilteredDumpInterfaces;
+
+    struct Subscription
+    {
+        Subscriber* subscriber {nullptr};
+        Interfaces interfaces;
+        ChangedFlags interest;
+        InterfaceEvents events;
+        // told through Subscriber::onChangesBatch()
+        bool batched {false};
+        // the changes of the subscribed interfaces gathered for the subscriber while notifying
+        std::vector<InterfaceChange> changes;
+        // of subscribeMatching(), the interfaces are the ones matched
+        std::vector<InterfacePattern> patterns;
+        // subscribed while the groups of its interest were joined again, told nothing until they are dumped again
+        bool heldBack {false};
+        // matched into the subscription since it was last told, told all of their state with their next change
+        Interfaces matched;
+    };
+
+    void addSubscription(const Interfaces& interfaces,
+                         std::vector<InterfacePattern> patterns,
+                         const SubscriberPtr& subscriber,
+                         const ChangedFlags& interest,
+                         const InterfaceEvents& events);
+    void indexSubscription(Subscription& subscription);
+    void unindexSubscription(Subscription& subscription);
+    void eraseLeftSubscriptions();
+    void releaseHeldBackSubscriptions();
+    void compilePatterns();
+    void matchPatterns(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker);
+
+    std::unordered_map<SubscriberPtr, Subscription> m_subscribers;
+    // counts the nested calls of subscribers, which may unsubscribe anyone including themselves
+    class DispatchScope;
+    uint32_t m_dispatchDepth {};
+    // subscribers that left while subscribers were called, their cleared subscriptions are erased once all returned
+    std::vector<SubscriberPtr> m_leftSubscribers;
+    // the subscriptions by the interfaces they subscribe to, keyed by interfaceKey()
+    std::unordered_map<uint64_t, std::vector<Subscription*>> m_subscriptionsByInterface;
+    // the subscriptions told about every interface added and removed
+    std::vector<Subscription*> m_addedSubscriptions;
+    std::vector<Subscription*> m_removedSubscriptions;
+    // the patterns of all subscriptions, and the subscription of each pattern by its id
+    std::unique_ptr<InterfaceMatcher> m_matcher;
+    std::vector<Subscription*> m_patternOwners;
+    std::vector<std::size_t> m_patternMatches;
+    // interfaces were matched into or out of subscriptions since the interest was last updated
+    bool m_matchesChanged {false};
+    // any subscription is held back until the addresses or routes are dumped again
+    bool m_subscriptionsHeldBack {false};
+    // the changes of the interfaces notified last, the subscriptions told any of them, and the changes told one
+    // subscriber, kept for their capacity
+    std::vector<InterfaceChange> m_changes;
+    std::vector<Subscription*> m_notified;
+    std::vector<InterfaceChange> m_batch;
+    ChangeWaiters m_changeWaiters;
+    // everything nextChange() was ever asked for, addresses and gateways stay followed once awaited
+    ChangedFlags m_awaitedInterest;
+    // only with RuntimeFlag::PublishSnapshots
+    std::shared_ptr<InterfaceSnapshots> m_snapshots;
+    // whether the snapshots changed since they were last committed
+    bool m_snapshotsChanged {false};
+
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    // the messages queued for a shard and what parsing them counted, apart from the shards running in parallel
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        std::vector<const nlmsghdr*> messages;
+        ParseStatistics stats;
+    };
+
+    // only with RuntimeFlag::ShardedProcessing
+    std::unique_ptr<util::ForkJoinPool> m_shardPool;
+    std::vector<Shard> m_shards;
+    // whether the batch in process is spread across the shards, which it is outside of enumerations only
+    bool m_deferToShards {false};
+    // the interfaces with messages queued in the shards
+    std::set<uint32_t> m_shardedInterfaces;
 };
 }  // namespace monkas::monitor
@@ -0,0 +1,50 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Decides how large the receive buffer should be, based on the sizes of the datagrams seen.
+ *
+ * Dumps use the ceiling, as the kernel sizes dump datagrams after the buffer offered by the reader. In steady state the
+ * buffer grows on demand to fit the next datagram and shrinks back once a window of datagrams stayed well below the
+ * current size. A buffer below the ceiling costs a peek per datagram, so no notification up to the ceiling is lost.
+ */
+class ReceiveBufferPolicy
+{
+  public:
+    static constexpr uint32_t SHRINK_WINDOW = 64;
+
+    ReceiveBufferPolicy(std::size_t floor, std::size_t ceiling);
+
+    [[nodiscard]] auto floor() const -> std::size_t { return m_floor; }
+
+    [[nodiscard]] auto ceiling() const -> std::size_t { return m_ceiling; }
+
+    /* @note: peeking is only worth a syscall if the answer could make the buffer grow */
+    [[nodiscard]] auto shouldPeek(std::size_t currentSize) const -> bool { return currentSize < m_ceiling; }
+
+    [[nodiscard]] auto sizeFor(std::size_t datagramSize) const -> std::size_t;
+
+    /**
+     * @brief Records a received datagram.
+     *
+     * @return the size to shrink to once the current window is complete and a smaller buffer suffices.
+     */
+    auto observe(std::size_t currentSize, std::size_t datagramSize) -> std::optional<std::size_t>;
+
+  private:
+    std::size_t m_floor;
+    std::size_t m_ceiling;
+    std::size_t m_highWater {};
+    uint32_t m_observed {};
+};
+
+}  // namespace monkas::monitor
@@ -12,28 +12,48 @@
 
 namespace monkas::network
 {
+/**
+ * @brief An interface, identified by its index within its network namespace.
+ *
+ * Interfaces of other namespaces carry the nsid the namespace has in the namespace of the monitor, see
+ * RuntimeFlag::ListenAllNamespaces, or the position of their namespace in a NamespaceMonitorPool.
+ */
 class Interface
 {
   public:
+    // the namespace of the monitor, NETNSA_NSID_NOT_ASSIGNED
+    static constexpr int32_t OWN_NAMESPACE = -1;
+
     [[nodiscard]] static auto fromName(std::string name) -> Interface;
     [[nodiscard]] static auto fromIndex(std::uint32_t index) -> Interface;
     Interface() = default;
-    Interface(std::uint32_t index, std::string name);
+    Interface(std::uint32_t index, std::string name, int32_t namespaceId = OWN_NAMESPACE);
 
     [[nodiscard]] constexpr auto index() const -> uint32_t { return m_index; }
 
     [[nodiscard]] constexpr auto name() const -> const std::string& { return m_name; }
 
+    [[nodiscard]] constexpr auto namespaceId() const -> int32_t { return m_namespaceId; }
+
+    [[nodiscard]] constexpr auto isInOwnNamespace() const -> bool { return m_namespaceId == OWN_NAMESPACE; }
+
     [[nodiscard]] constexpr auto operator<=>(const Interface& other) const noexcept -> std::strong_ordering
     {
+        if (const auto order = m_namespaceId <=> other.m_namespaceId; order != 0) {
+            return order;
+        }
         return m_index <=> other.m_index;
     }
 
-    [[nodiscard]] constexpr auto operator==(const Interface& other) const -> bool { return m_index == other.m_index; }
+    [[nodiscard]] constexpr auto operator==(const Interface& other) const -> bool
+    {
+        return m_index == other.m_index && m_namespaceId == other.m_namespaceId;
+    }
 
   private:
     uint32_t m_index {};
     std::string m_name;
+    int32_t m_namespaceId {OWN_NAMESPACE};
 };
 
 auto operator<<(std::ostream& os, const Interface& iface) -> std::ostream&;
@@ -32,6 +32,13 @@ class FlagSet
     {
     }
 
+    [[nodiscard]] static auto all() -> FlagSet
+    {
+        FlagSet flags;
+        flags.m_flags.set();
+        return flags;
+    }
+
     [[nodiscard]] constexpr auto toU32() const -> uint32_t { return m_flags.to_ulong(); }
 
     [[nodiscard]] constexpr static auto size() -> size_t { return FLAG_COUNT; }
@@ -50,6 +57,20 @@ class FlagSet
 
     [[nodiscard]] auto test(EnumType flag) const -> bool { return m_flags.test(std::to_underlying(flag)); }
 
+    [[nodiscard]] auto operator&(const FlagSet& other) const -> FlagSet
+    {
+        FlagSet flags;
+        flags.m_flags = m_flags & other.m_flags;
+        return flags;
+    }
+
+    [[nodiscard]] auto operator|(const FlagSet& other) const -> FlagSet
+    {
+        FlagSet flags;
+        flags.m_flags = m_flags | other.m_flags;
+        return flags;
+    }
+
     [[nodiscard]] auto toString() const -> std::string
     {
         std::ostringstream oss;
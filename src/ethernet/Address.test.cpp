@@ -28,6 +28,12 @@ TEST_SUITE("[ethernet::Address]")
         CHECK(!someAddress.allZeroes());
     }
 
+    TEST_CASE("bytes")
+    {
+        CHECK(someAddress.bytes() == Bytes {1, 2, 3, 4, 5, 0x1a});
+        CHECK(defaultAddress.bytes() == Bytes {});
+    }
+
     TEST_CASE("isBroadcast")
     {
         CHECK(!someAddress.isBroadcast());
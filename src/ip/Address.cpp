@@ -148,6 +148,11 @@ auto Address::family() const -> Family
         m_bytes);
 }
 
+auto Address::bytes() const -> std::span<const uint8_t>
+{
+    return std::visit([](const auto& addr) -> std::span<const uint8_t> { return addr; }, m_bytes);
+}
+
 auto Address::toString() const -> std::string
 {
     return std::visit(
@@ -1,6 +1,8 @@
 // Copyright 2023-2025 hrzlgnm
 // SPDX-License-Identifier: MIT-0
 
+#include <algorithm>
+
 #include <doctest/doctest.h>
 #include <ip/Address.hpp>
 
@@ -53,6 +55,13 @@ TEST_SUITE("[ip::Address]")
         CHECK(localHost6.family() == Family::IPv6);
     }
 
+    TEST_CASE("bytes")
+    {
+        CHECK(std::ranges::equal(countUpV4.bytes(), bytesV4CountUp));
+        CHECK(std::ranges::equal(countDownV6.bytes(), bytesV6CountDown));
+        CHECK(defaultCtor.bytes().size() == bytesAny4.size());
+    }
+
     TEST_CASE("isV4")
     {
         CHECK(localhost4.isV4());
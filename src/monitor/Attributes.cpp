@@ -74,6 +74,31 @@ auto Attributes::parse(const nlmsghdr* n,
     return attributes;
 }
 
+auto Attributes::findU32(const nlmsghdr* n, const uint32_t offset, const uint16_t type) -> std::optional<uint32_t>
+{
+    struct Search
+    {
+        uint16_t type;
+        std::optional<uint32_t> value;
+    } search {.type = type, .value = std::nullopt};
+    mnl_attr_parse(
+        n,
+        offset,
+        [](const nlattr* attr, void* data) -> int
+        {
+            auto* search = static_cast<Search*>(data);
+            if (mnl_attr_get_type(attr) != search->type) {
+                return MNL_CB_OK;
+            }
+            if (mnl_attr_validate(attr, MNL_TYPE_U32) >= 0) {
+                search->value = mnl_attr_get_u32(attr);
+            }
+            return MNL_CB_STOP;
+        },
+        &search);
+    return search.value;
+}
+
 Attributes::Attributes(const std::size_t toAlloc)
     : m_attributes(toAlloc, nullptr)
 {
@@ -148,4 +173,31 @@ auto Attributes::getIpV4Address(const uint16_t type) const -> std::optional<ip::
     return getPayload<ip::IPV4_ADDR_LEN>(m_attributes, type)
         .transform([](const auto& arr) { return ip::Address(arr); });
 }
+
+auto Attributes::getNestedString(const uint16_t type, const uint16_t nestedType) const -> std::optional<std::string>
+{
+    if (!has(m_attributes, type)) {
+        return std::nullopt;
+    }
+    struct Search
+    {
+        uint16_t type;
+        std::optional<std::string> value;
+    } search {.type = nestedType, .value = std::nullopt};
+    mnl_attr_parse_nested(
+        m_attributes[type],
+        [](const nlattr* attr, void* data) -> int
+        {
+            auto* search = static_cast<Search*>(data);
+            if (mnl_attr_get_type(attr) != search->type) {
+                return MNL_CB_OK;
+            }
+            if (mnl_attr_validate(attr, MNL_TYPE_STRING) >= 0) {
+                search->value = mnl_attr_get_str(attr);
+            }
+            return MNL_CB_STOP;
+        },
+        &search);
+    return search.value;
+}
 }  // namespace monkas::monitor
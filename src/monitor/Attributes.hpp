@@ -21,6 +21,8 @@ class Attributes
                       uint16_t maxType,
                       uint64_t& seenCounter,
                       uint64_t& unknownCounter) -> Attributes;
+    /* @note: stops at the first attribute of the given type, without counting or keeping the others */
+    static auto findU32(const nlmsghdr* n, uint32_t offset, uint16_t type) -> std::optional<uint32_t>;
 
     ~Attributes() = default;
     Attributes(const Attributes&) = default;
@@ -36,6 +38,8 @@ class Attributes
     [[nodiscard]] auto getEthernetAddress(uint16_t type) const -> std::optional<ethernet::Address>;
     [[nodiscard]] auto getIpV4Address(uint16_t type) const -> std::optional<ip::Address>;
     [[nodiscard]] auto getIpV6Address(uint16_t type) const -> std::optional<ip::Address>;
+    /* @note: a string nested in an attribute, e.g. IFLA_INFO_KIND in IFLA_LINKINFO */
+    [[nodiscard]] auto getNestedString(uint16_t type, uint16_t nestedType) const -> std::optional<std::string>;
 
   private:
     explicit Attributes(std::size_t toAlloc);
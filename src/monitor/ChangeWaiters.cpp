@@ -0,0 +1,145 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <utility>
+
+#include <monitor/ChangeWaiters.hpp>
+
+namespace monkas::monitor
+{
+
+ChangeAwaiter::ChangeAwaiter(ChangeWaiters& waiters, const network::Interface& intf, const ChangedFlags& interest)
+    : m_waiters {&waiters}
+    , m_interest {interest}
+    , m_change {.interface = intf, .changed = {}, .tracker = nullptr}
+{
+}
+
+ChangeAwaiter::~ChangeAwaiter()
+{
+    if (m_waiters != nullptr) {
+        m_waiters->remove(this);
+    }
+}
+
+void ChangeAwaiter::await_suspend(const std::coroutine_handle<> handle)
+{
+    m_handle = handle;
+    m_change.changed = {};
+    m_change.tracker = nullptr;
+    if (m_waiters != nullptr) {
+        m_waiters->add(this);
+    }
+}
+
+ChangeWaiters::~ChangeWaiters()
+{
+    for (auto& [_, waiting] : m_waiting) {
+        for (auto* awaiter : waiting) {
+            awaiter->m_waiters = nullptr;
+            awaiter->m_state = ChangeAwaiter::State::Idle;
+        }
+    }
+    for (auto* awaiter : m_resuming) {
+        if (awaiter != nullptr) {
+            awaiter->m_waiters = nullptr;
+            awaiter->m_state = ChangeAwaiter::State::Idle;
+        }
+    }
+}
+
+void ChangeWaiters::add(ChangeAwaiter* awaiter)
+{
+    m_waiting[awaiter->m_change.interface].push_back(awaiter);
+    awaiter->m_state = ChangeAwaiter::State::Waiting;
+    m_count++;
+}
+
+void ChangeWaiters::remove(ChangeAwaiter* awaiter)
+{
+    if (awaiter->m_state == ChangeAwaiter::State::Waiting) {
+        const auto it = m_waiting.find(awaiter->m_change.interface);
+        std::erase(it->second, awaiter);
+        if (it->second.empty()) {
+            m_waiting.erase(it);
+        }
+        m_count--;
+    } else if (awaiter->m_state == ChangeAwaiter::State::Resuming) {
+        std::ranges::replace(m_resuming, awaiter, nullptr);
+    }
+    awaiter->m_state = ChangeAwaiter::State::Idle;
+}
+
+void ChangeWaiters::resume(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker)
+{
+    if (tracker.hasChanges()) {
+        resume(intf, &tracker, tracker.changedFlags());
+    }
+}
+
+void ChangeWaiters::resume(const network::Interface& intf,
+                           const NetworkInterfaceStatusTracker& tracker,
+                           const ChangedFlags& changed)
+{
+    if (changed.any()) {
+        resume(intf, &tracker, changed);
+    }
+}
+
+/**
+ * @brief Also tells the awaiters of the interface that are about to be resumed with its changes, as a resumed coroutine
+ * may remove the interface by driving the monitor, after which its tracker is gone.
+ */
+void ChangeWaiters::resumeRemoved(const network::Interface& intf)
+{
+    for (auto* awaiter : m_resuming) {
+        if (awaiter != nullptr && awaiter->m_change.interface == intf) {
+            awaiter->m_change = {.interface = intf, .changed = {}, .tracker = nullptr};
+        }
+    }
+    resume(intf, nullptr, {});
+}
+
+/**
+ * @brief Takes the awaiters of the changes out of m_waiting before resuming any of them.
+ *
+ * Resumed coroutines may wait again, which waits for the next changes, and may destroy awaiters about to be resumed,
+ * which remove() takes care of. Resuming may nest when a resumed coroutine drives the monitor, hence the offset.
+ */
+void ChangeWaiters::resume(const network::Interface& intf,
+                           const NetworkInterfaceStatusTracker* tracker,
+                           const ChangedFlags& changed)
+{
+    const auto it = m_waiting.find(intf);
+    if (it == m_waiting.end()) {
+        return;
+    }
+    const auto first = m_resuming.size();
+    auto& waiting = it->second;
+    for (auto* awaiter : waiting) {
+        const auto wanted = tracker != nullptr ? awaiter->m_interest & changed : ChangedFlags {};
+        if (tracker != nullptr && wanted.none()) {
+            continue;
+        }
+        awaiter->m_change = {.interface = intf, .changed = wanted, .tracker = tracker};
+        awaiter->m_state = ChangeAwaiter::State::Resuming;
+        m_resuming.push_back(awaiter);
+    }
+    std::erase_if(waiting,
+                  [](const ChangeAwaiter* awaiter) { return awaiter->m_state == ChangeAwaiter::State::Resuming; });
+    m_count -= m_resuming.size() - first;
+    if (waiting.empty()) {
+        m_waiting.erase(it);
+    }
+    for (auto i = first; i < m_resuming.size(); ++i) {
+        auto* awaiter = std::exchange(m_resuming[i], nullptr);
+        if (awaiter != nullptr) {
+            awaiter->m_state = ChangeAwaiter::State::Idle;
+            awaiter->m_handle.resume();
+        }
+    }
+    m_resuming.resize(first);
+}
+
+}  // namespace monkas::monitor
@@ -0,0 +1,223 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <monitor/ChangeWaiters.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+using monkas::network::Interface;
+
+// starts right away and keeps its frame until destroyed
+struct Task
+{
+    struct promise_type
+    {
+        auto get_return_object() -> Task { return Task {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+
+        static auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+
+        static auto final_suspend() noexcept -> std::suspend_always { return {}; }
+
+        static void return_void() {}
+
+        static void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> h)
+        : handle {h}
+    {
+    }
+
+    ~Task()
+    {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : handle {std::exchange(other.handle, {})}
+    {
+    }
+
+    auto operator=(const Task&) -> Task& = delete;
+    auto operator=(Task&&) -> Task& = delete;
+
+    [[nodiscard]] auto done() const -> bool { return handle.done(); }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+auto waitOnce(ChangeWaiters& waiters, Interface intf, ChangedFlags interest, std::optional<InterfaceChange>& result)
+    -> Task
+{
+    result = co_await ChangeAwaiter {waiters, intf, interest};
+}
+
+auto waitRepeatedly(ChangeWaiters& waiters, Interface intf, std::vector<ChangedFlags>& seen) -> Task
+{
+    for (;;) {
+        const auto change = co_await ChangeAwaiter {waiters, intf, ChangedFlags::all()};
+        if (change.tracker == nullptr) {
+            co_return;
+        }
+        seen.push_back(change.changed);
+    }
+}
+
+// destroys the other task once resumed
+auto waitAndDestroy(ChangeWaiters& waiters,
+                    Interface intf,
+                    std::optional<InterfaceChange>& result,
+                    std::optional<Task>& other) -> Task
+{
+    result = co_await ChangeAwaiter {waiters, intf, ChangedFlags::all()};
+    other.reset();
+}
+
+auto flags(std::initializer_list<ChangedFlag> list) -> ChangedFlags
+{
+    ChangedFlags result;
+    for (const auto flag : list) {
+        result.set(flag);
+    }
+    return result;
+}
+
+TEST_SUITE("[monitor::ChangeWaiters]")
+{
+    TEST_CASE("only the changes waited for resume")
+    {
+        ChangeWaiters waiters;
+        const Interface eth0 {1, "eth0"};
+        std::optional<InterfaceChange> operState;
+        std::optional<InterfaceChange> mac;
+        const auto operStateTask = waitOnce(waiters, eth0, flags({ChangedFlag::OperationalState}), operState);
+        const auto macTask = waitOnce(waiters, eth0, flags({ChangedFlag::MacAddress}), mac);
+        CHECK(waiters.size() == 2);
+
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setOperationalState(OperationalState::Up);
+        tracker.updateLinkFlags(LinkFlags {1U});
+        waiters.resume(eth0, tracker);
+
+        REQUIRE(operState.has_value());
+        CHECK(operStateTask.done());
+        CHECK(operState->interface == eth0);
+        CHECK(operState->changed == flags({ChangedFlag::OperationalState}));
+        CHECK(operState->tracker == &tracker);
+        CHECK_FALSE(mac.has_value());
+        CHECK_FALSE(macTask.done());
+        CHECK(waiters.size() == 1);
+    }
+
+    TEST_CASE("changes of other interfaces do not resume")
+    {
+        ChangeWaiters waiters;
+        std::optional<InterfaceChange> result;
+        const auto task = waitOnce(waiters, Interface {1, "eth0"}, ChangedFlags::all(), result);
+
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setOperationalState(OperationalState::Up);
+        waiters.resume(Interface {2, "eth1"}, tracker);
+        CHECK_FALSE(result.has_value());
+
+        NetworkInterfaceStatusTracker unchanged;
+        waiters.resume(Interface {1, "eth0"}, unchanged);
+        CHECK_FALSE(result.has_value());
+    }
+
+    TEST_CASE("waiting again waits for the next changes")
+    {
+        ChangeWaiters waiters;
+        const Interface eth0 {1, "eth0"};
+        std::vector<ChangedFlags> seen;
+        const auto task = waitRepeatedly(waiters, eth0, seen);
+
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setOperationalState(OperationalState::Up);
+        waiters.resume(eth0, tracker);
+        tracker.clearChangedFlags();
+        tracker.setName("lan0");
+        waiters.resume(eth0, tracker);
+        REQUIRE(seen.size() == 2);
+        CHECK(seen[0] == flags({ChangedFlag::OperationalState}));
+        CHECK(seen[1] == flags({ChangedFlag::Name}));
+        CHECK(waiters.size() == 1);
+
+        waiters.resumeRemoved(eth0);
+        CHECK(task.done());
+        CHECK(waiters.empty());
+    }
+
+    TEST_CASE("removed interfaces resume without changes")
+    {
+        ChangeWaiters waiters;
+        const Interface eth0 {1, "eth0"};
+        std::optional<InterfaceChange> result;
+        const auto task = waitOnce(waiters, eth0, flags({ChangedFlag::GatewayAddress}), result);
+        waiters.resumeRemoved(eth0);
+        REQUIRE(result.has_value());
+        CHECK(result->changed.none());
+        CHECK(result->tracker == nullptr);
+    }
+
+    TEST_CASE("destroying a waiting coroutine stops waiting")
+    {
+        ChangeWaiters waiters;
+        const Interface eth0 {1, "eth0"};
+        std::optional<InterfaceChange> result;
+        {
+            const auto task = waitOnce(waiters, eth0, ChangedFlags::all(), result);
+            CHECK(waiters.size() == 1);
+        }
+        CHECK(waiters.empty());
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setOperationalState(OperationalState::Up);
+        waiters.resume(eth0, tracker);
+        CHECK_FALSE(result.has_value());
+    }
+
+    TEST_CASE("coroutines destroyed while others resume are skipped")
+    {
+        ChangeWaiters waiters;
+        const Interface eth0 {1, "eth0"};
+        std::optional<InterfaceChange> second;
+        std::optional<Task> secondTask;
+        std::optional<InterfaceChange> first;
+        const auto firstTask = waitAndDestroy(waiters, eth0, first, secondTask);
+        secondTask.emplace(waitOnce(waiters, eth0, ChangedFlags::all(), second));
+
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setOperationalState(OperationalState::Up);
+        waiters.resume(eth0, tracker);
+        CHECK(first.has_value());
+        CHECK_FALSE(second.has_value());
+        CHECK(waiters.empty());
+    }
+
+    TEST_CASE("coroutines outliving the waiters are left suspended")
+    {
+        std::optional<InterfaceChange> result;
+        std::optional<ChangeWaiters> waiters;
+        waiters.emplace();
+        const auto task = waitOnce(*waiters, Interface {1, "eth0"}, ChangedFlags::all(), result);
+        waiters.reset();
+        CHECK_FALSE(task.done());
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
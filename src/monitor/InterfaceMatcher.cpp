@@ -0,0 +1,122 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <optional>
+
+#include <monitor/InterfaceMatcher.hpp>
+
+namespace monkas::monitor
+{
+
+auto InterfaceMatcher::add(const InterfacePattern& pattern) -> std::size_t
+{
+    const auto id = m_patterns.size();
+    // an empty glob matches every name
+    const auto glob = pattern.name.empty() ? std::string {"*"} : pattern.name;
+    const auto wildcard = glob.find_first_of("*?");
+    const auto prefix = std::string_view {glob}.substr(0, wildcard);
+    std::size_t node = 0;
+    for (const auto c : prefix) {
+        auto next = child(node, c);
+        if (next == 0) {
+            next = m_nodes.size();
+            m_nodes.emplace_back();
+            m_nodes[node].children.emplace_back(c, next);
+        }
+        node = next;
+    }
+    m_nodes[node].patterns.push_back(id);
+    m_patterns.push_back({
+        .rest = wildcard == std::string::npos ? std::string {} : glob.substr(wildcard),
+        .linkTypes = {pattern.linkTypes.begin(), pattern.linkTypes.end()},
+        .linkKinds = {pattern.linkKinds.begin(), pattern.linkKinds.end()},
+        .requiredFlags = pattern.requiredFlags.toU32(),
+        .excludedFlags = pattern.excludedFlags.toU32(),
+    });
+    return id;
+}
+
+void InterfaceMatcher::clear()
+{
+    m_nodes.assign(1, Node {});
+    m_patterns.clear();
+}
+
+void InterfaceMatcher::match(const Link& link, std::vector<std::size_t>& matches) const
+{
+    const auto first = matches.size();
+    std::size_t node = 0;
+    for (std::size_t consumed = 0;; ++consumed) {
+        for (const auto id : m_nodes[node].patterns) {
+            if (satisfies(m_patterns[id], link, link.name.substr(consumed))) {
+                matches.push_back(id);
+            }
+        }
+        if (consumed == link.name.size()) {
+            break;
+        }
+        node = child(node, link.name[consumed]);
+        if (node == 0) {
+            break;
+        }
+    }
+    std::sort(matches.begin() + static_cast<std::ptrdiff_t>(first), matches.end());
+}
+
+auto InterfaceMatcher::globMatches(const std::string_view glob, const std::string_view name) -> bool
+{
+    std::size_t g = 0;
+    std::size_t n = 0;
+    // where the last star was, and how much of the name it took so far, for backtracking
+    std::optional<std::size_t> star;
+    std::size_t starTook = 0;
+    while (n < name.size()) {
+        if (g < glob.size() && glob[g] == '*') {
+            star = g++;
+            starTook = n;
+        } else if (g < glob.size() && (glob[g] == '?' || glob[g] == name[n])) {
+            ++g;
+            ++n;
+        } else if (star.has_value()) {
+            g = *star + 1;
+            n = ++starTook;
+        } else {
+            return false;
+        }
+    }
+    while (g < glob.size() && glob[g] == '*') {
+        ++g;
+    }
+    return g == glob.size();
+}
+
+auto InterfaceMatcher::child(const std::size_t node, const char c) const -> std::size_t
+{
+    for (const auto& [label, next] : m_nodes[node].children) {
+        if (label == c) {
+            return next;
+        }
+    }
+    return 0;
+}
+
+auto InterfaceMatcher::satisfies(const Pattern& pattern, const Link& link, const std::string_view rest) -> bool
+{
+    const auto flags = link.flags.toU32();
+    if ((flags & pattern.requiredFlags) != pattern.requiredFlags || (flags & pattern.excludedFlags) != 0) {
+        return false;
+    }
+    if (!pattern.linkTypes.empty() && !std::ranges::binary_search(pattern.linkTypes, link.type)) {
+        return false;
+    }
+    if (!pattern.linkKinds.empty() && std::ranges::find(pattern.linkKinds, link.kind) == pattern.linkKinds.end()) {
+        return false;
+    }
+    if (pattern.rest.empty()) {
+        return rest.empty();
+    }
+    return pattern.rest == "*" || globMatches(pattern.rest, rest);
+}
+
+}  // namespace monkas::monitor
@@ -0,0 +1,80 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <monitor/InterfacePattern.hpp>
+#include <monitor/NetworkInterfaceStatusTracker.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief InterfacePatterns compiled for matching an interface against all of them in a single pass.
+ *
+ * The literal prefixes of the name globs, up to their first wildcard, form a trie. A name only visits the patterns
+ * whose prefix it starts with, and only the rest of their glob is matched against the rest of the name. The link flags
+ * are compared as bitmasks, the link types by a binary search.
+ */
+class InterfaceMatcher
+{
+  public:
+    // what is known of an interface when it is learned
+    struct Link
+    {
+        std::string_view name {};
+        uint16_t type {};
+        std::string_view kind {};
+        NetworkInterfaceStatusTracker::LinkFlags flags {};
+    };
+
+    /* @note: the ids of the patterns count up from 0 in the order they are added */
+    auto add(const InterfacePattern& pattern) -> std::size_t;
+    void clear();
+
+    [[nodiscard]] auto size() const -> std::size_t { return m_patterns.size(); }
+
+    [[nodiscard]] auto empty() const -> bool { return m_patterns.empty(); }
+
+    /* @note: appends the ids of the matching patterns, in ascending order */
+    void match(const Link& link, std::vector<std::size_t>& matches) const;
+
+    /* @note: * matches any number of characters and ? exactly one */
+    [[nodiscard]] static auto globMatches(std::string_view glob, std::string_view name) -> bool;
+
+  private:
+    struct Pattern
+    {
+        // the glob after the literal prefix, empty if the name must end with the prefix
+        std::string rest;
+        // sorted
+        std::vector<uint16_t> linkTypes;
+        std::vector<std::string> linkKinds;
+        uint32_t requiredFlags {};
+        uint32_t excludedFlags {};
+    };
+
+    struct Node
+    {
+        std::vector<std::pair<char, std::size_t>> children;
+        // the patterns whose literal prefix ends here
+        std::vector<std::size_t> patterns;
+    };
+
+    // 0 if there is none, as the root is no child
+    [[nodiscard]] auto child(std::size_t node, char c) const -> std::size_t;
+    [[nodiscard]] static auto satisfies(const Pattern& pattern, const Link& link, std::string_view rest) -> bool;
+
+    // the root first
+    std::vector<Node> m_nodes {Node {}};
+    std::vector<Pattern> m_patterns;
+};
+
+}  // namespace monkas::monitor
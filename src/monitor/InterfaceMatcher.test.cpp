@@ -0,0 +1,97 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <linux/if_arp.h>
+#include <monitor/InterfaceMatcher.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+
+using LinkFlag = NetworkInterfaceStatusTracker::LinkFlag;
+using LinkFlags = NetworkInterfaceStatusTracker::LinkFlags;
+
+auto up() -> LinkFlags
+{
+    LinkFlags flags;
+    flags.set(LinkFlag::Up);
+    return flags;
+}
+
+auto matching(const InterfaceMatcher& matcher, const InterfaceMatcher::Link& link) -> std::vector<std::size_t>
+{
+    std::vector<std::size_t> matches;
+    matcher.match(link, matches);
+    return matches;
+}
+
+TEST_SUITE("[monitor::InterfaceMatcher]")
+{
+    TEST_CASE("globs")
+    {
+        CHECK(InterfaceMatcher::globMatches("eth0", "eth0"));
+        CHECK_FALSE(InterfaceMatcher::globMatches("eth0", "eth01"));
+        CHECK(InterfaceMatcher::globMatches("eth?", "eth1"));
+        CHECK_FALSE(InterfaceMatcher::globMatches("eth?", "eth"));
+        CHECK(InterfaceMatcher::globMatches("*", ""));
+        CHECK(InterfaceMatcher::globMatches("veth*", "veth"));
+        CHECK(InterfaceMatcher::globMatches("*peer*1", "vpeer-a1"));
+        CHECK(InterfaceMatcher::globMatches("a*b*c", "aXbYbZc"));
+        CHECK_FALSE(InterfaceMatcher::globMatches("a*b*c", "aXbYbZ"));
+    }
+
+    TEST_CASE("names by prefix, glob and exact name")
+    {
+        InterfaceMatcher matcher;
+        const auto veth = matcher.add({.name = "veth*"});
+        const auto eth = matcher.add({.name = "eth?"});
+        const auto exact = matcher.add({.name = "eth0"});
+        const auto any = matcher.add({});
+        CHECK(matcher.size() == 4);
+
+        CHECK(matching(matcher, {.name = "veth12"}) == std::vector {veth, any});
+        CHECK(matching(matcher, {.name = "eth0"}) == std::vector {eth, exact, any});
+        CHECK(matching(matcher, {.name = "eth1"}) == std::vector {eth, any});
+        CHECK(matching(matcher, {.name = "eth10"}) == std::vector {any});
+        CHECK(matching(matcher, {.name = "wlan0"}) == std::vector {any});
+    }
+
+    TEST_CASE("link types, kinds and flags")
+    {
+        InterfaceMatcher matcher;
+        const auto ether = matcher.add({.linkTypes = {ARPHRD_ETHER, ARPHRD_IEEE80211}});
+        const auto veth = matcher.add({.name = "v*", .linkKinds = {"veth"}});
+        const auto upOnly = matcher.add({.requiredFlags = up()});
+        const auto downOnly = matcher.add({.excludedFlags = up()});
+
+        CHECK(matching(matcher, {.name = "v0", .type = ARPHRD_ETHER, .kind = "veth", .flags = up()})
+              == std::vector {ether, veth, upOnly});
+        CHECK(matching(matcher, {.name = "lo", .type = ARPHRD_LOOPBACK}) == std::vector {downOnly});
+        CHECK(matching(matcher, {.name = "v1", .type = ARPHRD_ETHER, .kind = "bridge"})
+              == std::vector {ether, downOnly});
+        CHECK(matching(matcher, {.name = "x0", .type = ARPHRD_ETHER, .kind = "veth"}) == std::vector {ether, downOnly});
+    }
+
+    TEST_CASE("appends and clears")
+    {
+        InterfaceMatcher matcher;
+        CHECK(matcher.empty());
+        matcher.add({.name = "eth*"});
+        std::vector<std::size_t> matches {42};
+        matcher.match({.name = "eth0"}, matches);
+        CHECK(matches == std::vector<std::size_t> {42, 0});
+        matcher.clear();
+        CHECK(matcher.empty());
+        CHECK(matching(matcher, {.name = "eth0"}).empty());
+        CHECK(matcher.add({.name = "wlan*"}) == 0);
+        CHECK(matching(matcher, {.name = "wlan0"}) == std::vector<std::size_t> {0});
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
@@ -0,0 +1,409 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <monitor/InterfaceSnapshots.hpp>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <util/SeqLock.hpp>
+
+namespace monkas::monitor
+{
+
+namespace
+{
+struct Published
+{
+    bool removed {true};
+    InterfaceSnapshot snapshot;
+};
+
+static_assert(std::is_trivially_copyable_v<Published>, "snapshots are copied by readers racing with the writer");
+
+auto toSnapshot(const uint32_t ifIndex, const NetworkInterfaceStatusTracker& tracker) -> InterfaceSnapshot
+{
+    InterfaceSnapshot snapshot {};
+    snapshot.index = ifIndex;
+    const auto& name = tracker.name();
+    std::copy_n(name.begin(), std::min(name.size(), snapshot.nameBuffer.size() - 1), snapshot.nameBuffer.begin());
+    snapshot.operationalState = tracker.operationalState();
+    snapshot.linkFlags = tracker.linkFlags();
+    snapshot.macAddress = tracker.macAddress();
+    snapshot.broadcastAddress = tracker.broadcastAddress();
+    snapshot.gatewayAddress = tracker.gatewayAddress();
+    for (const auto& address : tracker.networkAddresses()) {
+        if (snapshot.addressCount == snapshot.addressBuffer.size()) {
+            snapshot.addressesTruncated = true;
+            break;
+        }
+        snapshot.addressBuffer[snapshot.addressCount++] = address;
+    }
+    return snapshot;
+}
+
+auto roundedCapacity(const std::size_t capacity) -> std::size_t
+{
+    return std::bit_ceil(capacity == 0 ? 1U : capacity);
+}
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "the generation is waited on as a futex");
+
+// without FUTEX_PRIVATE_FLAG, for the waiters of other processes mapping the same segment
+auto futexWait(const std::atomic<uint32_t>& word, const uint32_t expected, const timespec& timeout) -> long
+{
+    return syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+}  // namespace
+
+struct InterfaceSnapshots::Slot
+{
+    // the interface last published in the slot, 0 while the slot was never taken
+    std::atomic<uint32_t> ifIndex {0};
+    util::SeqLock<Published> published;
+    // writer only, whether the slot can be taken by another interface
+    bool vacant {true};
+};
+
+/**
+ * @brief Precedes the slots, the same on the heap and in shared memory.
+ *
+ * A shared segment is only read by processes of the same layout, told by the version and the sizes.
+ */
+struct InterfaceSnapshots::Header
+{
+    static constexpr uint64_t MAGIC = 0x534b4e53'53414b4e;  // "NKASSNKS"
+    static constexpr uint32_t LAYOUT_VERSION = 1;
+
+    // written last, once the slots are constructed
+    std::atomic<uint64_t> magic {0};
+    uint32_t version {LAYOUT_VERSION};
+    uint32_t slotSize {sizeof(Slot)};
+    uint64_t capacity {};
+    std::atomic<uint64_t> size {0};
+    // bumped by every commit(), the futex the readers wait on
+    std::atomic<uint32_t> generation {0};
+    // the readers of the same process waiting, readers of a read only mapping cannot count themselves
+    std::atomic<uint32_t> waiters {0};
+    std::atomic<uint32_t> closed {0};
+};
+
+namespace
+{
+template<typename Header, typename Slot>
+constexpr auto slotsOffset() -> std::size_t
+{
+    return (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+}
+}  // namespace
+
+/**
+ * @brief The memory of the header and the slots, allocated on the heap or mapped from a shared memory segment.
+ */
+struct InterfaceSnapshots::Storage
+{
+    static constexpr std::size_t SLOTS_OFFSET = slotsOffset<Header, Slot>();
+    static constexpr std::align_val_t ALIGNMENT {std::max(alignof(Header), alignof(Slot))};
+
+    static auto sizeFor(const std::size_t capacity) -> std::size_t { return SLOTS_OFFSET + (capacity * sizeof(Slot)); }
+
+    Storage(void* memory, const std::size_t size, const bool shared, const bool writable, const int fd)
+        : memory {memory}
+        , size {size}
+        , shared {shared}
+        , writable {writable}
+        , fd {fd}
+    {
+    }
+
+    ~Storage()
+    {
+        if (shared) {
+            munmap(memory, size);
+        } else {
+            ::operator delete(memory, ALIGNMENT);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    Storage(const Storage&) = delete;
+    Storage(Storage&&) = delete;
+    auto operator=(const Storage&) -> Storage& = delete;
+    auto operator=(Storage&&) -> Storage& = delete;
+
+    void* memory;
+    std::size_t size;
+    bool shared;
+    // false for the readers of another process, which map the segment read only
+    bool writable;
+    // the segment of the creator, -1 otherwise
+    int fd;
+};
+
+InterfaceSnapshots::InterfaceSnapshots(const std::size_t capacity)
+    : InterfaceSnapshots(std::make_unique<Storage>(::operator new(Storage::sizeFor(roundedCapacity(capacity)),
+                                                                  Storage::ALIGNMENT),
+                                                   Storage::sizeFor(roundedCapacity(capacity)),
+                                                   false,
+                                                   true,
+                                                   -1),
+                         roundedCapacity(capacity))
+{
+}
+
+/* @note: constructs the header and the slots unless the storage is only read */
+InterfaceSnapshots::InterfaceSnapshots(std::unique_ptr<Storage> storage, const std::size_t capacity)
+    : m_capacity {capacity}
+    , m_storage {std::move(storage)}
+    , m_header {static_cast<Header*>(m_storage->memory)}
+    , m_slots {reinterpret_cast<Slot*>(static_cast<std::byte*>(m_storage->memory) + Storage::SLOTS_OFFSET)}
+{
+    if (!m_storage->writable) {
+        return;
+    }
+    m_header = new (m_storage->memory) Header {};
+    m_header->capacity = m_capacity;
+    std::uninitialized_default_construct_n(m_slots, m_capacity);
+    m_header->magic.store(Header::MAGIC, std::memory_order_release);
+}
+
+/* @note: tells the readers of a shared segment that it is no longer published into */
+InterfaceSnapshots::~InterfaceSnapshots()
+{
+    if (m_storage->shared && m_storage->writable) {
+        m_header->closed.store(1, std::memory_order_release);
+        commit();
+    }
+}
+
+auto InterfaceSnapshots::createShared(const std::string& path, const std::size_t capacity)
+    -> std::shared_ptr<InterfaceSnapshots>
+{
+    const auto rounded = roundedCapacity(capacity);
+    const auto size = Storage::sizeFor(rounded);
+    int fd = -1;
+    if (path.empty()) {
+        fd = memfd_create("monkas-snapshots", MFD_CLOEXEC);
+    } else {
+        // readers still mapping a replaced segment are told by the previous creator closing it
+        unlink(path.c_str());
+        constexpr mode_t READABLE_BY_ALL = 0644;
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, READABLE_BY_ALL);
+    }
+    if (fd < 0) {
+        spdlog::warn("Cannot create shared snapshots {}: {}", path, strerror(errno));
+        return nullptr;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        spdlog::warn("Cannot size shared snapshots {}: {}", path, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    auto* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        spdlog::warn("Cannot map shared snapshots {}: {}", path, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    // not make_shared, the constructor is private
+    return std::shared_ptr<InterfaceSnapshots>(
+        new InterfaceSnapshots(std::make_unique<Storage>(memory, size, true, true, fd), rounded));
+}
+
+auto InterfaceSnapshots::openShared(const std::string& path) -> std::shared_ptr<const InterfaceSnapshots>
+{
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::warn("Cannot open shared snapshots {}: {}", path, strerror(errno));
+        return nullptr;
+    }
+    struct stat status {};
+    if (fstat(fd, &status) < 0 || static_cast<std::size_t>(status.st_size) < Storage::SLOTS_OFFSET) {
+        spdlog::warn("Cannot open shared snapshots {}: too small", path);
+        close(fd);
+        return nullptr;
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    auto* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid without the descriptor
+    close(fd);
+    if (memory == MAP_FAILED) {
+        spdlog::warn("Cannot map shared snapshots {}: {}", path, strerror(errno));
+        return nullptr;
+    }
+    auto storage = std::make_unique<Storage>(memory, size, true, false, -1);
+    const auto* header = static_cast<const Header*>(memory);
+    const auto capacity = header->capacity;
+    if (header->magic.load(std::memory_order_acquire) != Header::MAGIC || header->version != Header::LAYOUT_VERSION
+        || header->slotSize != sizeof(Slot) || !std::has_single_bit(capacity) || Storage::sizeFor(capacity) > size)
+    {
+        spdlog::warn("Cannot open shared snapshots {}: not created by this version of monkas", path);
+        return nullptr;
+    }
+    return std::shared_ptr<const InterfaceSnapshots>(new InterfaceSnapshots(std::move(storage), capacity));
+}
+
+auto InterfaceSnapshots::sharedMemoryFd() const -> int
+{
+    return m_storage->fd;
+}
+
+auto InterfaceSnapshots::size() const -> std::size_t
+{
+    return m_header->size.load(std::memory_order_relaxed);
+}
+
+auto InterfaceSnapshots::generation() const -> uint32_t
+{
+    return m_header->generation.load(std::memory_order_acquire);
+}
+
+auto InterfaceSnapshots::isClosed() const -> bool
+{
+    return m_header->closed.load(std::memory_order_acquire) != 0;
+}
+
+/**
+ * @brief Sleeps on the generation until commit() bumps it.
+ *
+ * Waiters of the same process count themselves, for commit() to skip waking when nobody waits. Readers of another
+ * process cannot write their read only mapping, so commit() always wakes for a shared segment.
+ */
+auto InterfaceSnapshots::waitForChange(const uint32_t generation, const std::chrono::milliseconds timeout) const
+    -> uint32_t
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    if (m_storage->writable) {
+        m_header->waiters.fetch_add(1);
+    }
+    auto current = m_header->generation.load();
+    while (current == generation) {
+        const auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero()) {
+            break;
+        }
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        const timespec relative {
+            .tv_sec = seconds.count(),
+            .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - seconds).count(),
+        };
+        futexWait(m_header->generation, generation, relative);
+        current = m_header->generation.load();
+    }
+    if (m_storage->writable) {
+        m_header->waiters.fetch_sub(1);
+    }
+    return current;
+}
+
+/**
+ * @brief Probes from the slot of the index on, like allocateSlot() did when publishing it.
+ *
+ * Slots are never given back, so a slot that was never taken ends the search. A slot that changed hands while being
+ * read holds the snapshot of another interface, which is told apart by its index.
+ */
+auto InterfaceSnapshots::find(const uint32_t ifIndex) const -> std::optional<InterfaceSnapshot>
+{
+    const auto mask = m_capacity - 1;
+    for (std::size_t probe = 0; probe < m_capacity; ++probe) {
+        const auto& slot = m_slots[(ifIndex + probe) & mask];
+        const auto taken = slot.ifIndex.load(std::memory_order_acquire);
+        if (taken == 0) {
+            break;
+        }
+        if (taken != ifIndex) {
+            continue;
+        }
+        if (const auto published = slot.published.load(); published.snapshot.index == ifIndex) {
+            if (published.removed) {
+                break;
+            }
+            return published.snapshot;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Takes the first vacant slot from the slot of the index on.
+ *
+ * An interface published again after being removed takes its old slot or one probed before it, so find() sees the
+ * live snapshot before any removed one of the same index.
+ */
+auto InterfaceSnapshots::allocateSlot(const uint32_t ifIndex) -> Slot*
+{
+    const auto mask = m_capacity - 1;
+    for (std::size_t probe = 0; probe < m_capacity; ++probe) {
+        auto& slot = m_slots[(ifIndex + probe) & mask];
+        if (slot.vacant) {
+            slot.vacant = false;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+auto InterfaceSnapshots::publish(const uint32_t ifIndex, const NetworkInterfaceStatusTracker& tracker) -> bool
+{
+    auto it = m_published.find(ifIndex);
+    if (it == m_published.end()) {
+        auto* slot = allocateSlot(ifIndex);
+        if (slot == nullptr) {
+            return false;
+        }
+        it = m_published.emplace(ifIndex, slot).first;
+        m_header->size.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto* slot = it->second;
+    slot->published.store({.removed = false, .snapshot = toSnapshot(ifIndex, tracker)});
+    // after the snapshot, for readers to never find the index with the snapshot of the previous interface only
+    slot->ifIndex.store(ifIndex, std::memory_order_release);
+    return true;
+}
+
+void InterfaceSnapshots::remove(const uint32_t ifIndex)
+{
+    const auto it = m_published.find(ifIndex);
+    if (it == m_published.end()) {
+        return;
+    }
+    auto* slot = it->second;
+    Published removed {};
+    removed.snapshot.index = ifIndex;
+    slot->published.store(removed);
+    slot->vacant = true;
+    m_published.erase(it);
+    m_header->size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/* @note: the generation is bumped before the waiters are counted, a waiter either sees it bumped or is woken */
+void InterfaceSnapshots::commit()
+{
+    m_header->generation.fetch_add(1);
+    if (m_storage->shared || m_header->waiters.load() > 0) {
+        futexWakeAll(m_header->generation);
+    }
+}
+
+}  // namespace monkas::monitor
@@ -0,0 +1,187 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <doctest/doctest.h>
+#include <ip/Address.hpp>
+#include <monitor/InterfaceSnapshots.hpp>
+#include <network/Address.hpp>
+#include <unistd.h>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+using namespace monkas;
+
+auto v4Address(const std::string& address) -> network::Address
+{
+    return {ip::Address::fromString(address),
+            std::nullopt,
+            24,
+            network::Scope::Global,
+            network::AddressFlags {},
+            network::AddressAssignmentProtocol::Unspecified};
+}
+
+TEST_SUITE("[monitor::InterfaceSnapshots]")
+{
+    TEST_CASE("published interfaces are found by index until removed")
+    {
+        InterfaceSnapshots snapshots(4);
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setName("eth0");
+        tracker.setOperationalState(NetworkInterfaceStatusTracker::OperationalState::Up);
+        tracker.addNetworkAddress(v4Address("192.168.1.2"));
+        tracker.setGatewayAddress(ip::Address::fromString("192.168.1.1"));
+        CHECK_FALSE(snapshots.find(2).has_value());
+        CHECK(snapshots.publish(2, tracker));
+        const auto snapshot = snapshots.find(2);
+        REQUIRE(snapshot.has_value());
+        CHECK(snapshot->index == 2);
+        CHECK(snapshot->name() == "eth0");
+        CHECK(snapshot->operationalState == NetworkInterfaceStatusTracker::OperationalState::Up);
+        REQUIRE(snapshot->networkAddresses().size() == 1);
+        CHECK(snapshot->networkAddresses()[0] == v4Address("192.168.1.2"));
+        CHECK(snapshot->gatewayAddress == ip::Address::fromString("192.168.1.1"));
+        CHECK(snapshots.size() == 1);
+        snapshots.remove(2);
+        CHECK_FALSE(snapshots.find(2).has_value());
+        CHECK(snapshots.size() == 0);
+    }
+
+    TEST_CASE("colliding indexes probe further and reuse removed slots")
+    {
+        InterfaceSnapshots snapshots(2);
+        NetworkInterfaceStatusTracker tracker;
+        CHECK(snapshots.publish(2, tracker));
+        CHECK(snapshots.publish(4, tracker));
+        CHECK_FALSE(snapshots.publish(6, tracker));
+        CHECK(snapshots.find(4).has_value());
+        snapshots.remove(2);
+        CHECK_FALSE(snapshots.find(2).has_value());
+        CHECK(snapshots.find(4).has_value());
+        CHECK(snapshots.publish(6, tracker));
+        CHECK(snapshots.find(6).has_value());
+        CHECK(snapshots.find(4).has_value());
+        CHECK_FALSE(snapshots.find(2).has_value());
+    }
+
+    TEST_CASE("names and addresses are truncated to fit")
+    {
+        InterfaceSnapshots snapshots(1);
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setName("a-name-longer-than-ifnamsiz");
+        for (int i = 1; i <= 20; ++i) {
+            tracker.addNetworkAddress(v4Address("10.0.0." + std::to_string(i)));
+        }
+        CHECK(snapshots.publish(1, tracker));
+        const auto snapshot = snapshots.find(1);
+        REQUIRE(snapshot.has_value());
+        CHECK(snapshot->name() == "a-name-longer-t");
+        CHECK(snapshot->networkAddresses().size() == InterfaceSnapshot::MAX_ADDRESSES);
+        CHECK(snapshot->addressesTruncated);
+    }
+
+    TEST_CASE("readers on other threads never see a torn snapshot")
+    {
+        InterfaceSnapshots snapshots(4);
+        std::atomic<bool> done {false};
+        std::atomic<bool> consistent {true};
+        std::thread reader(
+            [&]
+            {
+                while (!done.load()) {
+                    if (const auto snapshot = snapshots.find(1); snapshot.has_value()) {
+                        // every published snapshot has as many addresses as its name has characters
+                        consistent = consistent && snapshot->name().size() == snapshot->networkAddresses().size();
+                    }
+                    std::this_thread::yield();
+                }
+            });
+        NetworkInterfaceStatusTracker tracker;
+        for (int round = 0; round < 2000; ++round) {
+            const auto count = 1 + (round % 10);
+            tracker.setName(std::string(static_cast<std::size_t>(count), 'x'));
+            for (int i = 1; i <= 10; ++i) {
+                if (i <= count) {
+                    tracker.addNetworkAddress(v4Address("10.0.0." + std::to_string(i)));
+                } else {
+                    tracker.removeNetworkAddress(v4Address("10.0.0." + std::to_string(i)));
+                }
+            }
+            snapshots.publish(1, tracker);
+        }
+        done = true;
+        reader.join();
+        CHECK(consistent.load());
+    }
+
+    TEST_CASE("shared snapshots are read through another mapping of the segment")
+    {
+        auto shared = InterfaceSnapshots::createShared({}, 4);
+        REQUIRE(shared != nullptr);
+        REQUIRE(shared->sharedMemoryFd() >= 0);
+        const auto path = "/proc/self/fd/" + std::to_string(shared->sharedMemoryFd());
+        const auto reader = InterfaceSnapshots::openShared(path);
+        REQUIRE(reader != nullptr);
+        CHECK(reader->capacity() == 4);
+        CHECK(reader->sharedMemoryFd() == -1);
+        NetworkInterfaceStatusTracker tracker;
+        tracker.setName("eth0");
+        tracker.addNetworkAddress(v4Address("192.168.1.2"));
+        const auto generation = reader->generation();
+        CHECK(shared->publish(3, tracker));
+        shared->commit();
+        CHECK(reader->generation() != generation);
+        const auto snapshot = reader->find(3);
+        REQUIRE(snapshot.has_value());
+        CHECK(snapshot->name() == "eth0");
+        CHECK(reader->size() == 1);
+        shared->remove(3);
+        CHECK_FALSE(reader->find(3).has_value());
+        CHECK_FALSE(reader->isClosed());
+        shared.reset();
+        CHECK(reader->isClosed());
+    }
+
+    TEST_CASE("waiting readers are woken by a commit or time out")
+    {
+        auto shared = InterfaceSnapshots::createShared({}, 4);
+        REQUIRE(shared != nullptr);
+        const auto reader = InterfaceSnapshots::openShared("/proc/self/fd/" + std::to_string(shared->sharedMemoryFd()));
+        REQUIRE(reader != nullptr);
+        const auto generation = reader->generation();
+        CHECK(reader->waitForChange(generation, std::chrono::milliseconds(1)) == generation);
+        std::thread writer(
+            [&]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                shared->commit();
+            });
+        CHECK(reader->waitForChange(generation, std::chrono::seconds(10)) != generation);
+        writer.join();
+    }
+
+    TEST_CASE("files not created as shared snapshots are rejected")
+    {
+        CHECK(InterfaceSnapshots::openShared("/nonexistent/monkas") == nullptr);
+        char path[] = "/tmp/monkas-snapshots-XXXXXX";
+        const auto fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        const std::string garbage(4096, 'x');
+        CHECK(write(fd, garbage.data(), garbage.size()) == static_cast<ssize_t>(garbage.size()));
+        close(fd);
+        CHECK(InterfaceSnapshots::openShared(path) == nullptr);
+        std::remove(path);
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
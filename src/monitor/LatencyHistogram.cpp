@@ -0,0 +1,49 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include <monitor/LatencyHistogram.hpp>
+
+namespace monkas::monitor
+{
+
+void LatencyHistogram::record(const Duration latency)
+{
+    const auto micros = static_cast<uint64_t>(std::max(latency.count(), Duration::rep {0}));
+    const auto bucket = std::min(static_cast<std::size_t>(std::bit_width(micros)), BUCKET_COUNT - 1);
+    m_buckets[bucket]++;
+    m_count++;
+    m_max = std::max(m_max, latency);
+}
+
+auto LatencyHistogram::percentile(const double fraction) const -> Duration
+{
+    if (m_count == 0) {
+        return Duration {0};
+    }
+    const auto rank =
+        std::max(uint64_t {1}, static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * m_count)));
+    uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < BUCKET_COUNT - 1; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) {
+            return std::min(Duration {uint64_t {1} << bucket}, m_max);
+        }
+    }
+    return m_max;
+}
+
+auto LatencyHistogram::operator+=(const LatencyHistogram& other) -> LatencyHistogram&
+{
+    for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        m_buckets[bucket] += other.m_buckets[bucket];
+    }
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+    return *this;
+}
+
+}  // namespace monkas::monitor
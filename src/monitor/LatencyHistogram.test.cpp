@@ -0,0 +1,74 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <doctest/doctest.h>
+#include <monitor/LatencyHistogram.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+using namespace std::chrono_literals;
+
+TEST_SUITE("[monitor::LatencyHistogram]")
+{
+    TEST_CASE("empty histogram reports nothing")
+    {
+        const LatencyHistogram histogram;
+        CHECK(histogram.count() == 0);
+        CHECK(histogram.percentile(0.5) == 0us);
+        CHECK(histogram.max() == 0us);
+    }
+
+    TEST_CASE("percentiles are the upper bounds of their buckets")
+    {
+        LatencyHistogram histogram;
+        for (int i = 0; i < 99; ++i) {
+            histogram.record(3us);
+        }
+        histogram.record(700us);
+        CHECK(histogram.count() == 100);
+        CHECK(histogram.percentile(0.5) == 4us);
+        CHECK(histogram.percentile(0.99) == 4us);
+        CHECK(histogram.percentile(1.0) == 700us);
+        CHECK(histogram.max() == 700us);
+    }
+
+    TEST_CASE("bucket bounds are capped by the maximum")
+    {
+        LatencyHistogram histogram;
+        histogram.record(0us);
+        histogram.record(5us);
+        CHECK(histogram.percentile(0.5) == 1us);
+        CHECK(histogram.percentile(1.0) == 5us);
+    }
+
+    TEST_CASE("latencies beyond the last bucket are reported as the maximum")
+    {
+        LatencyHistogram histogram;
+        histogram.record(1h);
+        CHECK(histogram.percentile(0.5) == 1h);
+    }
+
+    TEST_CASE("merged histograms report the latencies of both")
+    {
+        LatencyHistogram fast;
+        LatencyHistogram slow;
+        for (int i = 0; i < 90; ++i) {
+            fast.record(3us);
+        }
+        for (int i = 0; i < 10; ++i) {
+            slow.record(700us);
+        }
+        fast += slow;
+        CHECK(fast.count() == 100);
+        CHECK(fast.percentile(0.9) == 4us);
+        CHECK(fast.percentile(0.95) == 700us);
+        CHECK(fast.max() == 700us);
+        CHECK(slow.count() == 10);
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
@@ -0,0 +1,377 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <monitor/MonitorHub.hpp>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+
+namespace monkas::monitor
+{
+namespace
+{
+auto filterFamily(const RuntimeFlags& filters, const ip::Family family) -> bool
+{
+    return (filters.test(RuntimeFlag::PreferredFamilyV4) && family != ip::Family::IPv4)
+        || (filters.test(RuntimeFlag::PreferredFamilyV6) && family != ip::Family::IPv6);
+}
+
+auto filtersFamily(const RuntimeFlags& filters) -> bool
+{
+    return filters.test(RuntimeFlag::PreferredFamilyV4) || filters.test(RuntimeFlag::PreferredFamilyV6);
+}
+}  // namespace
+
+/**
+ * @brief Forwards the notifications of the monitor to a subscriber of a handle, narrowed down by its filters.
+ *
+ * It is subscribed to every interface by a pattern matching all of them, and forwards the changes of the interfaces
+ * the subscriber subscribed to only. Without RuntimeFlag::IncludeNonIeee802 the interfaces that are not Ethernet or
+ * IEEE 802.11 are left out, they are told apart by the link type in the cache, and remembered for their removal, when
+ * the cache no longer knows them. With a preferred family the addresses and gateways of the other family are left out,
+ * and a change of them only is not forwarded at all, a batch tells copies of the changed trackers without them.
+ */
+class MonitorHub::FilteringSubscriber final : public Subscriber
+{
+  public:
+    FilteringSubscriber(NetworkMonitor& monitor,
+                        SubscriberPtr subscriber,
+                        const RuntimeFlags& filters,
+                        const Interfaces& interfaces,
+                        const InterfaceEvents& events)
+        : m_monitor {monitor}
+        , m_subscriber {std::move(subscriber)}
+        , m_filters {filters}
+        , m_events {events}
+        , m_batched {m_subscriber->wantsChangesBatch()}
+    {
+        for (const auto& intf : m_monitor.enumerateInterfaces()) {
+            if (!passes(intf)) {
+                m_excluded.insert(intf);
+            }
+        }
+        for (const auto& intf : interfaces) {
+            if (passes(intf)) {
+                m_interfaces.insert(intf);
+            }
+        }
+    }
+
+    [[nodiscard]] auto passes(const network::Interface& intf) const -> bool
+    {
+        if (m_filters.test(RuntimeFlag::IncludeNonIeee802)) {
+            return true;
+        }
+        const auto* state = m_monitor.interfaceState(intf);
+        return state != nullptr && state->isIeee802();
+    }
+
+    void onInterfaceAdded(const network::Interface& intf) override
+    {
+        if (!passes(intf)) {
+            m_excluded.insert(intf);
+            return;
+        }
+        // left out before under the same index, when its removal was not told
+        m_excluded.erase(intf);
+        m_subscriber->onInterfaceAdded(intf);
+    }
+
+    // the monitor tells the removal of every interface, as all of them are subscribed to
+    void onInterfaceRemoved(const network::Interface& intf) override
+    {
+        m_addresses.erase(intf);
+        if (m_excluded.erase(intf) == 0 && (m_interfaces.contains(intf) || m_events.test(InterfaceEvent::Removed))) {
+            m_subscriber->onInterfaceRemoved(intf);
+        }
+    }
+
+    void onInterfaceNameChanged(const network::Interface& intf) override
+    {
+        if (m_interfaces.contains(intf)) {
+            m_subscriber->onInterfaceNameChanged(intf);
+        }
+    }
+
+    void onLinkFlagsChanged(const network::Interface& intf, const LinkFlags& flags) override
+    {
+        if (m_interfaces.contains(intf)) {
+            m_subscriber->onLinkFlagsChanged(intf, flags);
+        }
+    }
+
+    void onOperationalStateChanged(const network::Interface& intf, const OperationalState state) override
+    {
+        if (m_interfaces.contains(intf)) {
+            m_subscriber->onOperationalStateChanged(intf, state);
+        }
+    }
+
+    void onNetworkAddressesChanged(const network::Interface& intf, const Addresses& addresses) override
+    {
+        if (!m_interfaces.contains(intf)) {
+            return;
+        }
+        if (!filtersFamily(m_filters)) {
+            m_subscriber->onNetworkAddressesChanged(intf, addresses);
+            return;
+        }
+        Addresses filtered;
+        for (const auto& address : addresses) {
+            if (!filterFamily(m_filters, address.family())) {
+                filtered.insert(address);
+            }
+        }
+        if (remember(intf, filtered)) {
+            m_subscriber->onNetworkAddressesChanged(intf, filtered);
+        }
+    }
+
+    void onGatewayAddressChanged(const network::Interface& intf, const std::optional<ip::Address>& gateway) override
+    {
+        if (!m_interfaces.contains(intf) || (gateway.has_value() && filterFamily(m_filters, gateway->family()))) {
+            return;
+        }
+        m_subscriber->onGatewayAddressChanged(intf, gateway);
+    }
+
+    void onMacAddressChanged(const network::Interface& intf, const ethernet::Address& mac) override
+    {
+        if (m_interfaces.contains(intf)) {
+            m_subscriber->onMacAddressChanged(intf, mac);
+        }
+    }
+
+    void onBroadcastAddressChanged(const network::Interface& intf, const ethernet::Address& broadcast) override
+    {
+        if (m_interfaces.contains(intf)) {
+            m_subscriber->onBroadcastAddressChanged(intf, broadcast);
+        }
+    }
+
+    [[nodiscard]] auto wantsChangesBatch() const -> bool override { return m_batched; }
+
+    /**
+     * @brief Forwards the changes of the subscribed interfaces, with a preferred family as filtered copies.
+     *
+     * A copy leaves out the addresses and the gateway of the other family, and the flags of changes to them only.
+     */
+    void onChangesBatch(const std::span<const InterfaceChange> changes) override
+    {
+        m_changes.clear();
+        m_copies.clear();
+        // the changes point into the copies, which must not move
+        m_copies.reserve(changes.size());
+        for (const auto& change : changes) {
+            if (!m_interfaces.contains(change.interface)) {
+                continue;
+            }
+            if (!filtersFamily(m_filters) || change.tracker == nullptr) {
+                m_changes.push_back(change);
+                continue;
+            }
+            auto& copy = m_copies.emplace_back(*change.tracker);
+            // the copy is not the one of the monitor, whose dirty list it must not join
+            copy.setDirtyList(nullptr, {});
+            for (const auto& address : change.tracker->networkAddresses()) {
+                if (filterFamily(m_filters, address.family())) {
+                    copy.removeNetworkAddress(address);
+                }
+            }
+            auto changed = change.changed;
+            if (const auto gateway = copy.gatewayAddress();
+                gateway.has_value() && filterFamily(m_filters, gateway->family()))
+            {
+                copy.clearGatewayAddress(GatewayClearReason::Unfollowed);
+                changed.reset(ChangedFlag::GatewayAddress);
+            }
+            if (changed.test(ChangedFlag::NetworkAddresses) && !remember(change.interface, copy.networkAddresses())) {
+                changed.reset(ChangedFlag::NetworkAddresses);
+            }
+            if (changed.any()) {
+                m_changes.push_back({.interface = change.interface, .changed = changed, .tracker = &copy});
+            }
+        }
+        if (!m_changes.empty()) {
+            m_subscriber->onChangesBatch(m_changes);
+        }
+    }
+
+  private:
+    // remembers the addresses of the preferred family last told, returns whether they differ
+    auto remember(const network::Interface& intf, const Addresses& filtered) -> bool
+    {
+        // the subscription was told the state of the interface anew if it was never told any
+        const auto [it, inserted] = m_addresses.try_emplace(intf, filtered);
+        if (!inserted && it->second == filtered) {
+            return false;
+        }
+        it->second = filtered;
+        return true;
+    }
+
+    NetworkMonitor& m_monitor;
+    SubscriberPtr m_subscriber;
+    RuntimeFlags m_filters;
+    InterfaceEvents m_events;
+    bool m_batched;
+    // the interfaces the subscriber subscribed to that pass the filters
+    Interfaces m_interfaces;
+    // the interfaces left out for their link type
+    Interfaces m_excluded;
+    // with a preferred family, the addresses the subscriber was told last
+    std::map<network::Interface, Addresses> m_addresses;
+    // reused for every batch
+    std::vector<InterfaceChange> m_changes;
+    std::vector<NetworkInterfaceStatusTracker> m_copies;
+};
+
+MonitorHub::MonitorHub(const RuntimeFlags& options, const Tunables& tunables)
+    : m_options {options}
+    , m_monitor {std::make_unique<NetworkMonitor>(options, tunables)}
+{
+    const auto intfs = m_monitor->enumerateInterfaces();
+    spdlog::debug("Hub enumerated {} interfaces", intfs.size());
+    m_thread = std::jthread([this](const std::stop_token& stop) { run(stop); });
+}
+
+MonitorHub::~MonitorHub()
+{
+    m_thread.request_stop();
+    m_monitor->stop();
+    m_thread.join();
+}
+
+auto MonitorHub::create(const RuntimeFlags& options, const Tunables& tunables) -> std::shared_ptr<MonitorHub>
+{
+    // not make_shared, the constructor is private
+    return std::shared_ptr<MonitorHub>(new MonitorHub(options, tunables));
+}
+
+auto MonitorHub::processWide(const Tunables& tunables) -> std::shared_ptr<MonitorHub>
+{
+    static std::mutex mutex;
+    static std::weak_ptr<MonitorHub> processHub;
+    const std::scoped_lock lock {mutex};
+    if (auto hub = processHub.lock()) {
+        return hub;
+    }
+    auto hub = create(defaultOptions(), tunables);
+    processHub = hub;
+    return hub;
+}
+
+auto MonitorHub::defaultOptions() -> RuntimeFlags
+{
+    RuntimeFlags options;
+    options.set(RuntimeFlag::IncludeNonIeee802);
+    return options;
+}
+
+auto MonitorHub::connect(const RuntimeFlags& filters) -> std::unique_ptr<Handle>
+{
+    // not make_unique, the constructor is private
+    return std::unique_ptr<Handle>(new Handle(shared_from_this(), filters));
+}
+
+auto MonitorHub::statistics() const -> NetworkMonitor::Statistics
+{
+    const std::scoped_lock lock {m_mutex};
+    return m_monitor->statistics();
+}
+
+void MonitorHub::run(const std::stop_token& stop)
+{
+    pollfd pfd {m_monitor->fileDescriptor(), POLLIN, 0};
+    while (!stop.stop_requested()) {
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            spdlog::critical("poll failed: {}", strerror(errno));
+            return;
+        }
+        const std::scoped_lock lock {m_mutex};
+        std::ignore = m_monitor->processPending();
+    }
+}
+
+MonitorHub::Handle::Handle(std::shared_ptr<MonitorHub> hub, const RuntimeFlags& filters)
+    : m_hub {std::move(hub)}
+    , m_filters {filters}
+{
+    // a handle narrows down the options of the hub, it cannot widen them
+    for (const auto family : {RuntimeFlag::PreferredFamilyV4, RuntimeFlag::PreferredFamilyV6}) {
+        if (m_hub->options().test(family)) {
+            m_filters.set(family);
+        }
+    }
+    if (m_filters.test(RuntimeFlag::IncludeNonIeee802) && !m_hub->options().test(RuntimeFlag::IncludeNonIeee802)) {
+        spdlog::warn("The hub does not include non IEEE 802.X interfaces, a handle cannot include them");
+        m_filters.reset(RuntimeFlag::IncludeNonIeee802);
+    }
+    m_hub->m_handles.fetch_add(1, std::memory_order_relaxed);
+}
+
+MonitorHub::Handle::~Handle()
+{
+    {
+        const std::scoped_lock lock {m_hub->m_mutex};
+        for (const auto& [subscriber, filter] : m_subscribers) {
+            m_hub->m_monitor->unsubscribe(filter);
+        }
+    }
+    m_hub->m_handles.fetch_sub(1, std::memory_order_relaxed);
+}
+
+auto MonitorHub::Handle::interfaces() const -> Interfaces
+{
+    const std::scoped_lock lock {m_hub->m_mutex};
+    // enumerates no more once the hub did
+    auto intfs = m_hub->m_monitor->enumerateInterfaces();
+    if (m_filters.test(RuntimeFlag::IncludeNonIeee802)) {
+        return intfs;
+    }
+    std::erase_if(intfs,
+                  [this](const auto& intf)
+                  {
+                      const auto* state = m_hub->m_monitor->interfaceState(intf);
+                      return state == nullptr || !state->isIeee802();
+                  });
+    return intfs;
+}
+
+void MonitorHub::Handle::subscribe(const Interfaces& interfaces,
+                                   const SubscriberPtr& subscriber,
+                                   const ChangedFlags& interest,
+                                   const InterfaceEvents& events)
+{
+    if (subscriber == nullptr) {
+        spdlog::warn("Cannot subscribe null subscriber through a hub");
+        return;
+    }
+    const std::scoped_lock lock {m_hub->m_mutex};
+    auto& monitor = *m_hub->m_monitor;
+    if (const auto it = m_subscribers.find(subscriber); it != m_subscribers.end()) {
+        monitor.unsubscribe(it->second);
+        m_subscribers.erase(it);
+    }
+    auto filter = std::make_shared<FilteringSubscriber>(monitor, subscriber, m_filters, interfaces, events);
+    m_subscribers.emplace(subscriber, filter);
+    // an empty pattern matches every interface, so the filter is told about the ones added later
+    monitor.subscribeMatching({InterfacePattern {}}, filter, interest, events);
+}
+
+void MonitorHub::Handle::unsubscribe(const SubscriberPtr& subscriber)
+{
+    const std::scoped_lock lock {m_hub->m_mutex};
+    if (const auto it = m_subscribers.find(subscriber); it != m_subscribers.end()) {
+        m_hub->m_monitor->unsubscribe(it->second);
+        m_subscribers.erase(it);
+    }
+}
+
+}  // namespace monkas::monitor
@@ -0,0 +1,389 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <latch>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <monitor/NamespaceMonitorPool.hpp>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <util/WorkStealingPool.hpp>
+
+namespace monkas::monitor
+{
+namespace
+{
+template<typename T>
+[[noreturn]] void pfatal(const T& msg)
+{
+    const auto err = errno;
+    spdlog::flush_on(spdlog::level::critical);
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    spdlog::critical("{} failed: {}[{}]", msg, strerror(err), err);
+    std::abort();
+}
+
+// tags the wakeup of stop() among the indexes of the namespaces in the epoll events
+constexpr uint64_t WAKEUP_EVENT = ~uint64_t {0};
+constexpr std::size_t EVENTS_PER_WAIT = 64;
+// bounds how long a busy namespace keeps a thread from the others
+constexpr std::size_t DATAGRAMS_PER_TASK = 64;
+}  // namespace
+
+struct NamespaceMonitorPool::Namespace
+{
+    std::string path;
+    int32_t id {};
+    int fd {-1};
+    std::unique_ptr<NetworkMonitor> monitor;
+    std::shared_ptr<Forwarder> forwarder;
+    // as enumerated, tagged with the id
+    Interfaces interfaces;
+    // a copy of the statistics of the monitor, updated by the thread that processed it last
+    mutable std::mutex statisticsMutex;
+    NetworkMonitor::Statistics statistics;
+    bool opened {false};
+};
+
+template<typename Notify>
+void NamespaceMonitorPool::forward(const Notify& notify)
+{
+    const std::scoped_lock lock {m_streamMutex};
+    for (const auto& subscriber : m_subscribers) {
+        notify(*subscriber);
+    }
+}
+
+/**
+ * @brief Subscribes to all interfaces of a namespace and forwards their notifications tagged with the namespace.
+ *
+ * It subscribes by a pattern every interface matches, so the monitor follows the interfaces as they come and go without
+ * the subscription being changed from within the notifications.
+ */
+class NamespaceMonitorPool::Forwarder final : public Subscriber
+{
+  public:
+    Forwarder(NamespaceMonitorPool& pool, const Namespace& ns)
+        : m_pool {pool}
+        , m_ns {ns}
+    {
+    }
+
+    void onInterfaceAdded(const network::Interface& intf) override
+    {
+        forward(intf,
+                [](Subscriber& subscriber, const network::Interface& tagged) { subscriber.onInterfaceAdded(tagged); });
+    }
+
+    void onInterfaceRemoved(const network::Interface& intf) override
+    {
+        forward(intf,
+                [](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onInterfaceRemoved(tagged); });
+    }
+
+    void onInterfaceNameChanged(const network::Interface& intf) override
+    {
+        forward(intf,
+                [](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onInterfaceNameChanged(tagged); });
+    }
+
+    void onLinkFlagsChanged(const network::Interface& intf, const LinkFlags& flags) override
+    {
+        forward(intf,
+                [&flags](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onLinkFlagsChanged(tagged, flags); });
+    }
+
+    void onOperationalStateChanged(const network::Interface& intf, const OperationalState state) override
+    {
+        forward(intf,
+                [state](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onOperationalStateChanged(tagged, state); });
+    }
+
+    void onNetworkAddressesChanged(const network::Interface& intf, const Addresses& addresses) override
+    {
+        forward(intf,
+                [&addresses](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onNetworkAddressesChanged(tagged, addresses); });
+    }
+
+    void onGatewayAddressChanged(const network::Interface& intf, const std::optional<ip::Address>& gateway) override
+    {
+        forward(intf,
+                [&gateway](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onGatewayAddressChanged(tagged, gateway); });
+    }
+
+    void onMacAddressChanged(const network::Interface& intf, const ethernet::Address& mac) override
+    {
+        forward(intf,
+                [&mac](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onMacAddressChanged(tagged, mac); });
+    }
+
+    void onBroadcastAddressChanged(const network::Interface& intf, const ethernet::Address& broadcast) override
+    {
+        forward(intf,
+                [&broadcast](Subscriber& subscriber, const network::Interface& tagged)
+                { subscriber.onBroadcastAddressChanged(tagged, broadcast); });
+    }
+
+  private:
+    template<typename Notify>
+    void forward(const network::Interface& intf, const Notify& notify)
+    {
+        const network::Interface tagged {intf.index(), intf.name(), m_ns.id};
+        m_pool.forward([&tagged, &notify](Subscriber& subscriber) { notify(subscriber, tagged); });
+    }
+
+    NamespaceMonitorPool& m_pool;
+    const Namespace& m_ns;
+};
+
+NamespaceMonitorPool::NamespaceMonitorPool(std::vector<std::string> namespaces,
+                                           const RuntimeFlags& options,
+                                           const Tunables& tunables,
+                                           const std::size_t threads)
+    : m_options {options}
+    , m_tunables {tunables}
+{
+    if (m_options.test(RuntimeFlag::ListenAllNamespaces)) {
+        spdlog::warn("RuntimeFlag::ListenAllNamespaces is ignored by the NamespaceMonitorPool");
+        m_options.reset(RuntimeFlag::ListenAllNamespaces);
+    }
+    m_ownNamespaceFd = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+    if (m_ownNamespaceFd < 0) {
+        pfatal("open(/proc/thread-self/ns/net)");
+    }
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+        pfatal("epoll_create1");
+    }
+    m_wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeupFd < 0) {
+        pfatal("eventfd");
+    }
+    epoll_event wakeup {.events = EPOLLIN, .data = {.u64 = WAKEUP_EVENT}};
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeupFd, &wakeup) < 0) {
+        pfatal("epoll_ctl");
+    }
+    for (auto& path : namespaces) {
+        auto ns = std::make_unique<Namespace>();
+        ns->id = static_cast<int32_t>(m_namespaces.size());
+        ns->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (ns->fd < 0) {
+            spdlog::warn("Cannot open network namespace {}: {}", path, strerror(errno));
+        }
+        ns->path = std::move(path);
+        m_namespaces.push_back(std::move(ns));
+    }
+    const auto poolThreads = threads > 0 ? threads : std::max<std::size_t>(1U, std::thread::hardware_concurrency());
+    m_pool = std::make_unique<util::WorkStealingPool>(poolThreads, "monkas-netns");
+    spdlog::debug("Monitoring {} network namespaces on {} threads", m_namespaces.size(), poolThreads);
+}
+
+NamespaceMonitorPool::~NamespaceMonitorPool()
+{
+    m_pool.reset();
+    for (const auto& ns : m_namespaces) {
+        if (ns->fd >= 0) {
+            close(ns->fd);
+        }
+    }
+    close(m_wakeupFd);
+    close(m_epollFd);
+    close(m_ownNamespaceFd);
+}
+
+/**
+ * @brief Runs a task per namespace on the pool and waits for all of them.
+ *
+ * Subscribers may already be told about interfaces while other namespaces are still being enumerated.
+ */
+auto NamespaceMonitorPool::enumerateInterfaces() -> Interfaces
+{
+    if (!m_enumerated) {
+        m_enumerated = true;
+        const auto start = std::chrono::steady_clock::now();
+        std::latch done {static_cast<std::ptrdiff_t>(m_namespaces.size())};
+        for (const auto& ns : m_namespaces) {
+            m_pool->submit(
+                [this, &ns = *ns, &done]
+                {
+                    openMonitor(ns);
+                    done.count_down();
+                });
+        }
+        done.wait();
+        const auto duration =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        m_startupDuration = duration;
+        spdlog::debug("Enumerated {} network namespaces in {}ms", m_namespaces.size(), duration.count());
+    }
+    Interfaces intfs;
+    for (const auto& ns : m_namespaces) {
+        intfs.insert(ns->interfaces.begin(), ns->interfaces.end());
+    }
+    return intfs;
+}
+
+/**
+ * @brief Opens the monitor of a namespace on a thread of the pool and subscribes to all of its interfaces.
+ *
+ * setns() only moves the calling thread, which returns to the namespace of the pool once the sockets are open, so
+ * subscribers are always called in the namespace the pool was created in.
+ */
+void NamespaceMonitorPool::openMonitor(Namespace& ns)
+{
+    if (ns.fd < 0) {
+        return;
+    }
+    if (setns(ns.fd, CLONE_NEWNET) < 0) {
+        spdlog::warn("Cannot enter network namespace {}: {}", ns.path, strerror(errno));
+        return;
+    }
+    // the dumps of RuntimeFlag::ParallelEnumeration open sockets of their own
+    ns.monitor = std::make_unique<NetworkMonitor>(m_options, m_tunables);
+    const auto interfaces = ns.monitor->enumerateInterfaces();
+    if (setns(m_ownNamespaceFd, CLONE_NEWNET) < 0) {
+        pfatal("setns");
+    }
+    for (const auto& intf : interfaces) {
+        ns.interfaces.emplace(intf.index(), intf.name(), ns.id);
+    }
+    ns.forwarder = std::make_shared<Forwarder>(*this, ns);
+    // the empty pattern matches every interface, the present ones and the ones added later
+    ns.monitor->subscribeMatching({InterfacePattern {}}, ns.forwarder);
+    updateStatistics(ns);
+}
+
+void NamespaceMonitorPool::subscribe(const SubscriberPtr& subscriber)
+{
+    const std::scoped_lock lock {m_streamMutex};
+    if (std::ranges::find(m_subscribers, subscriber) == m_subscribers.end()) {
+        m_subscribers.push_back(subscriber);
+    }
+}
+
+void NamespaceMonitorPool::unsubscribe(const SubscriberPtr& subscriber)
+{
+    const std::scoped_lock lock {m_streamMutex};
+    std::erase(m_subscribers, subscriber);
+}
+
+/**
+ * @brief Waits for monitors with pending notifications and processes each of them as a task on the pool.
+ *
+ * The monitors are watched one shot, so a monitor is only watched again once its task is done and never processed by
+ * two threads at once.
+ */
+void NamespaceMonitorPool::run()
+{
+    enumerateInterfaces();
+    for (const auto& ns : m_namespaces) {
+        if (ns->monitor) {
+            watch(*ns, EPOLL_CTL_ADD);
+        }
+    }
+    std::array<epoll_event, EVENTS_PER_WAIT> events {};
+    while (!m_stopRequested.load()) {
+        const auto ready = epoll_wait(m_epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0 && errno != EINTR) {
+            pfatal("epoll_wait");
+        }
+        for (int i = 0; i < ready && !m_stopRequested.load(); ++i) {
+            if (events[static_cast<std::size_t>(i)].data.u64 == WAKEUP_EVENT) {
+                continue;
+            }
+            auto& ns = *m_namespaces[events[static_cast<std::size_t>(i)].data.u64];
+            m_inFlight.fetch_add(1);
+            m_pool->submit([this, &ns] { process(ns); });
+        }
+    }
+    for (auto inFlight = m_inFlight.load(); inFlight != 0; inFlight = m_inFlight.load()) {
+        m_inFlight.wait(inFlight);
+    }
+    for (const auto& ns : m_namespaces) {
+        if (ns->monitor) {
+            watch(*ns, EPOLL_CTL_DEL);
+        }
+    }
+}
+
+void NamespaceMonitorPool::process(Namespace& ns)
+{
+    std::ignore = ns.monitor->processPending(DATAGRAMS_PER_TASK);
+    updateStatistics(ns);
+    if (!m_stopRequested.load()) {
+        watch(ns, EPOLL_CTL_MOD);
+    }
+    if (m_inFlight.fetch_sub(1) == 1) {
+        m_inFlight.notify_all();
+    }
+}
+
+void NamespaceMonitorPool::watch(const Namespace& ns, const int operation) const
+{
+    epoll_event event {.events = EPOLLIN | EPOLLONESHOT, .data = {.u64 = static_cast<uint64_t>(ns.id)}};
+    if (epoll_ctl(m_epollFd, operation, ns.monitor->fileDescriptor(), &event) < 0) {
+        pfatal("epoll_ctl");
+    }
+}
+
+void NamespaceMonitorPool::stop()
+{
+    m_stopRequested = true;
+    const uint64_t wakeup = 1;
+    if (write(m_wakeupFd, &wakeup, sizeof(wakeup)) < 0 && errno != EAGAIN) {
+        pfatal("write(eventfd)");
+    }
+}
+
+auto NamespaceMonitorPool::namespacePath(const int32_t namespaceId) const -> const std::string&
+{
+    return m_namespaces.at(static_cast<std::size_t>(namespaceId))->path;
+}
+
+void NamespaceMonitorPool::updateStatistics(Namespace& ns)
+{
+    const std::scoped_lock lock {ns.statisticsMutex};
+    ns.statistics = ns.monitor->statistics();
+    ns.opened = true;
+}
+
+auto NamespaceMonitorPool::statistics() const -> Statistics
+{
+    Statistics stats;
+    stats.namespaces = m_namespaces.size();
+    stats.startupDuration = m_startupDuration.load();
+    stats.tasksRun = m_pool->tasksRun();
+    stats.tasksStolen = m_pool->tasksStolen();
+    bool first = true;
+    for (const auto& ns : m_namespaces) {
+        const std::scoped_lock lock {ns->statisticsMutex};
+        if (!ns->opened) {
+            stats.unavailableNamespaces++;
+        } else if (first) {
+            // keeps the start time of the monitors instead of the epoch
+            stats.monitors = ns->statistics;
+            first = false;
+        } else {
+            stats.monitors += ns->statistics;
+        }
+    }
+    return stats;
+}
+
+}  // namespace monkas::monitor
@@ -8,6 +8,7 @@
 
 #include <ip/Address.hpp>
 #include <monitor/NetworkInterfaceStatusTracker.hpp>
+#include <net/if_arp.h>
 #include <network/Address.hpp>
 #include <spdlog/spdlog.h>
 
@@ -35,6 +36,7 @@ auto NetworkInterfaceStatusTracker::hasName() const -> bool
 
 void NetworkInterfaceStatusTracker::touch(const ChangedFlag flag)
 {
+    markDirty();
     if (!m_changedFlags.test(flag)) {
         m_lastChanged = std::chrono::steady_clock::now();
         m_changedFlags.set(flag);
@@ -183,6 +185,42 @@ auto NetworkInterfaceStatusTracker::linkFlags() const -> const LinkFlags&
     return m_linkFlags;
 }
 
+auto NetworkInterfaceStatusTracker::linkType() const -> uint16_t
+{
+    return m_linkType;
+}
+
+void NetworkInterfaceStatusTracker::setLinkType(const uint16_t linkType)
+{
+    m_linkType = linkType;
+}
+
+auto NetworkInterfaceStatusTracker::isIeee802() const -> bool
+{
+    static_assert(ARPHRD_NONE_TYPE == ARPHRD_NONE);
+    return m_linkType == ARPHRD_ETHER || m_linkType == ARPHRD_IEEE80211;
+}
+
+auto NetworkInterfaceStatusTracker::linkKind() const -> const std::string&
+{
+    return m_linkKind;
+}
+
+void NetworkInterfaceStatusTracker::setLinkKind(const std::string& linkKind)
+{
+    m_linkKind = linkKind;
+}
+
+auto NetworkInterfaceStatusTracker::isMatched() const -> bool
+{
+    return m_matched;
+}
+
+void NetworkInterfaceStatusTracker::setMatched()
+{
+    m_matched = true;
+}
+
 auto NetworkInterfaceStatusTracker::age() const -> Duration
 {
     return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_lastChanged);
@@ -220,9 +258,25 @@ void NetworkInterfaceStatusTracker::clearChangedFlags()
 {
     m_nerdstats.changedFlagClears += m_changedFlags.count();
     m_changedFlags.reset();
+    m_listed = false;
     logTrace("all change flags", this, "cleared");
 }
 
+void NetworkInterfaceStatusTracker::setDirtyList(DirtyList* list, const std::pair<int32_t, uint32_t> key)
+{
+    m_dirtyList = list;
+    m_dirtyKey = key;
+    m_listed = false;
+}
+
+void NetworkInterfaceStatusTracker::markDirty()
+{
+    if (m_dirtyList != nullptr && !m_listed) {
+        m_dirtyList->push_back(m_dirtyKey);
+        m_listed = true;
+    }
+}
+
 void NetworkInterfaceStatusTracker::logNerdstats() const
 {
     spdlog::info("{:-^38}", m_name);
@@ -286,6 +340,12 @@ auto operator<<(std::ostream& o, const GatewayClearReason r) -> std::ostream&
         case AllIPv4AddressesRemoved:
             o << "AllIPv4AddressesRemoved";
             break;
+        case MissingAfterResync:
+            o << "MissingAfterResync";
+            break;
+        case Unfollowed:
+            o << "Unfollowed";
+            break;
     }
     return o;
 }
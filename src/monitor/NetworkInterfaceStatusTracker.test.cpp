@@ -5,6 +5,7 @@
 #include <ethernet/Address.hpp>
 #include <ip/Address.hpp>
 #include <monitor/NetworkInterfaceStatusTracker.hpp>
+#include <net/if_arp.h>
 
 namespace
 {
@@ -40,6 +41,21 @@ TEST_SUITE("[monitor::NetworkInterfaceStatusTracker]")
         CHECK(tracker.isChanged(ChangedFlag::OperationalState));
     }
 
+    TEST_CASE("NetworkInterfaceStatusTracker link type")
+    {
+        NetworkInterfaceStatusTracker link;
+        CHECK_FALSE(link.isIeee802());
+        link.setLinkType(ARPHRD_ETHER);
+        CHECK(link.linkType() == ARPHRD_ETHER);
+        CHECK(link.isIeee802());
+        link.setLinkType(ARPHRD_LOOPBACK);
+        CHECK_FALSE(link.isIeee802());
+        CHECK(link.linkKind().empty());
+        link.setLinkKind("veth");
+        CHECK(link.linkKind() == "veth");
+        CHECK_FALSE(link.hasChanges());
+    }
+
     TEST_CASE("NetworkInterfaceStatusTracker MAC address")
     {
         ethernet::Address addr;
@@ -64,6 +80,28 @@ TEST_SUITE("[monitor::NetworkInterfaceStatusTracker]")
         CHECK_FALSE(tracker.isChanged(ChangedFlag::Name));
     }
 
+    TEST_CASE("NetworkInterfaceStatusTracker dirty list")
+    {
+        NetworkInterfaceStatusTracker::DirtyList dirty;
+        NetworkInterfaceStatusTracker listed;
+        listed.setDirtyList(&dirty, {-1, 7});
+        CHECK(dirty.empty());
+        listed.setName("eth0");
+        listed.setOperationalState(OperationalState::Up);
+        REQUIRE(dirty.size() == 1);
+        CHECK(dirty.front() == std::pair<int32_t, uint32_t> {-1, 7});
+        listed.setName("eth0");
+        CHECK(dirty.size() == 1);
+        listed.clearChangedFlags();
+        listed.setName("eth1");
+        CHECK(dirty.size() == 2);
+        listed.clearChangedFlags();
+        listed.markDirty();
+        listed.markDirty();
+        CHECK(dirty.size() == 3);
+        CHECK_FALSE(listed.hasChanges());
+    }
+
     TEST_CASE("NetworkInterfaceStatusTracker age")
     {
         tracker.setName("eth0");
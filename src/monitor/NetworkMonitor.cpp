@@ -1,22 +1,41 @@
 // Copyright 2023-2025 hrzlgnm
 // SPDX-License-Identifier: MIT-0
 
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <string_view>
 #include <thread>
+#include <utility>
 
+#include <fmt/chrono.h>
 #include <fmt/std.h>
 #include <ip/Address.hpp>
 #include <libmnl/libmnl.h>
 #include <linux/if.h>
 #include <linux/if_link.h>
+#include <linux/net_namespace.h>
 #include <linux/rtnetlink.h>
 #include <memory.h>
 #include <monitor/Attributes.hpp>
+#include <monitor/InterfaceMatcher.hpp>
 #include <monitor/NetworkMonitor.hpp>
+#include <monitor/ReceiveThread.hpp>
+#include <monitor/SocketFilter.hpp>
+#include <monitor/UringReceiver.hpp>
 #include <net/if_arp.h>
 #include <spdlog/common.h>
 #include <spdlog/spdlog.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <util/ForkJoinPool.hpp>
 
 #include "network/Address.hpp"
 #include "network/Interface.hpp"
@@ -43,10 +62,10 @@ auto toRtnlGroupFlag(const rtnetlink_groups group) -> unsigned
 auto shouldRetryDump(const int err) -> bool
 {
     switch (err) {
-        case EPROTO:
         case EINTR:
         case EAGAIN:
         case EBUSY:
+        case ENOBUFS:  // dump request sent while the receive queue was full
             return true;
         default:
             break;
@@ -56,6 +75,14 @@ auto shouldRetryDump(const int err) -> bool
 
 constexpr auto RECEIVE_SOCKET_BUFFER_SIZE = 32U * 1024U;
 constexpr auto SEND_SOCKET_BUFFER_SIZE = 4U * 1024U;
+constexpr auto RECEIVE_BATCH_SIZE = 16U;
+// room for the nsid the kernel attaches with NETLINK_LISTEN_ALL_NSID
+constexpr size_t NSID_CONTROL_SIZE = CMSG_SPACE(sizeof(int32_t));
+constexpr auto ANY_PORTID = 0U;
+// bounds how long run() takes to notice stop() from another thread while datagrams keep coming
+constexpr auto DATAGRAMS_PER_WAKEUP = 64U;
+constexpr auto MEDIAN = 0.5;
+constexpr auto P99 = 0.99;
 
 using namespace std::chrono_literals;
 constexpr auto DUMP_RETRY_DELAY = 10ms;
@@ -68,16 +95,392 @@ auto ensureMnlSocket(const bool nonBlocking) -> mnl_socket*
     }
     return s;
 }
+
+/**
+ * @brief A dump running on its own short-lived socket during RuntimeFlag::ParallelEnumeration.
+ */
+struct ParallelDump
+{
+    explicit ParallelDump(const uint16_t type)
+        : msgType {type}
+    {
+    }
+
+    uint16_t msgType;
+    std::unique_ptr<mnl_socket, int (*)(mnl_socket*)> socket {nullptr, mnl_socket_close};
+    uint32_t portid {};
+    uint32_t seqNo {};
+    // dumps filtered by interface run one after the other on the same socket
+    std::vector<uint32_t> ifIndexes;
+    std::size_t nextIfIndex {};
+    // datagrams received before the link dump completed
+    std::vector<std::vector<uint8_t>> deferred;
+
+    [[nodiscard]] auto done() const -> bool { return socket == nullptr; }
+};
+
+auto toDumpRequestName(const uint16_t msgType) -> std::string_view
+{
+    switch (msgType) {
+        case RTM_GETLINK:
+            return "RTM_GETLINK";
+        case RTM_GETADDR:
+            return "RTM_GETADDR";
+        case RTM_GETROUTE:
+            return "RTM_GETROUTE";
+        case RTM_GETNSID:
+            return "RTM_GETNSID";
+        default:
+            return "unknown dump request";
+    }
+}
+
+/**
+ * @brief Makes the kernel validate dump requests strictly and honour the filters in their headers (Linux 4.20+).
+ */
+auto enableStrictCheck(mnl_socket* socket) -> bool
+{
+    int enable = 1;
+    return mnl_socket_setsockopt(socket, NETLINK_GET_STRICT_CHK, &enable, sizeof(enable)) == 0;
+}
+
+void openDumpSocket(ParallelDump& dump, const bool strictCheck)
+{
+    dump.socket.reset(ensureMnlSocket(false));
+    if (mnl_socket_bind(dump.socket.get(), 0, MNL_SOCKET_AUTOPID) < 0) {
+        pfatal("mnl_socket_bind");
+    }
+    if (strictCheck && !enableStrictCheck(dump.socket.get())) {
+        pfatal("setsockopt(NETLINK_GET_STRICT_CHK)");
+    }
+    dump.portid = mnl_socket_get_portid(dump.socket.get());
+    dump.nextIfIndex = 0;
+    dump.deferred.clear();
+}
+
+auto onErrorMessage(const nlmsghdr* nlh, void* /*data*/) -> int
+{
+    const auto* err = static_cast<const nlmsgerr*>(mnl_nlmsg_get_payload(nlh));
+    if (nlh->nlmsg_len < mnl_nlmsg_size(sizeof(nlmsgerr))) {
+        errno = EBADMSG;
+        return MNL_CB_ERROR;
+    }
+    errno = err->error < 0 ? -err->error : err->error;
+    return err->error == 0 ? MNL_CB_STOP : MNL_CB_ERROR;
+}
+
+/**
+ * @brief Unlike libmnl's default, reports the error code a dump may end with, e.g. a rejected filter.
+ */
+auto onDoneMessage(const nlmsghdr* nlh, void* /*data*/) -> int
+{
+    if (nlh->nlmsg_len >= mnl_nlmsg_size(sizeof(int))) {
+        if (const auto err = *static_cast<const int*>(mnl_nlmsg_get_payload(nlh)); err < 0) {
+            errno = -err;
+            return MNL_CB_ERROR;
+        }
+    }
+    return MNL_CB_STOP;
+}
+
+constexpr std::array<mnl_cb_t, NLMSG_DONE + 1> CONTROL_CALLBACKS {
+    nullptr, nullptr, &onErrorMessage, &onDoneMessage};
+
+// with NETLINK_LISTEN_ALL_NSID the kernel attaches the nsid to datagrams of other namespaces only
+auto namespaceOf(msghdr msg) -> int32_t
+{
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_NETLINK && cmsg->cmsg_type == NETLINK_LISTEN_ALL_NSID
+            && cmsg->cmsg_len == CMSG_LEN(sizeof(int32_t)))
+        {
+            int32_t nsid = network::Interface::OWN_NAMESPACE;
+            std::memcpy(&nsid, CMSG_DATA(cmsg), sizeof(nsid));
+            return nsid;
+        }
+    }
+    return network::Interface::OWN_NAMESPACE;
+}
+
+// like mnl_socket_recvfrom(), which does not take flags, optionally telling the namespace the datagram came from
+auto receiveFrom(mnl_socket* socket, std::vector<uint8_t>& buffer, const int flags, int32_t* nsid = nullptr)
+    -> ssize_t
+{
+    sockaddr_nl address {};
+    iovec iov {.iov_base = buffer.data(), .iov_len = buffer.size()};
+    std::array<uint8_t, NSID_CONTROL_SIZE> control {};
+    msghdr msg {};
+    msg.msg_name = &address;
+    msg.msg_namelen = sizeof(address);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (nsid != nullptr) {
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+    }
+    const auto received = recvmsg(mnl_socket_get_fd(socket), &msg, flags);
+    if (received < 0) {
+        return received;
+    }
+    if (nsid != nullptr) {
+        *nsid = namespaceOf(msg);
+    }
+    if ((msg.msg_flags & MSG_TRUNC) != 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    if (msg.msg_namelen != sizeof(address)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return received;
+}
+
+// marks the calling thread as the one running the monitor for the lifetime of the scope
+class LoopThreadScope
+{
+  public:
+    explicit LoopThreadScope(std::atomic<std::thread::id>& loopThread)
+        : m_loopThread {loopThread}
+        , m_previous {loopThread.exchange(std::this_thread::get_id())}
+    {
+    }
+
+    ~LoopThreadScope() { m_loopThread.store(m_previous); }
+
+    LoopThreadScope(const LoopThreadScope&) = delete;
+    LoopThreadScope(LoopThreadScope&&) = delete;
+    auto operator=(const LoopThreadScope&) -> LoopThreadScope& = delete;
+    auto operator=(LoopThreadScope&&) -> LoopThreadScope& = delete;
+
+  private:
+    std::atomic<std::thread::id>& m_loopThread;
+    std::thread::id m_previous;
+};
+
+// the interface an address or an IPv4 route message is about, 0 for other messages and routes without one
+auto interfaceOf(const nlmsghdr* n) -> uint32_t
+{
+    switch (n->nlmsg_type) {
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+            return static_cast<const ifaddrmsg*>(mnl_nlmsg_get_payload(n))->ifa_index;
+        case RTM_NEWROUTE:
+        case RTM_DELROUTE:
+            if (static_cast<const rtmsg*>(mnl_nlmsg_get_payload(n))->rtm_family != AF_INET) {
+                return 0;
+            }
+            return Attributes::findU32(n, sizeof(rtmsg), RTA_OIF).value_or(0);
+        default:
+            return 0;
+    }
+}
+
+// an interface is identified by its nsid and index, which fit into one key for hashing
+auto interfaceKey(const network::Interface& intf) -> uint64_t
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(intf.namespaceId())) << 32U) | intf.index();
+}
 }  // namespace
 
-NetworkMonitor::NetworkMonitor(const RuntimeFlags& options)
+// defers erasing the subscriptions of subscribers that leave until no subscriber is being called any longer
+class NetworkMonitor::DispatchScope
+{
+  public:
+    explicit DispatchScope(NetworkMonitor& monitor)
+        : m_monitor {monitor}
+    {
+        ++m_monitor.m_dispatchDepth;
+    }
+
+    ~DispatchScope()
+    {
+        if (--m_monitor.m_dispatchDepth == 0 && !m_monitor.m_leftSubscribers.empty()) {
+            m_monitor.eraseLeftSubscriptions();
+        }
+    }
+
+    DispatchScope(const DispatchScope&) = delete;
+    DispatchScope(DispatchScope&&) = delete;
+    auto operator=(const DispatchScope&) -> DispatchScope& = delete;
+    auto operator=(DispatchScope&&) -> DispatchScope& = delete;
+
+  private:
+    NetworkMonitor& m_monitor;
+};
+
+NetworkMonitor::NetworkMonitor(const RuntimeFlags& options, const Tunables& tunables)
     : m_mnlSocket {ensureMnlSocket(options.test(RuntimeFlag::NonBlocking)), mnl_socket_close}
     , m_receiveBuffer(RECEIVE_SOCKET_BUFFER_SIZE)
+    , m_batchReceiveBuffer(options.test(RuntimeFlag::BatchedReceive) ? RECEIVE_BATCH_SIZE * RECEIVE_SOCKET_BUFFER_SIZE
+                                                                       : 0U)
     , m_sendBuffer(SEND_SOCKET_BUFFER_SIZE)
-    , m_portid {mnl_socket_get_portid(m_mnlSocket.get())}
+    , m_linkSocket {options.test(RuntimeFlag::PrioritizeLinkEvents) ? ensureMnlSocket(true) : nullptr, mnl_socket_close}
+    , m_linkReceiveBuffer(m_linkSocket ? RECEIVE_SOCKET_BUFFER_SIZE : 0U)
+    , m_filterAuditSocket {nullptr, mnl_socket_close}
     , m_runtimeOptions(options)
+    , m_receiveBufferPolicy(tunables.receiveBufferFloor, tunables.receiveBufferCeiling)
+    , m_maxFilteredDumpInterfaces(tunables.maxFilteredDumpInterfaces)
+    , m_matcher {std::make_unique<InterfaceMatcher>()}
+    , m_snapshots {options.test(RuntimeFlag::PublishSnapshots)
+                       ? std::make_shared<InterfaceSnapshots>(tunables.snapshotCapacity)
+                       : nullptr}
 {
     m_stats.startTime = std::chrono::steady_clock::now();
+    // starts out signalled, so an event loop polling fileDescriptor() calls processPending() to start the enumeration
+    m_wakeupFd = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeupFd < 0) {
+        pfatal("eventfd");
+    }
+    const auto groups = multicastGroups();
+    const auto linkGroup = toRtnlGroupFlag(RTNLGRP_LINK);
+    spdlog::debug("Joining RTnetlink multicast groups {}", m_linkSocket ? groups & ~linkGroup : groups);
+    if (mnl_socket_bind(m_mnlSocket.get(), m_linkSocket ? groups & ~linkGroup : groups, MNL_SOCKET_AUTOPID) < 0) {
+        pfatal("mnl_socket_bind");
+    }
+    if (m_linkSocket) {
+        spdlog::debug("Joining RTnetlink multicast group {} on a separate socket", linkGroup);
+        if (mnl_socket_bind(m_linkSocket.get(), linkGroup, MNL_SOCKET_AUTOPID) < 0) {
+            pfatal("mnl_socket_bind");
+        }
+    }
+    // the port id is only assigned by binding the socket
+    m_portid = mnl_socket_get_portid(m_mnlSocket.get());
+    m_strictCheck = enableStrictCheck(m_mnlSocket.get());
+    if (!m_strictCheck) {
+        spdlog::info("Kernel does not support strict checking of dump requests, dumps are not filtered");
+    }
+    if (tunables.receiveSocketBufferSize > 0) {
+        setReceiveSocketBufferSize(m_mnlSocket.get(), tunables.receiveSocketBufferSize);
+        if (m_linkSocket) {
+            setReceiveSocketBufferSize(m_linkSocket.get(), tunables.receiveSocketBufferSize);
+        }
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces)) {
+        enableListenAllNamespaces();
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::PipelinedReceive)) {
+        auto receive = [socket = m_mnlSocket.get()](std::vector<uint8_t>& buffer, int32_t& nsid)
+        { return receiveFrom(socket, buffer, MSG_DONTWAIT, &nsid); };
+        m_receiveThread = ReceiveThread::create(mnl_socket_get_fd(m_mnlSocket.get()),
+                                                tunables.receiveRingDepth,
+                                                RECEIVE_SOCKET_BUFFER_SIZE,
+                                                std::move(receive));
+        if (!m_receiveThread) {
+            spdlog::warn("Falling back to receiving on the thread running the monitor");
+        }
+    } else if (m_runtimeOptions.test(RuntimeFlag::IoUringReceive)) {
+        m_uringReceiver = UringReceiver::create(mnl_socket_get_fd(m_mnlSocket.get()), RECEIVE_SOCKET_BUFFER_SIZE);
+        if (!m_uringReceiver) {
+            spdlog::warn("Falling back to receiving with recvmsg");
+        }
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::ShardedProcessing)) {
+        const auto shards = tunables.processingShards > 0
+            ? tunables.processingShards
+            : std::max<std::size_t>(1U, std::thread::hardware_concurrency());
+        m_shardPool = std::make_unique<util::ForkJoinPool>(shards, "monkas-shard");
+        m_shards.resize(shards);
+        spdlog::debug("Applying batches of messages across {} shards", shards);
+        if (!m_runtimeOptions.test(RuntimeFlag::BatchedReceive)) {
+            spdlog::warn("RuntimeFlag::ShardedProcessing only shards the batches of RuntimeFlag::BatchedReceive");
+        }
+    }
+    if (m_linkSocket && m_runtimeOptions.test(RuntimeFlag::BatchedReceive)) {
+        spdlog::warn("RuntimeFlag::PrioritizeLinkEvents receives one datagram at a time, RuntimeFlag::BatchedReceive "
+                     "and RuntimeFlag::ShardedProcessing only apply to enumerations");
+    }
+    setupEventPolling();
+    if (m_runtimeOptions.test(RuntimeFlag::FilterEventsInKernel)) {
+        attachSocketFilter();
+        if (m_runtimeOptions.test(RuntimeFlag::StatsForNerds)) {
+            m_filterAuditSocket = {ensureMnlSocket(true), mnl_socket_close};
+            if (mnl_socket_bind(m_filterAuditSocket.get(), groups, MNL_SOCKET_AUTOPID) < 0) {
+                pfatal("mnl_socket_bind");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Receives the notifications of all namespaces with an nsid, falling back to the own namespace only.
+ *
+ * The receive modes that do not see the control messages of a datagram would mix up the interfaces of all namespaces,
+ * so they are turned off.
+ */
+void NetworkMonitor::enableListenAllNamespaces()
+{
+    int enable = 1;
+    for (auto* socket : {m_mnlSocket.get(), m_linkSocket.get()}) {
+        if (socket != nullptr
+            && mnl_socket_setsockopt(socket, NETLINK_LISTEN_ALL_NSID, &enable, sizeof(enable)) < 0)
+        {
+            spdlog::warn("Failed to listen to all network namespaces: {}", strerror(errno));
+            m_runtimeOptions.reset(RuntimeFlag::ListenAllNamespaces);
+            return;
+        }
+    }
+    constexpr std::array<std::pair<RuntimeFlag, std::string_view>, 2> blind {{
+        {RuntimeFlag::IoUringReceive, "IoUringReceive"},
+        {RuntimeFlag::FilterEventsInKernel, "FilterEventsInKernel"},
+    }};
+    for (const auto& [flag, name] : blind) {
+        if (m_runtimeOptions.test(flag)) {
+            spdlog::warn("RuntimeFlag::{} cannot tell network namespaces apart, ignoring it", name);
+            m_runtimeOptions.reset(flag);
+        }
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::ParallelEnumeration)) {
+        spdlog::warn("RuntimeFlag::ParallelEnumeration does not dump other network namespaces, ignoring it");
+        m_runtimeOptions.reset(RuntimeFlag::ParallelEnumeration);
+    }
+    if (!m_strictCheck) {
+        spdlog::warn("Without strict checking interfaces of other network namespaces are only learned from their "
+                     "notifications");
+    }
+    spdlog::debug("Listening to the change notifications of all network namespaces");
+}
+
+NetworkMonitor::~NetworkMonitor()
+{
+    close(m_epollFd);
+    close(m_wakeupFd);
+}
+
+/**
+ * @brief Sets up the epoll instance behind fileDescriptor(), which waits for the sockets and the wakeup of stop().
+ *
+ * The link socket is only watched while its notifications are processed, i.e. outside of enumerations.
+ */
+void NetworkMonitor::setupEventPolling()
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+        pfatal("epoll_create1");
+    }
+    const auto add = [this](const int fd, const uint32_t events)
+    {
+        epoll_event event {};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            pfatal("epoll_ctl");
+        }
+    };
+    add(m_wakeupFd, EPOLLIN);
+    if (m_uringReceiver) {
+        add(m_uringReceiver->fileDescriptor(), EPOLLIN);
+    } else if (m_receiveThread) {
+        add(m_receiveThread->fileDescriptor(), EPOLLIN);
+    } else {
+        add(mnl_socket_get_fd(m_mnlSocket.get()), EPOLLIN);
+    }
+    if (m_linkSocket) {
+        add(mnl_socket_get_fd(m_linkSocket.get()), 0U);
+    }
+}
+
+auto NetworkMonitor::multicastGroups() const -> unsigned
+{
     unsigned groups = toRtnlGroupFlag(RTNLGRP_LINK);
     groups |= toRtnlGroupFlag(RTNLGRP_NOTIFY);
     if (!m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6)) {
@@ -88,34 +491,294 @@ NetworkMonitor::NetworkMonitor(const RuntimeFlags& options)
         groups |= toRtnlGroupFlag(RTNLGRP_IPV6_IFADDR);
         groups |= toRtnlGroupFlag(RTNLGRP_IPV6_ROUTE);
     }
-    spdlog::debug("Joining RTnetlink multicast groups {}", groups);
-    if (mnl_socket_bind(m_mnlSocket.get(), groups, MNL_SOCKET_AUTOPID) < 0) {
-        pfatal("mnl_socket_bind");
+    return groups;
+}
+
+/**
+ * @brief Attaches a socket filter dropping the change notifications parsing would discard anyway.
+ *
+ * Address notifications of interfaces without subscription are only dropped with
+ * RuntimeFlag::DumpSubscribedInterfacesOnly, which does not keep track of their addresses in the first place.
+ */
+void NetworkMonitor::attachSocketFilter()
+{
+    SocketFilter::Options options;
+    options.portid = m_portid;
+    options.includeNonIeee802 = m_runtimeOptions.test(RuntimeFlag::IncludeNonIeee802);
+    if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV4)) {
+        options.addressFamily = AF_INET;
+    } else if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6)) {
+        options.addressFamily = AF_INET6;
+    }
+    options.routes = !m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6);
+    options.defaultRoutesOnly = m_runtimeOptions.test(RuntimeFlag::DefaultRoutesOnly);
+    options.ifIndexes = m_interest;
+    const SocketFilter filter {options};
+    if (!filter.attachTo(mnl_socket_get_fd(m_mnlSocket.get()))
+        || (m_linkSocket && !filter.attachTo(mnl_socket_get_fd(m_linkSocket.get()))))
+    {
+        pfatal("setsockopt(SO_ATTACH_FILTER)");
+    }
+    m_stats.socketFilterUpdates++;
+    spdlog::debug("Attached socket filter of {} instructions for {} interfaces",
+                  filter.instructions().size(),
+                  m_interest.size());
+}
+
+/**
+ * @brief Follows the interfaces of all subscriptions with the socket filter and the dumps.
+ *
+ * Interfaces that gained a subscription were neither dumped nor followed so far with
+ * RuntimeFlag::DumpSubscribedInterfacesOnly, so a resync fetches their addresses and gateways.
+ */
+void NetworkMonitor::updateInterest()
+{
+    if (!m_mnlSocket) {
+        return;
+    }
+    auto interest = dumpFilter(false);
+    if (interest == m_interest) {
+        return;
+    }
+    const auto grew = !m_interest.empty() && (interest.empty() || !std::ranges::includes(m_interest, interest));
+    m_interest = std::move(interest);
+    if (m_runtimeOptions.test(RuntimeFlag::FilterEventsInKernel)) {
+        attachSocketFilter();
+    }
+    if (!grew) {
+        return;
+    }
+    // the link dump of an ongoing enumeration picks up the current subscriptions when it completes
+    if (!isEnumerating()) {
+        requestResync();
+    } else if (!isEnumeratingLinks()) {
+        m_resyncPending = true;
+    }
+}
+
+/**
+ * @brief Joins the address and route groups while anybody is interested in addresses or gateways and leaves them
+ * otherwise.
+ *
+ * Without subscribers everything is followed, which keeps the cache fresh for enumerateInterfaces(). State that is no
+ * longer followed is forgotten, as it would go stale, and dumped again once it is followed again.
+ *
+ * @return true if state followed again is going to be dumped again.
+ */
+auto NetworkMonitor::updateMemberships() -> bool
+{
+    if (!m_mnlSocket) {
+        return false;
+    }
+    // snapshots carry the addresses and the gateway of every interface
+    const auto everything = m_subscribers.empty() || m_snapshots != nullptr;
+    auto addresses = everything || m_awaitedInterest.test(ChangedFlag::NetworkAddresses);
+    auto gateways = everything || m_awaitedInterest.test(ChangedFlag::GatewayAddress);
+    for (const auto& [subscriber, subscription] : m_subscribers) {
+        addresses = addresses || subscription.interest.test(ChangedFlag::NetworkAddresses);
+        gateways = gateways || subscription.interest.test(ChangedFlag::GatewayAddress);
+    }
+    const auto rejoinedAddresses = addresses && !m_addressGroupsJoined;
+    const auto rejoinedRoutes = gateways && !m_routeGroupsJoined;
+    forgetUnfollowed(!addresses && m_addressGroupsJoined, !gateways && m_routeGroupsJoined);
+    if (addresses != m_addressGroupsJoined) {
+        if (!m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6)) {
+            setMembership(RTNLGRP_IPV4_IFADDR, addresses);
+        }
+        if (!m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV4)) {
+            setMembership(RTNLGRP_IPV6_IFADDR, addresses);
+        }
+        m_addressGroupsJoined = addresses;
+    }
+    if (gateways != m_routeGroupsJoined) {
+        if (!m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6)) {
+            setMembership(RTNLGRP_IPV4_ROUTE, gateways);
+        }
+        if (!m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV4)) {
+            setMembership(RTNLGRP_IPV6_ROUTE, gateways);
+        }
+        m_routeGroupsJoined = gateways;
+    }
+    const auto redumpRoutes = rejoinedRoutes && isFollowed(CacheState::EnumeratingRoutes);
+    if (!rejoinedAddresses && !redumpRoutes) {
+        return false;
+    }
+    // an ongoing enumeration dumps the steps it did not reach yet anyway
+    if (!isEnumerating()) {
+        requestResync(rejoinedAddresses ? CacheState::EnumeratingAddresses : CacheState::EnumeratingRoutes,
+                      redumpRoutes ? CacheState::EnumeratingRoutes : CacheState::EnumeratingAddresses);
+    } else if (!isEnumeratingLinks()) {
+        m_resyncPending = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Clears the addresses or gateways of all interfaces, which nobody is told as nobody is interested in them.
+ */
+void NetworkMonitor::forgetUnfollowed(const bool addresses, const bool gateways)
+{
+    const auto forget = [addresses, gateways](NetworkInterfaceStatusTracker& tracker) {
+        if (addresses) {
+            for (const auto& address : Addresses {tracker.networkAddresses()}) {
+                tracker.removeNetworkAddress(address);
+            }
+        }
+        if (gateways) {
+            tracker.clearGatewayAddress(GatewayClearReason::Unfollowed);
+        }
+    };
+    if (!addresses && !gateways) {
+        return;
+    }
+    for (auto& [index, tracker] : m_trackers) {
+        forget(tracker);
+    }
+    for (auto& [key, tracker] : m_peerTrackers) {
+        forget(tracker);
+    }
+}
+
+/**
+ * @brief Joins or leaves a multicast group on the main socket and on the socket auditing the socket filter.
+ */
+void NetworkMonitor::setMembership(const unsigned group, const bool join)
+{
+    spdlog::debug("{} RTnetlink multicast group {}", join ? "Joining" : "Leaving", group);
+    for (auto* socket : {m_mnlSocket.get(), m_filterAuditSocket.get()}) {
+        auto value = group;
+        if (socket != nullptr
+            && mnl_socket_setsockopt(
+                   socket, join ? NETLINK_ADD_MEMBERSHIP : NETLINK_DROP_MEMBERSHIP, &value, sizeof(value))
+                < 0)
+        {
+            pfatal(join ? "setsockopt(NETLINK_ADD_MEMBERSHIP)" : "setsockopt(NETLINK_DROP_MEMBERSHIP)");
+        }
+    }
+    m_stats.membershipChanges++;
+}
+
+void NetworkMonitor::setReceiveSocketBufferSize(mnl_socket* socket, int size)
+{
+    const auto fd = mnl_socket_get_fd(socket);
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+        spdlog::debug("SO_RCVBUFFORCE failed, falling back to SO_RCVBUF, which is limited by net.core.rmem_max");
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+            pfatal("setsockopt(SO_RCVBUF)");
+        }
+    }
+    socklen_t len = sizeof(size);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &len) == 0) {
+        spdlog::debug("Receive socket buffer size is {} bytes", size);
     }
 }
 
 auto NetworkMonitor::enumerateInterfaces() -> Interfaces
 {
-    if (m_cacheState == CacheState::WaitingForChanges) {
+    const LoopThreadScope scope {m_loopThread};
+    if (m_cacheState == CacheState::WaitingForChanges || handleStopRequest() || !m_mnlSocket) {
+        return interfacesFromCache();
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::ParallelEnumeration)) {
+        enumerateInParallel();
         return interfacesFromCache();
     }
-    spdlog::debug("Requesting RTM_GETLINK");
-    sendDumpRequest(RTM_GETLINK);
-    while (m_cacheState != CacheState::WaitingForChanges) {
-        receiveAndProcess();
+    startEnumeration();
+    while (m_cacheState != CacheState::WaitingForChanges && m_mnlSocket) {
+        waitForEvents();
+        std::ignore = receiveAndProcess(DATAGRAMS_PER_WAKEUP);
     }
     return interfacesFromCache();
 }
 
-void NetworkMonitor::subscribe(const Interfaces& interfaces, const SubscriberPtr& subscriber)
+void NetworkMonitor::subscribe(const Interfaces& interfaces,
+                               const SubscriberPtr& subscriber,
+                               const ChangedFlags& interest,
+                               const InterfaceEvents& events)
 {
+    if (subscriber == nullptr) {
+        spdlog::warn("Cannot subscribe null subscriber");
+        return;
+    }
     if (interfaces.empty()) {
         spdlog::warn("Cannot subscribe to empty interface list");
         return;
     }
-    m_subscribers[subscriber] = interfaces;
-    spdlog::debug("Subscribed {} to {} interfaces", static_cast<void*>(subscriber.get()), interfaces.size());
-    notifyChanges(subscriber.get(), interfaces);
+    addSubscription(interfaces, {}, subscriber, interest, events);
+}
+
+void NetworkMonitor::subscribeMatching(const std::vector<InterfacePattern>& patterns,
+                                       const SubscriberPtr& subscriber,
+                                       const ChangedFlags& interest,
+                                       const InterfaceEvents& events)
+{
+    if (subscriber == nullptr || patterns.empty()) {
+        spdlog::warn("Cannot subscribe without a subscriber or patterns");
+        return;
+    }
+    InterfaceMatcher matcher;
+    for (const auto& pattern : patterns) {
+        matcher.add(pattern);
+    }
+    Interfaces interfaces;
+    const auto matchTracker = [&](const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker) {
+        if (!tracker.isMatched()) {
+            return;  // matched with the others once its link message is seen
+        }
+        m_patternMatches.clear();
+        matcher.match({.name = tracker.name(),
+                       .type = tracker.linkType(),
+                       .kind = tracker.linkKind(),
+                       .flags = tracker.linkFlags()},
+                      m_patternMatches);
+        if (!m_patternMatches.empty()) {
+            interfaces.insert(intf);
+        }
+    };
+    for (const auto& [index, tracker] : m_trackers) {
+        matchTracker(network::Interface {index, tracker.name()}, tracker);
+    }
+    for (const auto& [key, tracker] : m_peerTrackers) {
+        matchTracker(network::Interface {key.second, tracker.name(), key.first}, tracker);
+    }
+    addSubscription(interfaces, patterns, subscriber, interest, events);
+}
+
+void NetworkMonitor::addSubscription(const Interfaces& interfaces,
+                                     std::vector<InterfacePattern> patterns,
+                                     const SubscriberPtr& subscriber,
+                                     const ChangedFlags& interest,
+                                     const InterfaceEvents& events)
+{
+    auto& subscription = m_subscribers[subscriber];
+    unindexSubscription(subscription);
+    const auto recompile = !subscription.patterns.empty() || !patterns.empty();
+    subscription.subscriber = subscriber.get();
+    subscription.interfaces = interfaces;
+    subscription.interest = interest;
+    subscription.events = events;
+    subscription.batched = subscriber->wantsChangesBatch();
+    subscription.patterns = std::move(patterns);
+    indexSubscription(subscription);
+    if (recompile) {
+        compilePatterns();
+    }
+    spdlog::debug("Subscribed {} to {} of {} interfaces",
+                  static_cast<void*>(subscriber.get()),
+                  interest,
+                  interfaces.size());
+    updateInterest();
+    if (updateMemberships()
+        && (interest.test(ChangedFlag::NetworkAddresses) || interest.test(ChangedFlag::GatewayAddress)))
+    {
+        subscription.heldBack = true;
+    }
+    if (subscription.heldBack) {
+        // told once the addresses or routes were dumped again, the cache misses them until then
+        m_subscriptionsHeldBack = true;
+        return;
+    }
+    notifyChanges(subscriber.get(), interfaces, interest);
 }
 
 void NetworkMonitor::updateSubscription(const Interfaces& interfaces, const SubscriberPtr& subscriber)
@@ -124,16 +787,22 @@ void NetworkMonitor::updateSubscription(const Interfaces& interfaces, const Subs
         spdlog::warn("Cannot update subscription for null subscriber");
         return;
     }
-    if (interfaces.empty()) {
+    auto it = m_subscribers.find(subscriber);
+    if (it != m_subscribers.end() && it->second.subscriber == nullptr) {
+        it = m_subscribers.end();  // left while subscribers are being called
+    }
+    if (interfaces.empty() && (it == m_subscribers.end() || it->second.patterns.empty())) {
         unsubscribe(subscriber);
         return;
     }
-    auto it = m_subscribers.find(subscriber);
     if (it != m_subscribers.end()) {
-        it->second = interfaces;
+        unindexSubscription(it->second);
+        it->second.interfaces = interfaces;
+        indexSubscription(it->second);
         spdlog::debug(
             "Updated subscription for {} to {} interfaces", static_cast<void*>(subscriber.get()), interfaces.size());
-        notifyChanges(subscriber.get(), interfaces);
+        updateInterest();
+        notifyChanges(subscriber.get(), interfaces, it->second.interest);
     } else {
         spdlog::warn("Subscriber {} not found", static_cast<void*>(subscriber.get()));
     }
@@ -146,153 +815,1375 @@ void NetworkMonitor::unsubscribe(const SubscriberPtr& subscriber)
         return;
     }
     const auto it = m_subscribers.find(subscriber);
-    if (it != m_subscribers.end()) {
-        spdlog::debug("Unsubscribed {} from {} interfaces", static_cast<void*>(subscriber.get()), it->second.size());
-        m_subscribers.erase(it);
+    if (it != m_subscribers.end() && it->second.subscriber != nullptr) {
+        spdlog::debug(
+            "Unsubscribed {} from {} interfaces", static_cast<void*>(subscriber.get()), it->second.interfaces.size());
+        unindexSubscription(it->second);
+        const auto recompile = !it->second.patterns.empty();
+        if (m_dispatchDepth > 0) {
+            // subscribers being called hold on to the subscription, it is erased once they returned
+            it->second = Subscription {};
+            m_leftSubscribers.push_back(subscriber);
+        } else {
+            m_subscribers.erase(it);
+        }
+        if (recompile) {
+            compilePatterns();
+        }
+        updateInterest();
+        updateMemberships();
     } else {
         spdlog::warn("Subscriber {} not found", static_cast<void*>(subscriber.get()));
     }
 }
 
-/**
- * @brief Starts monitoring network interfaces and processes netlink messages until stopped.
- *
- * Initiates interface enumeration and then enters a loop to receive and process netlink messages, continuing until
- * monitoring is explicitly stopped.
- */
-void NetworkMonitor::run()
+void NetworkMonitor::indexSubscription(Subscription& subscription)
 {
-    // someone may call enumerateInterfaces() and stop() during enumerateInterfaces
-    if (!m_mnlSocket) {
-        return;
+    for (const auto& intf : subscription.interfaces) {
+        m_subscriptionsByInterface[interfaceKey(intf)].push_back(&subscription);
     }
-    m_running = true;
-    spdlog::trace("Starting NetworkMonitor");
-    enumerateInterfaces();
-    spdlog::trace("Starting to receive and process messages from mnl socket {} m_running={}",
-                  static_cast<void*>(m_mnlSocket.get()),
-                  m_running);
-    while (m_running) {
-        receiveAndProcess();
+    if (subscription.events.test(InterfaceEvent::Added)) {
+        m_addedSubscriptions.push_back(&subscription);
+    }
+    if (subscription.events.test(InterfaceEvent::Removed)) {
+        m_removedSubscriptions.push_back(&subscription);
+    }
+}
+
+void NetworkMonitor::compilePatterns()
+{
+    m_matcher->clear();
+    m_patternOwners.clear();
+    for (auto& [subscriber, subscription] : m_subscribers) {
+        for (const auto& pattern : subscription.patterns) {
+            m_matcher->add(pattern);
+            m_patternOwners.push_back(&subscription);
+        }
     }
+    spdlog::debug("Compiled {} interface patterns", m_matcher->size());
 }
 
 /**
- * @brief Stops the network monitoring process and releases resources.
+ * @brief Adds the interface to the subscriptions with a pattern it matches, and removes it from the others.
  *
- * Closes the netlink socket and marks the monitor as no longer running.
+ * @note: the ids of a subscription's patterns are consecutive
  */
-void NetworkMonitor::stop()
+void NetworkMonitor::matchPatterns(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker)
 {
-    spdlog::debug("Stopping NetworkMonitor");
-    m_mnlSocket.reset();
-    m_running = false;
-}
+    if (m_matcher->empty()) {
+        return;
+    }
+    m_patternMatches.clear();
+    m_matcher->match(
+        {.name = tracker.name(), .type = tracker.linkType(), .kind = tracker.linkKind(), .flags = tracker.linkFlags()},
+        m_patternMatches);
+    const Subscription* previous = nullptr;
+    for (auto* subscription : m_patternOwners) {
+        if (subscription == previous) {
+            continue;
+        }
+        previous = subscription;
+        const auto matched = std::ranges::any_of(
+            m_patternMatches, [this, subscription](const auto id) { return m_patternOwners[id] == subscription; });
+        if (matched && subscription->interfaces.insert(intf).second) {
+            m_subscriptionsByInterface[interfaceKey(intf)].push_back(subscription);
+            subscription->matched.insert(intf);
+            m_matchesChanged = true;
+            spdlog::debug("Matched {} into subscription of {}", intf, static_cast<void*>(subscription->subscriber));
+        } else if (!matched && subscription->interfaces.erase(intf) > 0) {
+            const auto it = m_subscriptionsByInterface.find(interfaceKey(intf));
+            std::erase(it->second, subscription);
+            if (it->second.empty()) {
+                m_subscriptionsByInterface.erase(it);
+            }
+            subscription->matched.erase(intf);
+            m_matchesChanged = true;
+            spdlog::debug("Matched {} out of subscription of {}", intf, static_cast<void*>(subscription->subscriber));
+        }
+    }
+}
+
+void NetworkMonitor::eraseLeftSubscriptions()
+{
+    auto erased = false;
+    for (const auto& subscriber : std::exchange(m_leftSubscribers, {})) {
+        // unless it subscribed again meanwhile
+        const auto it = m_subscribers.find(subscriber);
+        if (it != m_subscribers.end() && it->second.subscriber == nullptr) {
+            m_subscribers.erase(it);
+            erased = true;
+        }
+    }
+    if (erased) {
+        // nobody subscribed follows everything again
+        updateMemberships();
+    }
+}
+
+/**
+ * @brief Tells the subscriptions held back the current state of their interfaces, now that it was dumped again.
+ */
+void NetworkMonitor::releaseHeldBackSubscriptions()
+{
+    m_subscriptionsHeldBack = false;
+    std::vector<Subscription*> released;
+    for (auto& [subscriber, subscription] : m_subscribers) {
+        if (std::exchange(subscription.heldBack, false)) {
+            released.push_back(&subscription);
+        }
+    }
+    for (const auto* subscription : released) {
+        // unless it left while the ones before it were told
+        if (subscription->subscriber != nullptr) {
+            notifyChanges(subscription->subscriber, subscription->interfaces, subscription->interest);
+        }
+    }
+}
+
+void NetworkMonitor::unindexSubscription(Subscription& subscription)
+{
+    std::erase(m_addedSubscriptions, &subscription);
+    std::erase(m_removedSubscriptions, &subscription);
+    for (const auto& intf : subscription.interfaces) {
+        const auto it = m_subscriptionsByInterface.find(interfaceKey(intf));
+        if (it == m_subscriptionsByInterface.end()) {
+            continue;
+        }
+        std::erase(it->second, &subscription);
+        if (it->second.empty()) {
+            m_subscriptionsByInterface.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief Registers the waiter once the coroutine suspends.
+ *
+ * Changes are only cleared when notified to somebody, so the first to listen forgets what happened before.
+ */
+auto NetworkMonitor::nextChange(const network::Interface& intf, const ChangedFlags& interest) -> ChangeAwaiter
+{
+    if (m_subscribers.empty() && m_changeWaiters.empty()) {
+        for (const auto& [nsid, index] : takeDirtyTrackers()) {
+            if (auto* tracker = findTracker(nsid, index)) {
+                tracker->clearChangedFlags();
+            }
+        }
+    }
+    if (const auto awaited = m_awaitedInterest | interest; awaited != m_awaitedInterest) {
+        m_awaitedInterest = awaited;
+        updateMemberships();
+    }
+    return {m_changeWaiters, intf, interest};
+}
+
+/**
+ * @brief Starts monitoring network interfaces and processes netlink messages until stopped.
+ *
+ * Initiates interface enumeration and then enters a loop to receive and process netlink messages, continuing until
+ * monitoring is explicitly stopped.
+ */
+void NetworkMonitor::run()
+{
+    const LoopThreadScope scope {m_loopThread};
+    // someone may call enumerateInterfaces() and stop() during enumerateInterfaces
+    if (handleStopRequest() || !m_mnlSocket) {
+        return;
+    }
+    m_running = true;
+    spdlog::trace("Starting NetworkMonitor");
+    enumerateInterfaces();
+    spdlog::trace("Starting to receive and process messages from mnl socket {} m_running={}",
+                  static_cast<void*>(m_mnlSocket.get()),
+                  m_running);
+    while (m_running) {
+        waitForEvents();
+        std::ignore = receiveAndProcess(DATAGRAMS_PER_WAKEUP);
+    }
+}
+
+/**
+ * @brief Processes whatever is ready without blocking, for monitors driven by an external event loop.
+ *
+ * The first call starts the enumeration, whose replies are processed by later calls like any other datagram.
+ *
+ * @param budget the maximum number of datagrams to process, the rest is left for the next call.
+ * @return the number of datagrams processed.
+ * @note: with RuntimeFlag::ParallelEnumeration the first call blocks until the enumeration is complete.
+ */
+auto NetworkMonitor::processPending(const std::size_t budget) -> std::size_t
+{
+    const LoopThreadScope scope {m_loopThread};
+    clearWakeup();
+    if (handleStopRequest() || !m_mnlSocket) {
+        return 0;
+    }
+    if (!m_enumerationStarted) {
+        if (m_runtimeOptions.test(RuntimeFlag::ParallelEnumeration)) {
+            enumerateInParallel();
+        } else {
+            startEnumeration();
+        }
+    }
+    return receiveAndProcess(budget);
+}
+
+/**
+ * @brief Stops the network monitoring process and releases resources.
+ *
+ * Called from the thread running the monitor, e.g. from a subscriber callback, the netlink sockets are closed right
+ * away. Called from any other thread, the thread running the monitor is woken up to close them, so stop() is safe to
+ * call from anywhere.
+ */
+void NetworkMonitor::stop()
+{
+    spdlog::debug("Stopping NetworkMonitor");
+    m_stopRequested = true;
+    if (m_loopThread.load() == std::this_thread::get_id()) {
+        closeSockets();
+        return;
+    }
+    const uint64_t wakeup = 1;
+    if (write(m_wakeupFd, &wakeup, sizeof(wakeup)) < 0 && errno != EAGAIN) {
+        pfatal("write(eventfd)");
+    }
+}
+
+void NetworkMonitor::closeSockets()
+{
+    // cancels the receive, which holds on to the socket
+    m_uringReceiver.reset();
+    // the receive loop may still hold on to the thread and the datagram in process, but not to the socket
+    if (m_receiveThread) {
+        m_receiveThread->stop();
+        m_receiveThread.reset();
+    }
+    m_mnlSocket.reset();
+    m_linkSocket.reset();
+    m_filterAuditSocket.reset();
+    m_running = false;
+}
+
+auto NetworkMonitor::handleStopRequest() -> bool
+{
+    if (!m_stopRequested.load()) {
+        return false;
+    }
+    if (m_mnlSocket) {
+        spdlog::debug("Closing sockets after stop was requested");
+        closeSockets();
+    }
+    return true;
+}
+
+void NetworkMonitor::clearWakeup()
+{
+    uint64_t wakeups = 0;
+    if (read(m_wakeupFd, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN) {
+        pfatal("read(eventfd)");
+    }
+}
+
+/**
+ * @brief Blocks until a socket is readable or stop() was called from another thread.
+ */
+void NetworkMonitor::waitForEvents()
+{
+    std::array<epoll_event, 3> events {};
+    const auto ready = epoll_wait(m_epollFd, events.data(), static_cast<int>(events.size()), -1);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return;
+        }
+        pfatal("epoll_wait");
+    }
+    for (const auto& event : std::span {events.data(), static_cast<size_t>(ready)}) {
+        if (event.data.fd == m_wakeupFd) {
+            clearWakeup();
+        } else if (m_uringReceiver && event.data.fd == m_uringReceiver->fileDescriptor()) {
+            trackBacklog(m_backlogSince, true);
+        } else if (m_mnlSocket && event.data.fd == mnl_socket_get_fd(m_mnlSocket.get())) {
+            trackBacklog(m_backlogSince, true);
+        } else if (m_linkSocket && event.data.fd == mnl_socket_get_fd(m_linkSocket.get())) {
+            trackBacklog(m_linkBacklogSince, true);
+        }
+    }
+}
+
+/**
+ * @brief Watches the link socket for readiness only while its notifications are processed, see receiveAndProcess().
+ */
+void NetworkMonitor::watchLinkSocket(const bool watch)
+{
+    if (!m_linkSocket) {
+        return;
+    }
+    epoll_event event {};
+    event.events = watch ? EPOLLIN : 0U;
+    event.data.fd = mnl_socket_get_fd(m_linkSocket.get());
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, event.data.fd, &event) < 0) {
+        pfatal("epoll_ctl");
+    }
+}
 
-void NetworkMonitor::receiveAndProcess()
+/**
+ * @brief Receives and processes the datagrams that are ready without blocking.
+ *
+ * @param budget the maximum number of datagrams to process.
+ * @return the number of datagrams processed.
+ */
+auto NetworkMonitor::receiveAndProcess(const std::size_t budget) -> std::size_t
+{
+    if (handleStopRequest() || !m_mnlSocket) {
+        return 0;
+    }
+    if (m_resyncPending && !isEnumerating()) {
+        m_resyncPending = false;
+        requestResync();
+    }
+    if (m_uringReceiver) {
+        return receiveAndProcessUring(budget);
+    }
+    if (m_receiveThread) {
+        return receiveAndProcessPipelined(budget);
+    }
+    // link notifications wait for the end of an enumeration, which the dumps on m_mnlSocket are ordered with
+    if (m_linkSocket && !isEnumerating()) {
+        return receiveAndProcessPrioritized(budget);
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::BatchedReceive)) {
+        return receiveAndProcessBatch(budget);
+    }
+    spdlog::trace("Receiving messages from mnl socket");
+    std::size_t processed = 0;
+    while (processed < budget && m_mnlSocket) {
+        int32_t nsid = network::Interface::OWN_NAMESPACE;
+        const auto receiveResult = receive(MSG_DONTWAIT, nsid);
+        if (receiveResult <= 0) {
+            if (receiveResult < 0) {
+                handleReceiveError(m_backlogSince);
+            }
+            break;
+        }
+        processed++;
+        trackBacklog(m_backlogSince, true);
+        if (processDatagram(m_receiveBuffer.data(), static_cast<size_t>(receiveResult), m_backlogSince, nsid)) {
+            // the last reply of an enumeration changes the cache as well
+            notifyChanges();
+            break;
+        }
+        printStatsForNerdsIfEnabled();
+        notifyChanges();
+    }
+    return processed;
+}
+
+/**
+ * @brief Handles a failed receive, detecting lost change notifications.
+ *
+ * The kernel reports ENOBUFS once it had to drop multicast messages because the socket receive queue overflowed, and
+ * a datagram that did not fit the receive buffer is reported as ENOSPC. Either way the cache is stale from then on, so
+ * a resync is started.
+ *
+ * @param backlogSince the backlog of the socket that failed, which ended if it ran empty.
+ */
+void NetworkMonitor::handleReceiveError(std::optional<std::chrono::steady_clock::time_point>& backlogSince)
+{
+    const auto err = errno;
+    if (err == EAGAIN) {
+        backlogSince.reset();
+        return;
+    }
+    if (err == ENOSPC) {
+        m_stats.receiveTruncations++;
+        spdlog::warn("A datagram did not fit the receive buffer, change notifications were lost");
+        requestResync();
+        return;
+    }
+    if (err != ENOBUFS) {
+        spdlog::trace("Receiving stopped: {}", strerror(err));
+        return;
+    }
+    m_stats.receiveOverflows++;
+    spdlog::warn("Receive queue overflowed, change notifications were lost");
+    requestResync();
+}
+
+/**
+ * @brief Receives the next datagram into the receive buffer.
+ *
+ * With RuntimeFlag::AdaptiveReceiveBuffer the buffer uses the ceiling while enumerating, as the kernel fills dump
+ * datagrams up to the size offered by the reader. Otherwise the size of the next datagram is peeked using
+ * MSG_PEEK|MSG_TRUNC to grow the buffer before receiving, and the buffer shrinks back once the datagrams got smaller.
+ * Peeking stops while the buffer is at the ceiling, only a datagram larger than the ceiling can be truncated then.
+ *
+ * @param nsid set to the namespace the datagram came from with RuntimeFlag::ListenAllNamespaces.
+ */
+auto NetworkMonitor::receive(const int flags, int32_t& nsid) -> ssize_t
+{
+    auto* const namespaceOut = m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces) ? &nsid : nullptr;
+    if (!m_runtimeOptions.test(RuntimeFlag::AdaptiveReceiveBuffer)) {
+        return receiveFrom(m_mnlSocket.get(), m_receiveBuffer, flags, namespaceOut);
+    }
+    if (isEnumerating()) {
+        if (m_receiveBuffer.size() < m_receiveBufferPolicy.ceiling()) {
+            resizeReceiveBuffer(m_receiveBufferPolicy.ceiling());
+        }
+    } else if (m_receiveBufferPolicy.shouldPeek(m_receiveBuffer.size())) {
+        m_stats.receiveBufferPeeks++;
+        const auto pending = recv(mnl_socket_get_fd(m_mnlSocket.get()), nullptr, 0, MSG_PEEK | MSG_TRUNC | flags);
+        if (pending < 0) {
+            return pending;
+        }
+        if (static_cast<size_t>(pending) > m_receiveBuffer.size()) {
+            resizeReceiveBuffer(m_receiveBufferPolicy.sizeFor(static_cast<size_t>(pending)));
+        }
+    }
+    const auto receiveResult = receiveFrom(m_mnlSocket.get(), m_receiveBuffer, flags, namespaceOut);
+    if (receiveResult > 0 && !isEnumerating()) {
+        if (const auto shrinkTo =
+                m_receiveBufferPolicy.observe(m_receiveBuffer.size(), static_cast<size_t>(receiveResult));
+            shrinkTo.has_value())
+        {
+            resizeReceiveBuffer(shrinkTo.value());
+        }
+    }
+    return receiveResult;
+}
+
+void NetworkMonitor::resizeReceiveBuffer(const size_t size)
+{
+    spdlog::debug("Resizing receive buffer from {} to {} bytes", m_receiveBuffer.size(), size);
+    if (size > m_receiveBuffer.size()) {
+        m_stats.receiveBufferGrows++;
+        m_receiveBuffer.resize(size);
+    } else {
+        m_stats.receiveBufferShrinks++;
+        m_receiveBuffer.resize(size);
+        m_receiveBuffer.shrink_to_fit();
+    }
+}
+
+/**
+ * @brief Receives up to RECEIVE_BATCH_SIZE datagrams per recvmmsg call and processes them.
+ *
+ * Subscribers are notified once per batch instead of once per datagram. With RuntimeFlag::ShardedProcessing the
+ * messages of a batch of change notifications are queued while the datagrams stay in place, and applied in parallel
+ * once the whole batch was seen.
+ */
+auto NetworkMonitor::receiveAndProcessBatch(const std::size_t budget) -> std::size_t
+{
+    std::array<iovec, RECEIVE_BATCH_SIZE> iovecs {};
+    std::array<sockaddr_nl, RECEIVE_BATCH_SIZE> addresses {};
+    std::array<mmsghdr, RECEIVE_BATCH_SIZE> headers {};
+    std::array<std::array<uint8_t, NSID_CONTROL_SIZE>, RECEIVE_BATCH_SIZE> controls {};
+    const auto listenAllNamespaces = m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces);
+    for (size_t i = 0; i < RECEIVE_BATCH_SIZE; ++i) {
+        iovecs[i].iov_base = m_batchReceiveBuffer.data() + (i * RECEIVE_SOCKET_BUFFER_SIZE);
+        iovecs[i].iov_len = RECEIVE_SOCKET_BUFFER_SIZE;
+        headers[i].msg_hdr.msg_name = &addresses[i];
+        headers[i].msg_hdr.msg_iov = &iovecs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    std::size_t processed = 0;
+    while (processed < budget && m_mnlSocket) {
+        spdlog::trace("Receiving batch of messages from mnl socket");
+        for (size_t i = 0; i < RECEIVE_BATCH_SIZE; ++i) {
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_nl);
+            // the kernel shrinks the control length to what it attached
+            headers[i].msg_hdr.msg_control = listenAllNamespaces ? controls[i].data() : nullptr;
+            headers[i].msg_hdr.msg_controllen = listenAllNamespaces ? controls[i].size() : 0U;
+        }
+        const auto batchSize = std::min<std::size_t>(headers.size(), budget - processed);
+        const auto received = recvmmsg(
+            mnl_socket_get_fd(m_mnlSocket.get()), headers.data(), batchSize, MSG_DONTWAIT, nullptr);
+        if (received <= 0) {
+            if (received < 0) {
+                handleReceiveError(m_backlogSince);
+            }
+            break;
+        }
+        trackBacklog(m_backlogSince, true);
+        m_stats.batchesReceived++;
+        m_stats.packetsReceivedInBatches += static_cast<size_t>(received);
+        processed += static_cast<size_t>(received);
+        bool stopReceiving = false;
+        // replies after the end of a dump step or a retry belong to a dump that is over, unlike change notifications
+        bool skipReplies = false;
+        m_deferToShards = m_shardPool != nullptr && !isEnumerating();
+        for (size_t i = 0; i < static_cast<size_t>(received) && m_mnlSocket; ++i) {
+            if (m_deferToShards && isEnumerating()) {
+                // a resync started, its replies are parsed right away and must not be overtaken by older messages
+                applyShardedMessages();
+                m_deferToShards = false;
+            }
+            const auto& hdr = headers[i].msg_hdr;
+            if ((hdr.msg_flags & MSG_TRUNC) != 0) {
+                errno = ENOSPC;
+                handleReceiveError(m_backlogSince);
+                continue;
+            }
+            if (hdr.msg_namelen != sizeof(sockaddr_nl)) {
+                spdlog::warn("Discarding malformed datagram of {} bytes", headers[i].msg_len);
+                continue;
+            }
+            const auto* data = static_cast<const uint8_t*>(iovecs[i].iov_base);
+            const auto nsid = listenAllNamespaces ? namespaceOf(hdr) : network::Interface::OWN_NAMESPACE;
+            if (skipReplies && nsid == network::Interface::OWN_NAMESPACE && headers[i].msg_len >= sizeof(nlmsghdr)
+                && static_cast<const nlmsghdr*>(iovecs[i].iov_base)->nlmsg_pid == m_portid)
+            {
+                spdlog::trace("Discarding reply of {} bytes to a dump that is over", headers[i].msg_len);
+                continue;
+            }
+            if (processDatagram(data, headers[i].msg_len, m_backlogSince, nsid)) {
+                skipReplies = true;
+                stopReceiving = true;
+            }
+        }
+        applyShardedMessages();
+        m_deferToShards = false;
+        if (!m_mnlSocket) {
+            return processed;
+        }
+        printStatsForNerdsIfEnabled();
+        notifyChanges();
+        if (stopReceiving) {
+            break;
+        }
+    }
+    return processed;
+}
+
+/**
+ * @brief Drains the link socket with RuntimeFlag::PrioritizeLinkEvents before every datagram of the main socket.
+ *
+ * Only a single datagram of addresses and routes is processed in between, so a link notification waits for at most
+ * one such datagram, however many of them queued up during a route storm. Datagrams are received one at a time, so
+ * RuntimeFlag::BatchedReceive and RuntimeFlag::ShardedProcessing are bypassed until the next enumeration.
+ */
+auto NetworkMonitor::receiveAndProcessPrioritized(const std::size_t budget) -> std::size_t
+{
+    std::size_t processed = 0;
+    while (processed < budget && m_mnlSocket) {
+        processed += drainLinkSocket(budget - processed);
+        if (processed == budget || !m_mnlSocket) {
+            break;
+        }
+        int32_t nsid = network::Interface::OWN_NAMESPACE;
+        const auto receiveResult = receive(MSG_DONTWAIT, nsid);
+        if (receiveResult <= 0) {
+            if (receiveResult < 0) {
+                handleReceiveError(m_backlogSince);
+            }
+            break;
+        }
+        processed++;
+        trackBacklog(m_backlogSince, true);
+        processed += drainLinkSocketFor(m_receiveBuffer.data(), static_cast<size_t>(receiveResult), nsid, budget);
+        std::ignore =
+            processDatagram(m_receiveBuffer.data(), static_cast<size_t>(receiveResult), m_backlogSince, nsid);
+        printStatsForNerdsIfEnabled();
+        notifyChanges();
+    }
+    return processed;
+}
+
+/**
+ * @brief Processes the datagrams the multishot receive of RuntimeFlag::IoUringReceive picked up, without a syscall
+ * each.
+ *
+ * The link socket keeps being drained first with RuntimeFlag::PrioritizeLinkEvents.
+ */
+auto NetworkMonitor::receiveAndProcessUring(const std::size_t budget) -> std::size_t
+{
+    const auto receiver = m_uringReceiver;
+    std::size_t processed = 0;
+    while (processed < budget && m_mnlSocket) {
+        if (m_linkSocket && !isEnumerating()) {
+            processed += drainLinkSocket(budget - processed);
+            if (processed == budget || !m_mnlSocket) {
+                break;
+            }
+        }
+        std::span<const uint8_t> datagram;
+        const auto received = receiver->receive(datagram);
+        if (received <= 0) {
+            if (received < 0) {
+                handleReceiveError(m_backlogSince);
+            }
+            break;
+        }
+        processed++;
+        m_stats.packetsReceivedThroughUring++;
+        trackBacklog(m_backlogSince, true);
+        if (m_linkSocket && !isEnumerating()) {
+            processed +=
+                drainLinkSocketFor(datagram.data(), datagram.size(), network::Interface::OWN_NAMESPACE, budget);
+        }
+        // datagrams picked up already cannot be left on the socket, so processing goes on after an enumeration step
+        std::ignore = processDatagram(datagram.data(), datagram.size(), m_backlogSince);
+        printStatsForNerdsIfEnabled();
+        notifyChanges();
+    }
+    m_stats.uringBuffersRanOut = receiver->buffersRanOut();
+    return processed;
+}
+
+/**
+ * @brief Processes the datagrams the receive thread of RuntimeFlag::PipelinedReceive queued.
+ *
+ * Like with io_uring, datagrams already taken off the socket are processed after an enumeration step, and the link
+ * socket keeps being drained first with RuntimeFlag::PrioritizeLinkEvents.
+ */
+auto NetworkMonitor::receiveAndProcessPipelined(const std::size_t budget) -> std::size_t
+{
+    const auto receiveThread = m_receiveThread;
+    const auto trackLatency = m_runtimeOptions.test(RuntimeFlag::StatsForNerds);
+    std::size_t processed = 0;
+    while (processed < budget && m_mnlSocket) {
+        if (m_linkSocket && !isEnumerating()) {
+            processed += drainLinkSocket(budget - processed);
+            if (processed == budget || !m_mnlSocket) {
+                break;
+            }
+        }
+        const auto* datagram = receiveThread->front();
+        if (datagram == nullptr) {
+            break;
+        }
+        processed++;
+        if (datagram->size < 0) {
+            errno = datagram->error;
+            receiveThread->pop();
+            handleReceiveError(m_backlogSince);
+            continue;
+        }
+        m_stats.packetsReceivedThroughPipeline++;
+        if (m_linkSocket && !isEnumerating()) {
+            processed += drainLinkSocketFor(
+                datagram->buffer.data(), static_cast<size_t>(datagram->size), datagram->nsid, budget);
+        }
+        std::ignore = processDatagram(datagram->buffer.data(),
+                                      static_cast<size_t>(datagram->size),
+                                      trackLatency ? std::optional {datagram->readableSince} : std::nullopt,
+                                      datagram->nsid);
+        receiveThread->pop();
+        printStatsForNerdsIfEnabled();
+        notifyChanges();
+    }
+    receiveThread->wakeUpIfPending();
+    m_stats.pipelineHighWaterMark = receiveThread->highWaterMark();
+    m_stats.pipelineStalls = receiveThread->stalls();
+    return processed;
+}
+
+auto NetworkMonitor::drainLinkSocket(const std::size_t budget) -> std::size_t
+{
+    std::size_t processed = 0;
+    while (processed < budget && m_linkSocket) {
+        int32_t nsid = network::Interface::OWN_NAMESPACE;
+        const auto received = receiveFrom(m_linkSocket.get(),
+                                          m_linkReceiveBuffer,
+                                          MSG_DONTWAIT,
+                                          m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces) ? &nsid : nullptr);
+        if (received <= 0) {
+            if (received < 0) {
+                handleReceiveError(m_linkBacklogSince);
+            }
+            break;
+        }
+        processed++;
+        trackBacklog(m_linkBacklogSince, true);
+        std::ignore =
+            processDatagram(m_linkReceiveBuffer.data(), static_cast<size_t>(received), m_linkBacklogSince, nsid);
+        notifyChanges();
+    }
+    return processed;
+}
+
+/**
+ * @brief Drains the link socket again if a datagram of the main socket is about interfaces that are not known yet.
+ *
+ * The kernel queues the link message of a new interface on the link socket before its addresses and routes on the main
+ * socket, but possibly after the link socket was drained last. Once the datagram is received, the link message is
+ * queued for sure, so the datagram is not discarded for want of its interface.
+ *
+ * @return the number of datagrams drained from the link socket.
+ */
+auto NetworkMonitor::drainLinkSocketFor(const uint8_t* data,
+                                        const std::size_t size,
+                                        const int32_t nsid,
+                                        const std::size_t budget) -> std::size_t
+{
+    auto remaining = static_cast<int>(size);
+    for (const auto* n = static_cast<const nlmsghdr*>(static_cast<const void*>(data)); mnl_nlmsg_ok(n, remaining);
+         n = mnl_nlmsg_next(n, &remaining))
+    {
+        // removals refer to interfaces removed already all the time
+        if (n->nlmsg_type != RTM_NEWADDR && n->nlmsg_type != RTM_NEWROUTE) {
+            continue;
+        }
+        const auto ifIndex = interfaceOf(n);
+        if (ifIndex != 0 && findTracker(nsid, ifIndex) == nullptr) {
+            m_stats.linkSocketRedrains++;
+            return drainLinkSocket(budget);
+        }
+    }
+    return 0;
+}
+
+// the backlog of a socket starts when it is first seen readable and ends once it is seen empty
+void NetworkMonitor::trackBacklog(std::optional<std::chrono::steady_clock::time_point>& since,
+                                  const bool readable) const
+{
+    if (!m_runtimeOptions.test(RuntimeFlag::StatsForNerds)) {
+        return;
+    }
+    if (!readable) {
+        since.reset();
+    } else if (!since.has_value()) {
+        since = std::chrono::steady_clock::now();
+    }
+}
+
+/**
+ * @brief Runs the netlink message callbacks over a single received datagram.
+ *
+ * @param waitingSince start of the backlog the datagram was received from, if tracked.
+ * @param nsid the namespace the datagram came from, which only sends change notifications.
+ * @return true if receiving should stop, either because an enumeration step completed or a dump needs a retry.
+ */
+auto NetworkMonitor::processDatagram(const uint8_t* data,
+                                     const size_t size,
+                                     const std::optional<std::chrono::steady_clock::time_point> waitingSince,
+                                     const int32_t nsid) -> bool
+{
+    if (nsid != network::Interface::OWN_NAMESPACE) {
+        m_stats.packetsFromOtherNamespaces++;
+    }
+    // change notifications carry the sequence number and port id of whoever caused the change, so only replies to our
+    // own dump requests are checked against the sequence number, and the port id check of libmnl is disabled
+    const auto* header = static_cast<const nlmsghdr*>(static_cast<const void*>(data));
+    const auto isReply =
+        nsid == network::Interface::OWN_NAMESPACE && size >= sizeof(nlmsghdr) && header->nlmsg_pid == m_portid;
+    const auto isDumpReply = isEnumerating() && isReply;
+    // replies arrive on the own socket without an nsid, also when the dump targeted another namespace
+    m_datagramNamespace = isDumpReply ? m_dumpNamespace : nsid;
+    if (!isReply) {
+        m_stats.eventBytesDelivered += size;
+        if (waitingSince.has_value() && size >= sizeof(nlmsghdr)) {
+            recordLatency(header->nlmsg_type, waitingSince.value());
+        }
+    }
+    const auto seqNo = isDumpReply ? m_sequenceNumber : 0;
+    return handleCallbackResult(runCallbacks(data, size, seqNo, ANY_PORTID));
+}
+
+void NetworkMonitor::recordLatency(const uint16_t msgType, const std::chrono::steady_clock::time_point waitingSince)
+{
+    const auto latency = std::chrono::duration_cast<LatencyHistogram::Duration>(std::chrono::steady_clock::now()
+                                                                                - waitingSince);
+    switch (msgType) {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+            m_stats.linkLatency.record(latency);
+            break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+            m_stats.addressLatency.record(latency);
+            break;
+        case RTM_NEWROUTE:
+        case RTM_DELROUTE:
+            m_stats.routeLatency.record(latency);
+            break;
+        default:
+            break;
+    }
+}
+
+auto NetworkMonitor::runCallbacks(const uint8_t* data, const size_t size, const uint32_t seqNo, const uint32_t portid)
+    -> int
+{
+    spdlog::trace("Received {} bytes", size);
+    updateStats(static_cast<ssize_t>(size));
+    if (m_runtimeOptions.test(RuntimeFlag::DumpPackets)) {
+        dumpPacket(data, size);
+    }
+    return mnl_cb_run2(data,
+                       size,
+                       seqNo,
+                       portid,
+                       &NetworkMonitor::dispatchMnMessageCallbackToSelf,
+                       this,
+                       CONTROL_CALLBACKS.data(),
+                       CONTROL_CALLBACKS.size());
+}
+
+auto NetworkMonitor::interfacesFromCache() -> Interfaces
+{
+    Interfaces intfs;
+    for (const auto& [index, tracker] : m_trackers) {
+        intfs.emplace(index, tracker.name());
+    }
+    for (const auto& [key, tracker] : m_peerTrackers) {
+        intfs.emplace(key.second, tracker.name(), key.first);
+    }
+    return intfs;
+}
+
+void NetworkMonitor::updateStats(const ssize_t receiveResult)
+{
+    m_stats.packetsReceived++;
+    m_stats.bytesReceived += static_cast<size_t>(receiveResult);
+}
+
+void NetworkMonitor::dumpPacket(const uint8_t* data, const size_t size)
+{
+    std::ignore = fflush(stderr);
+    std::ignore = fflush(stdout);
+    mnl_nlmsg_fprintf(stdout, data, size, 0);
+}
+
+auto NetworkMonitor::handleCallbackResult(int callbackResult) -> bool
+{
+    if (callbackResult == MNL_CB_ERROR && isEnumerating() && errno == ENODEV && !m_pendingDumpIfIndexes.empty()) {
+        spdlog::debug("Interface {} vanished before it was dumped", m_pendingDumpIfIndexes.front());
+        callbackResult = MNL_CB_STOP;
+    }
+    if (callbackResult == MNL_CB_ERROR && isEnumerating()
+        && (m_namespaceDumps.listing || !m_namespaceDumps.pending.empty()) && errno != EPROTO
+        && !shouldRetryDump(errno))
+    {
+        if (m_namespaceDumps.listing) {
+            spdlog::warn("Cannot list the nsids of other network namespaces: {}", strerror(errno));
+        } else {
+            spdlog::info("Cannot dump network namespace {}: {}", m_namespaceDumps.pending.front(), strerror(errno));
+        }
+        m_namespaceDumps.failed = true;
+        callbackResult = MNL_CB_STOP;
+    }
+    if (callbackResult == MNL_CB_ERROR) {
+        if (isEnumerating()) {
+            if (errno == EPROTO) {
+                spdlog::debug("Ignoring stale reply to a previous dump request");
+                return false;
+            }
+            if (shouldRetryDump(errno)) {
+                spdlog::info("Retrying dump request");
+                retryLastDumpRequestWithNewSequenceNumber();
+            } else {
+                pfatal("mnl_cb_run unexpected MNL_CB_ERROR while enumerating");
+            }
+        } else {
+            pfatal("mnl_cb_run unexpected MNL_CB_ERROR while not enumerating");
+        }
+        return true;
+    }
+    if (callbackResult == MNL_CB_STOP) {
+        if (sendNextFilteredDumpRequest() || sendNextNamespaceDumpRequest()) {
+            return false;
+        }
+        if (isEnumeratingLinks()) {
+            if (m_resyncing) {
+                reconcileLinksAfterResync();
+            }
+            m_dumpFilter = dumpFilter(true);
+            return enterEnumerationStep(CacheState::EnumeratingAddresses);
+        }
+        if (isEnumeratingAddresses()) {
+            if (m_resyncing) {
+                reconcileAddressesAfterResync();
+            }
+            return enterEnumerationStep(CacheState::EnumeratingRoutes);
+        }
+        if (isEnumeratingRoutes()) {
+            if (m_resyncing) {
+                reconcileGatewaysAfterResync();
+            }
+            return finishEnumeration();
+        }
+        if (m_mnlSocket) {
+            pfatal("Unexpected MNL_CB_STOP");
+        }
+        return true;  // someone may call stop() while we are notifying watchers
+    }
+    return false;
+}
+
+void NetworkMonitor::startEnumeration(const CacheState first, const CacheState last)
+{
+    m_enumerationStarted = true;
+    m_lastEnumerationStep = last;
+    m_pendingDumpIfIndexes.clear();
+    watchLinkSocket(false);
+    if (first != CacheState::EnumeratingLinks) {
+        m_dumpFilter = dumpFilter(true);
+    }
+    enterEnumerationStep(first);
+}
+
+/**
+ * @brief Requests the dumps of the given enumeration step, or of the next one that is followed.
+ *
+ * @return true if no step was left and the enumeration is done.
+ */
+auto NetworkMonitor::enterEnumerationStep(CacheState step) -> bool
+{
+    for (; step <= m_lastEnumerationStep; step = static_cast<CacheState>(std::to_underlying(step) + 1)) {
+        const auto msgType = step == CacheState::EnumeratingLinks ? RTM_GETLINK
+            : step == CacheState::EnumeratingAddresses            ? RTM_GETADDR
+                                                                  : RTM_GETROUTE;
+        if (isFollowed(step)) {
+            m_cacheState = step;
+            m_namespaceDumps.restart();
+            startDumps(msgType);
+            return false;
+        }
+        spdlog::debug("Skipping {}, its state is not followed", toDumpRequestName(msgType));
+    }
+    return finishEnumeration();
+}
+
+/**
+ * @brief Tells whether the state an enumeration step dumps is kept up to date.
+ *
+ * Gateways are only tracked for IPv4, addresses and gateways only while their groups are joined.
+ */
+auto NetworkMonitor::isFollowed(const CacheState step) const -> bool
+{
+    switch (step) {
+        case CacheState::EnumeratingAddresses:
+            return m_addressGroupsJoined;
+        case CacheState::EnumeratingRoutes:
+            return m_routeGroupsJoined && !m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6);
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Requests the dump of the current enumeration step, once per interface of the dump filter if there is one.
+ */
+void NetworkMonitor::startDumps(const uint16_t msgType)
+{
+    if (msgType == RTM_GETLINK || m_dumpFilter.empty()) {
+        spdlog::debug("Requesting {}", toDumpRequestName(msgType));
+        sendDumpRequest(msgType);
+        return;
+    }
+    m_pendingDumpIfIndexes.assign(m_dumpFilter.begin(), m_dumpFilter.end());
+    spdlog::debug("Requesting {} for {} interfaces", toDumpRequestName(msgType), m_pendingDumpIfIndexes.size());
+    sendDumpRequest(msgType, m_pendingDumpIfIndexes.front());
+}
+
+/**
+ * @brief Moves on to the next interface of a filtered enumeration step.
+ *
+ * @return true if another dump request was sent, false if the enumeration step is complete.
+ */
+auto NetworkMonitor::sendNextFilteredDumpRequest() -> bool
+{
+    if (!isEnumerating() || m_pendingDumpIfIndexes.empty()) {
+        return false;
+    }
+    m_pendingDumpIfIndexes.pop_front();
+    if (m_pendingDumpIfIndexes.empty()) {
+        return false;
+    }
+    sendDumpRequest(isEnumeratingAddresses() ? RTM_GETADDR : RTM_GETROUTE, m_pendingDumpIfIndexes.front());
+    return true;
+}
+
+/**
+ * @brief Moves on to the next namespace of the link or address step with RuntimeFlag::ListenAllNamespaces.
+ *
+ * Once the links of the own namespace are dumped, the nsids of the other namespaces are listed, and both steps then
+ * dump the links or addresses of one listed namespace after the other. Routes cannot be dumped by nsid.
+ *
+ * @return true if another dump request was sent, false if the enumeration step is complete.
+ */
+auto NetworkMonitor::sendNextNamespaceDumpRequest() -> bool
+{
+    auto& dumps = m_namespaceDumps;
+    if (!dumpsOtherNamespaces() || !(isEnumeratingLinks() || isEnumeratingAddresses())) {
+        return false;
+    }
+    if (!dumps.started) {
+        dumps.started = true;
+        if (isEnumeratingLinks()) {
+            dumps.listed.emplace();
+            dumps.listing = true;
+            spdlog::debug("Requesting {}", toDumpRequestName(RTM_GETNSID));
+            sendDumpRequest(RTM_GETNSID);
+            return true;
+        }
+    } else if (dumps.listing) {
+        dumps.listing = false;
+        if (std::exchange(dumps.failed, false)) {
+            dumps.listed.reset();
+        }
+    } else if (!dumps.pending.empty()) {
+        if (!std::exchange(dumps.failed, false)) {
+            dumps.dumped.insert(dumps.pending.front());
+        }
+        dumps.pending.pop_front();
+        if (dumps.pending.empty()) {
+            return false;
+        }
+        sendDumpRequest(isEnumeratingLinks() ? RTM_GETLINK : RTM_GETADDR, 0, dumps.pending.front());
+        return true;
+    } else {
+        return false;
+    }
+    if (!dumps.listed.has_value() || dumps.listed->empty()) {
+        return false;
+    }
+    dumps.pending.assign(dumps.listed->begin(), dumps.listed->end());
+    const auto msgType = isEnumeratingLinks() ? RTM_GETLINK : RTM_GETADDR;
+    spdlog::debug("Requesting {} for {} other network namespaces", toDumpRequestName(msgType), dumps.pending.size());
+    sendDumpRequest(msgType, 0, dumps.pending.front());
+    return true;
+}
+
+/**
+ * @brief Tells whether the enumeration dumps other namespaces, which needs strict checking to target them by nsid.
+ */
+auto NetworkMonitor::dumpsOtherNamespaces() const -> bool
+{
+    return m_strictCheck && m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces);
+}
+
+auto NetworkMonitor::finishEnumeration() -> bool
+{
+    m_cacheState = CacheState::WaitingForChanges;
+    m_resyncing = false;
+    watchLinkSocket(true);
+    spdlog::debug("Done with enumeration of initial information");
+    spdlog::debug("Tracking changes for {} interfaces", m_trackers.size());
+    printStatsForNerdsIfEnabled();
+    return true;
+}
+
+/**
+ * @brief Collects the interfaces of all subscriptions to filter the address and route dumps by.
+ *
+ * @param knownInterfacesOnly leaves out interfaces that are not in the cache, i.e. which the link dump did not report.
+ * @return the interface indexes, or an empty set if the dumps should not be filtered.
+ */
+auto NetworkMonitor::dumpFilter(const bool knownInterfacesOnly) const -> std::set<uint32_t>
+{
+    if (!m_strictCheck || !m_runtimeOptions.test(RuntimeFlag::DumpSubscribedInterfacesOnly)) {
+        return {};
+    }
+    std::set<uint32_t> ifIndexes;
+    for (const auto& [subscriber, subscription] : m_subscribers) {
+        for (const auto& intf : subscription.interfaces) {
+            // 0 would remove the filter from the dump request, and other namespaces are dumped unfiltered
+            if (intf.index() != 0 && intf.isInOwnNamespace()
+                && (!knownInterfacesOnly || m_trackers.contains(intf.index())))
+            {
+                ifIndexes.insert(intf.index());
+            }
+        }
+    }
+    if (ifIndexes.size() > m_maxFilteredDumpInterfaces) {
+        spdlog::debug("Not filtering dumps by {} subscribed interfaces", ifIndexes.size());
+        return {};
+    }
+    return ifIndexes;
+}
+
+/**
+ * @brief Dumps links, addresses and routes again and reconciles the cache with the result.
+ *
+ * Change notifications keep being processed while the dumps are in progress. Whatever the dumps do not report any
+ * longer is removed at the end of the respective dump, so subscribers only see real differences. A pending resync
+ * always covers all steps.
+ */
+void NetworkMonitor::requestResync(const CacheState first, const CacheState last)
 {
-    if (!m_mnlSocket) {
+    if (isEnumerating()) {
+        spdlog::debug("Enumeration in progress, resyncing afterwards");
+        m_resyncPending = true;
         return;
     }
-    spdlog::trace("Receiving messages from mnl socket");
-    auto receiveResult = mnl_socket_recvfrom(m_mnlSocket.get(), m_receiveBuffer.data(), m_receiveBuffer.size());
-    while (receiveResult > 0) {
-        spdlog::trace("Received {} bytes", receiveResult);
-        updateStats(receiveResult);
-        if (m_runtimeOptions.test(RuntimeFlag::DumpPackets)) {
-            dumpPacket(receiveResult);
-        }
-        const auto seqNo = isEnumerating() ? m_sequenceNumber : 0;
-        const auto callbackResult = mnl_cb_run(m_receiveBuffer.data(),
-                                               static_cast<size_t>(receiveResult),
-                                               seqNo,
-                                               m_portid,
-                                               &NetworkMonitor::dispatchMnMessageCallbackToSelf,
-                                               this);
-        if (handleCallbackResult(callbackResult)) {
-            break;
-        }
-        printStatsForNerdsIfEnabled();
-        notifyChanges();
-        if (m_mnlSocket) {
-            receiveResult = mnl_socket_recvfrom(m_mnlSocket.get(), m_receiveBuffer.data(), m_receiveBuffer.size());
-        }
+    spdlog::info("Resyncing cache of {} interfaces", m_trackers.size());
+    if (!m_peerTrackers.empty() && !dumpsOtherNamespaces()) {
+        spdlog::warn("{} interfaces of other namespaces cannot be dumped and may stay stale", m_peerTrackers.size());
     }
+    m_stats.resyncs++;
+    m_resyncing = true;
+    m_resync = {};
+    startEnumeration(first, last);
 }
 
-auto NetworkMonitor::interfacesFromCache() -> Interfaces
+/**
+ * @brief Removes the interfaces the link dumps of a resync did not report.
+ *
+ * Interfaces of other namespaces are only removed if their namespace was dumped, or if it is no longer listed, e.g. as
+ * it went away.
+ */
+void NetworkMonitor::reconcileLinksAfterResync()
 {
-    Interfaces intfs;
-    for (const auto& [index, tracker] : m_trackers) {
-        intfs.emplace(index, tracker.name());
+    for (auto it = m_trackers.begin(); it != m_trackers.end();) {
+        if (m_resync.links.contains({network::Interface::OWN_NAMESPACE, it->first})) {
+            ++it;
+            continue;
+        }
+        const network::Interface intf {it->first, it->second.name()};
+        spdlog::debug("Interface {} vanished while overflowing", intf);
+        it = m_trackers.erase(it);
+        notifyInterfaceRemoved(intf);
+    }
+    if (!dumpsOtherNamespaces() || !m_namespaceDumps.listed.has_value()) {
+        return;
+    }
+    const auto& listed = m_namespaceDumps.listed.value();
+    for (auto it = m_peerTrackers.begin(); it != m_peerTrackers.end();) {
+        const auto nsid = it->first.first;
+        const auto unlisted = std::ranges::find(listed, nsid) == listed.end();
+        if (!unlisted && (!m_namespaceDumps.dumped.contains(nsid) || m_resync.links.contains(it->first))) {
+            ++it;
+            continue;
+        }
+        const network::Interface intf {it->first.second, it->second.name(), nsid};
+        spdlog::debug("Interface {} vanished while overflowing", intf);
+        it = m_peerTrackers.erase(it);
+        notifyInterfaceRemoved(intf);
     }
-    return intfs;
 }
 
-void NetworkMonitor::updateStats(const ssize_t receiveResult)
+void NetworkMonitor::reconcileAddressesAfterResync()
 {
-    m_stats.packetsReceived++;
-    m_stats.bytesReceived += static_cast<size_t>(receiveResult);
+    const auto reconcile = [this](const std::pair<int32_t, uint32_t>& key, NetworkInterfaceStatusTracker& tracker)
+    {
+        const auto seen = m_resync.addresses.find(key);
+        const auto stale = Addresses {tracker.networkAddresses()};
+        for (const auto& address : stale) {
+            if (seen == m_resync.addresses.end() || !seen->second.contains(address)) {
+                tracker.removeNetworkAddress(address);
+            }
+        }
+    };
+    for (auto& [index, tracker] : m_trackers) {
+        if (m_dumpFilter.empty() || m_dumpFilter.contains(index)) {
+            reconcile({network::Interface::OWN_NAMESPACE, index}, tracker);
+        }
+    }
+    for (auto& [key, tracker] : m_peerTrackers) {
+        if (m_namespaceDumps.dumped.contains(key.first)) {
+            reconcile(key, tracker);
+        }
+    }
 }
 
-void NetworkMonitor::dumpPacket(const ssize_t receiveResult) const
+void NetworkMonitor::reconcileGatewaysAfterResync()
 {
-    std::ignore = fflush(stderr);
-    std::ignore = fflush(stdout);
-    mnl_nlmsg_fprintf(stdout, m_receiveBuffer.data(), static_cast<size_t>(receiveResult), 0);
+    for (auto& [index, tracker] : m_trackers) {
+        if (!m_dumpFilter.empty() && !m_dumpFilter.contains(index)) {
+            continue;
+        }
+        if (!m_resync.gateways.contains(index)) {
+            tracker.clearGatewayAddress(GatewayClearReason::MissingAfterResync);
+        }
+    }
 }
 
-auto NetworkMonitor::handleCallbackResult(const int callbackResult) -> bool
+/**
+ * @brief Runs the link, address and route dumps at once, each on its own short-lived socket.
+ *
+ * Addresses and routes are only recorded for known links, so their datagrams are deferred until the link dump
+ * completed and then processed in the order of the serial enumeration. A dump reporting an inconsistency is restarted
+ * on a fresh socket, which avoids draining the remainder of the interrupted dump. Dumps filtered by interface run one
+ * after the other on the socket of their message type. Change notifications queue up on the main socket in the
+ * meantime and are processed afterwards. Resyncs always enumerate serially.
+ */
+void NetworkMonitor::enumerateInParallel()
 {
-    if (callbackResult == MNL_CB_ERROR) {
-        if (isEnumerating()) {
-            if (shouldRetryDump(errno)) {
-                spdlog::info("Retrying dump request");
-                retryLastDumpRequestWithNewSequenceNumber();
+    const auto startTime = std::chrono::steady_clock::now();
+    m_enumerationStarted = true;
+    std::array<ParallelDump, 3> dumps {
+        ParallelDump {RTM_GETLINK}, ParallelDump {RTM_GETADDR}, ParallelDump {RTM_GETROUTE}};
+    auto& links = dumps.front();
+    // subscribed interfaces the link dump does not report end their dumps with ENODEV
+    m_dumpFilter = dumpFilter(false);
+    const auto sendNextRequest = [this](ParallelDump& dump)
+    {
+        const auto ifIndex = dump.ifIndexes.empty() ? 0U : dump.ifIndexes[dump.nextIfIndex];
+        dump.nextIfIndex++;
+        dump.seqNo = nextDumpRequestSequenceNumber();
+        spdlog::debug("Requesting {} for interface {} on socket with port id {}",
+                      toDumpRequestName(dump.msgType),
+                      ifIndex,
+                      dump.portid);
+        sendDumpRequest(dump.socket.get(), dump.msgType, dump.seqNo, ifIndex);
+    };
+    const auto startDump = [this, &sendNextRequest](ParallelDump& dump)
+    {
+        openDumpSocket(dump, m_strictCheck);
+        sendNextRequest(dump);
+    };
+    // returns false once stop() was called
+    const auto process =
+        [this, &startDump, &sendNextRequest](ParallelDump& dump, const uint8_t* data, const size_t size) -> bool
+    {
+        auto callbackResult = runCallbacks(data, size, dump.seqNo, dump.portid);
+        if (!m_mnlSocket) {
+            return false;
+        }
+        if (callbackResult == MNL_CB_ERROR && errno == ENODEV && !dump.ifIndexes.empty()) {
+            spdlog::debug("Interface {} vanished before it was dumped", dump.ifIndexes[dump.nextIfIndex - 1]);
+            callbackResult = MNL_CB_STOP;
+        }
+        if (callbackResult == MNL_CB_ERROR) {
+            if (!shouldRetryDump(errno)) {
+                pfatal("mnl_cb_run unexpected MNL_CB_ERROR while enumerating in parallel");
+            }
+            spdlog::info("Retrying {}", toDumpRequestName(dump.msgType));
+            m_stats.parallelDumpRetries++;
+            startDump(dump);
+        } else if (callbackResult == MNL_CB_STOP) {
+            if (dump.nextIfIndex < dump.ifIndexes.size()) {
+                sendNextRequest(dump);
             } else {
-                pfatal("mnl_cb_run unexpected MNL_CB_ERROR while enumerating");
+                spdlog::debug("Done with {}", toDumpRequestName(dump.msgType));
+                dump.socket.reset();
             }
-        } else {
-            pfatal("mnl_cb_run unexpected MNL_CB_ERROR while not enumerating");
         }
         return true;
+    };
+
+    for (auto& dump : dumps) {
+        if ((dump.msgType == RTM_GETADDR && !isFollowed(CacheState::EnumeratingAddresses))
+            || (dump.msgType == RTM_GETROUTE && !isFollowed(CacheState::EnumeratingRoutes)))
+        {
+            continue;
+        }
+        if (dump.msgType != RTM_GETLINK) {
+            dump.ifIndexes.assign(m_dumpFilter.begin(), m_dumpFilter.end());
+        }
+        startDump(dump);
     }
-    if (callbackResult == MNL_CB_STOP) {
-        if (isEnumeratingLinks()) {
-            m_cacheState = CacheState::EnumeratingAddresses;
-            spdlog::debug("Requesting RTM_GETADDR");
-            sendDumpRequest(RTM_GETADDR);
-        } else if (isEnumeratingAddresses()) {
-            m_cacheState = CacheState::EnumeratingRoutes;
-            spdlog::debug("Requesting RTM_GETROUTE");
-            sendDumpRequest(RTM_GETROUTE);
-        } else if (isEnumeratingRoutes()) {
-            m_cacheState = CacheState::WaitingForChanges;
-            spdlog::debug("Done with enumeration of initial information");
-            spdlog::debug("Tracking changes for {} interfaces", m_trackers.size());
-            printStatsForNerdsIfEnabled();
-            return true;
-        } else {
-            if (m_mnlSocket) {
-                pfatal("Unexpected MNL_CB_STOP");
-            } else {
-                return true;  // someone may call stop() while we are notifying watchers
+    std::vector<uint8_t> buffer(RECEIVE_SOCKET_BUFFER_SIZE);
+    while (m_mnlSocket && std::ranges::any_of(dumps, [](const auto& dump) { return !dump.done(); })) {
+        std::array<pollfd, dumps.size()> fds {};
+        for (size_t i = 0; i < dumps.size(); ++i) {
+            fds[i].fd = dumps[i].done() ? -1 : mnl_socket_get_fd(dumps[i].socket.get());
+            fds[i].events = POLLIN;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            pfatal("poll");
         }
+        // links first, so deferred datagrams are processed as soon as the link dump completed
+        for (size_t i = 0; i < dumps.size() && m_mnlSocket; ++i) {
+            auto& dump = dumps[i];
+            if (dump.done() || fds[i].revents == 0) {
+                continue;
+            }
+            const auto received = mnl_socket_recvfrom(dump.socket.get(), buffer.data(), buffer.size());
+            if (received < 0) {
+                if (!shouldRetryDump(errno)) {
+                    pfatal("mnl_socket_recvfrom");
+                }
+                m_stats.parallelDumpRetries++;
+                startDump(dump);
+                continue;
+            }
+            if (&dump != &links && !links.done()) {
+                dump.deferred.emplace_back(buffer.data(), buffer.data() + received);
+                continue;
+            }
+            if (!process(dump, buffer.data(), static_cast<size_t>(received)) || &dump != &links || !links.done()) {
+                continue;
+            }
+            for (auto& other : dumps) {
+                const auto deferred = std::exchange(other.deferred, {});
+                const auto seqNo = other.seqNo;
+                spdlog::debug(
+                    "Processing {} deferred datagrams of {}", deferred.size(), toDumpRequestName(other.msgType));
+                for (const auto& datagram : deferred) {
+                    // a retried dump starts over, the rest of the deferred datagrams belongs to the interrupted one
+                    if (other.done() || other.seqNo != seqNo || !process(other, datagram.data(), datagram.size())) {
+                        break;
+                    }
+                }
+            }
+        }
+        notifyChanges();
     }
-    return false;
+    m_cacheState = CacheState::WaitingForChanges;
+    watchLinkSocket(true);
+    spdlog::debug(
+        "Done with parallel enumeration in {}ms",
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+    spdlog::debug("Tracking changes for {} interfaces", m_trackers.size());
+    printStatsForNerdsIfEnabled();
+}
+
+void NetworkMonitor::sendDumpRequest(const uint16_t msgType, const uint32_t ifIndex, const int32_t nsid)
+{
+    m_dumpNamespace = nsid;
+    sendDumpRequest(m_mnlSocket.get(), msgType, nextDumpRequestSequenceNumber(), ifIndex, nsid);
 }
 
-void NetworkMonitor::sendDumpRequest(const uint16_t msgType)
+/**
+ * @brief Sends a dump request for the given message type.
+ *
+ * With strict checking the request carries the full header of the message type, so the kernel only dumps the family
+ * of interest and, if ifIndex is not 0, only the addresses or routes of that interface. Strict checking rejects
+ * attributes a dump does not support, so IFLA_EXT_MASK is only added to link dumps.
+ *
+ * With RuntimeFlag::DefaultRoutesOnly route dumps are restricted to the main table. Dump filters cannot select the
+ * destination length, so the other routes of the main table are discarded before their attributes are parsed.
+ *
+ * Link and address dumps of another namespace carry its nsid, which also needs strict checking.
+ */
+void NetworkMonitor::sendDumpRequest(mnl_socket* socket,
+                                     const uint16_t msgType,
+                                     const uint32_t seqNo,
+                                     const uint32_t ifIndex,
+                                     const int32_t nsid)
 {
     nlmsghdr* nlh = mnl_nlmsg_put_header(m_sendBuffer.data());
     nlh->nlmsg_type = msgType;
     nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
-    nlh->nlmsg_seq = nextDumpRequestSequenceNumber();
-    auto* gen = static_cast<rtgenmsg*>(mnl_nlmsg_put_extra_header(nlh, sizeof(struct rtgenmsg)));
-    gen->rtgen_family = AF_UNSPEC;
-    mnl_attr_put_u32(nlh, IFLA_EXT_MASK, RTEXT_FILTER_SKIP_STATS);
-    const auto ret = mnl_socket_sendto(m_mnlSocket.get(), nlh, nlh->nlmsg_len);
+    nlh->nlmsg_seq = seqNo;
+    const auto family = dumpFamily(msgType);
+    if (!m_strictCheck || msgType == RTM_GETNSID) {
+        auto* gen = static_cast<rtgenmsg*>(mnl_nlmsg_put_extra_header(nlh, sizeof(struct rtgenmsg)));
+        gen->rtgen_family = family;
+    } else if (msgType == RTM_GETADDR) {
+        auto* ifa = static_cast<ifaddrmsg*>(mnl_nlmsg_put_extra_header(nlh, sizeof(struct ifaddrmsg)));
+        ifa->ifa_family = family;
+        ifa->ifa_index = ifIndex;
+        if (nsid != network::Interface::OWN_NAMESPACE) {
+            mnl_attr_put_u32(nlh, IFA_TARGET_NETNSID, static_cast<uint32_t>(nsid));
+        }
+    } else if (msgType == RTM_GETROUTE) {
+        auto* rtm = static_cast<rtmsg*>(mnl_nlmsg_put_extra_header(nlh, sizeof(struct rtmsg)));
+        rtm->rtm_family = family;
+        if (m_runtimeOptions.test(RuntimeFlag::DefaultRoutesOnly)) {
+            rtm->rtm_table = RT_TABLE_MAIN;
+            mnl_attr_put_u32(nlh, RTA_TABLE, RT_TABLE_MAIN);
+        }
+        if (ifIndex != 0) {
+            mnl_attr_put_u32(nlh, RTA_OIF, ifIndex);
+        }
+    } else {
+        auto* ifi = static_cast<ifinfomsg*>(mnl_nlmsg_put_extra_header(nlh, sizeof(struct ifinfomsg)));
+        ifi->ifi_family = family;
+    }
+    if (msgType == RTM_GETLINK) {
+        mnl_attr_put_u32(nlh, IFLA_EXT_MASK, RTEXT_FILTER_SKIP_STATS);
+        if (nsid != network::Interface::OWN_NAMESPACE) {
+            mnl_attr_put_u32(nlh, IFLA_TARGET_NETNSID, static_cast<uint32_t>(nsid));
+        }
+    }
+    const auto ret = mnl_socket_sendto(socket, nlh, nlh->nlmsg_len);
     if (ret < 0) {
         pfatal("mnl_socket_sendto");
     }
@@ -302,10 +2193,21 @@ void NetworkMonitor::sendDumpRequest(const uint16_t msgType)
 
 void NetworkMonitor::retryLastDumpRequestWithNewSequenceNumber()
 {
-    while (mnl_socket_recvfrom(m_mnlSocket.get(), m_receiveBuffer.data(), m_receiveBuffer.size()) > 0) {
+    static_assert(alignof(nlmsghdr) <= alignof(std::max_align_t), "nlmsghdr alignment requirements not met");
+    ssize_t drained = 0;
+    while ((drained = recv(mnl_socket_get_fd(m_mnlSocket.get()),
+                           m_receiveBuffer.data(),
+                           m_receiveBuffer.size(),
+                           MSG_DONTWAIT))
+           > 0)
+    {
         spdlog::trace("Drained some old messages from socket");
+        const auto* drainedHeader = static_cast<const nlmsghdr*>(static_cast<const void*>(m_receiveBuffer.data()));
+        if (static_cast<size_t>(drained) >= sizeof(nlmsghdr) && drainedHeader->nlmsg_pid != m_portid) {
+            // not a reply to our dump but a change notification, which is lost now
+            m_resyncPending = true;
+        }
     }
-    static_assert(alignof(nlmsghdr) <= alignof(std::max_align_t), "nlmsghdr alignment requirements not met");
     auto* buf = static_cast<void*>(m_sendBuffer.data());
     auto* nlh = static_cast<nlmsghdr*>(buf);
     if (((nlh->nlmsg_flags & NLM_F_DUMP) == 0) || ((nlh->nlmsg_flags & NLM_F_REQUEST) == 0)) {
@@ -322,6 +2224,24 @@ void NetworkMonitor::retryLastDumpRequestWithNewSequenceNumber()
     m_stats.bytesSent += static_cast<size_t>(ret);
 }
 
+auto NetworkMonitor::dumpFamily(const uint16_t msgType) const -> uint8_t
+{
+    switch (msgType) {
+        case RTM_GETADDR:
+            if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV4)) {
+                return AF_INET;
+            }
+            if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6)) {
+                return AF_INET6;
+            }
+            return AF_UNSPEC;
+        case RTM_GETROUTE:
+            return AF_INET;  // gateways are only tracked for IPv4
+        default:
+            return AF_UNSPEC;
+    }
+}
+
 auto NetworkMonitor::nextDumpRequestSequenceNumber() -> uint32_t
 {
     ++m_sequenceNumber;
@@ -337,73 +2257,279 @@ auto NetworkMonitor::mnlMessageCallback(const nlmsghdr* n) -> int
         return MNL_CB_STOP;  // someone may call stop() while we are processing messages
     }
     m_stats.msgsReceived++;
+    // the shards only know the trackers of the own namespace
+    const auto ownNamespace = m_datagramNamespace == network::Interface::OWN_NAMESPACE;
+    if (!m_deferToShards || !ownNamespace || !deferToShard(n)) {
+        parseMessage(n, m_datagramNamespace, m_stats.parsing);
+    }
+    return MNL_CB_OK;
+}
+
+void NetworkMonitor::parseMessage(const nlmsghdr* n, const int32_t nsid, ParseStatistics& stats)
+{
     switch (const auto t = n->nlmsg_type) {
         case RTM_NEWLINK:
         case RTM_DELLINK: {
             const auto* ifi = static_cast<const ifinfomsg*>(mnl_nlmsg_get_payload(n));
-            parseLinkMessage(n, ifi);
+            parseLinkMessage(n, ifi, nsid, stats);
         } break;
         case RTM_NEWADDR:
         case RTM_DELADDR: {
             const auto* ifa = static_cast<const ifaddrmsg*>(mnl_nlmsg_get_payload(n));
-            parseAddressMessage(n, ifa);
+            parseAddressMessage(n, ifa, nsid, stats);
         } break;
         case RTM_NEWROUTE:
         case RTM_DELROUTE: {
             const auto* rt = static_cast<const rtmsg*>(mnl_nlmsg_get_payload(n));
-            parseRouteMessage(n, rt);
+            parseRouteMessage(n, rt, nsid, stats);
         } break;
+        case RTM_NEWNSID:
+            parseNamespaceMessage(n);
+            break;
         default:
             spdlog::warn("ignoring unexpected message type: {}", t);
             break;
     }
-    return MNL_CB_OK;
 }
 
-auto NetworkMonitor::ensureNameCurrent(const uint32_t ifIndex, const std::optional<std::string>& name)
-    -> NetworkInterfaceStatusTracker&
+/**
+ * @brief Queues address and route messages of known interfaces for the shard of their interface.
+ *
+ * Each interface belongs to a single shard, which applies its messages in order. Link messages create and remove
+ * trackers and notify subscribers, so they are parsed right away, after the shard of their interface applied the
+ * messages queued before them. Messages that are not queued are parsed right away as well, which discards them.
+ *
+ * @return whether the message was queued.
+ */
+auto NetworkMonitor::deferToShard(const nlmsghdr* n) -> bool
+{
+    if (n->nlmsg_type == RTM_NEWLINK || n->nlmsg_type == RTM_DELLINK) {
+        const auto ifIndex = static_cast<uint32_t>(static_cast<const ifinfomsg*>(mnl_nlmsg_get_payload(n))->ifi_index);
+        if (m_shardedInterfaces.contains(ifIndex)) {
+            applyShard(ifIndex % m_shards.size());
+        }
+        return false;
+    }
+    const auto ifIndex = interfaceOf(n);
+    if (ifIndex == 0) {
+        return false;
+    }
+    // the trackers are only looked up while the shards run, never added or removed
+    const auto it = m_trackers.find(ifIndex);
+    if (it == m_trackers.end()) {
+        return false;
+    }
+    // listed here, as the shards must not list their trackers in parallel
+    it->second.markDirty();
+    m_shards[ifIndex % m_shards.size()].messages.push_back(n);
+    m_shardedInterfaces.insert(ifIndex);
+    m_stats.shardedMessages++;
+    return true;
+}
+
+/**
+ * @brief Applies the queued messages on all shards in parallel, then adds up what they counted.
+ *
+ * Nothing but the trackers of their own interfaces is touched by the shards, and subscribers are only notified once
+ * all of them are done, on the thread running the monitor.
+ */
+void NetworkMonitor::applyShardedMessages()
+{
+    if (m_shardedInterfaces.empty()) {
+        return;
+    }
+    m_shardPool->run(
+        [this](const std::size_t lane)
+        {
+            for (auto index = lane; index < m_shards.size(); index += m_shardPool->lanes()) {
+                auto& shard = m_shards[index];
+                for (const auto* message : shard.messages) {
+                    parseMessage(message, network::Interface::OWN_NAMESPACE, shard.stats);
+                }
+            }
+        });
+    for (auto& shard : m_shards) {
+        shard.messages.clear();
+        m_stats.parsing += shard.stats;
+        shard.stats = {};
+    }
+    m_shardedInterfaces.clear();
+    m_stats.shardedRuns++;
+}
+
+/**
+ * @brief Applies the queued messages of a single shard on the thread running the monitor, e.g. for a link message of
+ * one of its interfaces, leaving the other shards queued.
+ */
+void NetworkMonitor::applyShard(const std::size_t index)
+{
+    auto& shard = m_shards[index];
+    for (const auto* message : shard.messages) {
+        parseMessage(message, network::Interface::OWN_NAMESPACE, shard.stats);
+    }
+    shard.messages.clear();
+    m_stats.parsing += shard.stats;
+    shard.stats = {};
+    std::erase_if(m_shardedInterfaces,
+                  [this, index](const uint32_t ifIndex) { return ifIndex % m_shards.size() == index; });
+}
+
+auto NetworkMonitor::ParseStatistics::operator+=(const ParseStatistics& other) -> ParseStatistics&
+{
+    msgsDiscarded += other.msgsDiscarded;
+    seenAttributes += other.seenAttributes;
+    unknownAttributes += other.unknownAttributes;
+    addressMessagesSeen += other.addressMessagesSeen;
+    linkMessagesSeen += other.linkMessagesSeen;
+    routeMessagesSeen += other.routeMessagesSeen;
+    return *this;
+}
+
+auto NetworkMonitor::Statistics::operator+=(const Statistics& other) -> Statistics&
+{
+    startTime = std::min(startTime, other.startTime);
+    bytesSent += other.bytesSent;
+    bytesReceived += other.bytesReceived;
+    packetsSent += other.packetsSent;
+    packetsReceived += other.packetsReceived;
+    batchesReceived += other.batchesReceived;
+    packetsReceivedInBatches += other.packetsReceivedInBatches;
+    packetsReceivedThroughUring += other.packetsReceivedThroughUring;
+    uringBuffersRanOut += other.uringBuffersRanOut;
+    packetsReceivedThroughPipeline += other.packetsReceivedThroughPipeline;
+    pipelineHighWaterMark = std::max(pipelineHighWaterMark, other.pipelineHighWaterMark);
+    pipelineStalls += other.pipelineStalls;
+    snapshotsPublished += other.snapshotsPublished;
+    snapshotsUnpublished += other.snapshotsUnpublished;
+    shardedMessages += other.shardedMessages;
+    shardedRuns += other.shardedRuns;
+    packetsFromOtherNamespaces += other.packetsFromOtherNamespaces;
+    receiveBufferPeeks += other.receiveBufferPeeks;
+    receiveBufferGrows += other.receiveBufferGrows;
+    receiveBufferShrinks += other.receiveBufferShrinks;
+    linkSocketRedrains += other.linkSocketRedrains;
+    receiveOverflows += other.receiveOverflows;
+    receiveTruncations += other.receiveTruncations;
+    resyncs += other.resyncs;
+    parallelDumpRetries += other.parallelDumpRetries;
+    socketFilterUpdates += other.socketFilterUpdates;
+    membershipChanges += other.membershipChanges;
+    eventBytesDelivered += other.eventBytesDelivered;
+    eventBytesAudited += other.eventBytesAudited;
+    filterAuditOverflows += other.filterAuditOverflows;
+    msgsReceived += other.msgsReceived;
+    parsing += other.parsing;
+    linkLatency += other.linkLatency;
+    addressLatency += other.addressLatency;
+    routeLatency += other.routeLatency;
+    return *this;
+}
+
+auto NetworkMonitor::findTracker(const int32_t nsid, const uint32_t ifIndex) -> NetworkInterfaceStatusTracker*
+{
+    if (nsid == network::Interface::OWN_NAMESPACE) {
+        const auto it = m_trackers.find(ifIndex);
+        return it != m_trackers.end() ? &it->second : nullptr;
+    }
+    const auto it = m_peerTrackers.find({nsid, ifIndex});
+    return it != m_peerTrackers.end() ? &it->second : nullptr;
+}
+
+auto NetworkMonitor::interfaceState(const network::Interface& intf) const -> const NetworkInterfaceStatusTracker*
+{
+    if (intf.isInOwnNamespace()) {
+        const auto it = m_trackers.find(intf.index());
+        return it != m_trackers.end() ? &it->second : nullptr;
+    }
+    const auto it = m_peerTrackers.find({intf.namespaceId(), intf.index()});
+    return it != m_peerTrackers.end() ? &it->second : nullptr;
+}
+
+auto NetworkMonitor::ensureNameCurrent(const uint32_t ifIndex,
+                                       const std::optional<std::string>& name,
+                                       const int32_t nsid,
+                                       const LinkInfo* link) -> NetworkInterfaceStatusTracker&
 {
-    const auto before = m_trackers.size();
-    auto& cacheEntry = m_trackers[ifIndex];
+    // looked up first, as shards look up the trackers of their interfaces in parallel
+    auto* tracker = findTracker(nsid, ifIndex);
+    const auto added = tracker == nullptr;
+    if (added) {
+        tracker = nsid == network::Interface::OWN_NAMESPACE
+            ? &m_trackers.try_emplace(ifIndex).first->second
+            : &m_peerTrackers.try_emplace(std::make_pair(nsid, ifIndex)).first->second;
+        tracker->setDirtyList(&m_dirtyTrackers, {nsid, ifIndex});
+    }
+    auto& cacheEntry = *tracker;
+    // what the patterns look at and may change, the link type and kind stay the same
+    const auto renamed = name.has_value() && name.value() != cacheEntry.name();
+    const auto flagsChanged = link != nullptr && link->flags != cacheEntry.linkFlags();
 
     // Sometimes interfaces are renamed, account for that
     if (name.has_value()) {
         cacheEntry.setName(name.value());
     }
-    if (before != m_trackers.size()) {
-        spdlog::debug("Added new interface tracker for index {}: {}", ifIndex, cacheEntry.name());
-        notifyInterfaceAdded(network::Interface {ifIndex, cacheEntry.name()});
+    if (link != nullptr) {
+        cacheEntry.setLinkType(link->type);
+        if (link->kind.has_value()) {
+            cacheEntry.setLinkKind(link->kind.value());
+        }
+        cacheEntry.updateLinkFlags(link->flags);
+    }
+    // matched on the first link message, which carries all the patterns look at, whichever message added the tracker,
+    // and again once the name or the link flags change
+    if (link != nullptr && (!cacheEntry.isMatched() || renamed || flagsChanged)) {
+        cacheEntry.setMatched();
+        matchPatterns(network::Interface {ifIndex, cacheEntry.name(), nsid}, cacheEntry);
+    }
+    if (added) {
+        const network::Interface intf {ifIndex, cacheEntry.name(), nsid};
+        spdlog::debug("Added new interface tracker for {}", intf);
+        notifyInterfaceAdded(intf);
     }
     return cacheEntry;
 }
 
-void NetworkMonitor::parseLinkMessage(const nlmsghdr* nlhdr, const ifinfomsg* ifi)
+void NetworkMonitor::parseLinkMessage(const nlmsghdr* nlhdr,
+                                      const ifinfomsg* ifi,
+                                      const int32_t nsid,
+                                      ParseStatistics& stats)
 {
     spdlog::trace("Parsing link message for interface index {}", ifi->ifi_index);
-    m_stats.linkMessagesSeen++;
+    stats.linkMessagesSeen++;
     const auto attributes =
-        Attributes::parse(nlhdr, sizeof(*ifi), IFLA_MAX, m_stats.seenAttributes, m_stats.unknownAttributes);
+        Attributes::parse(nlhdr, sizeof(*ifi), IFLA_MAX, stats.seenAttributes, stats.unknownAttributes);
     const auto itfName = attributes.getString(IFLA_IFNAME);
     if (ifi->ifi_type != ARPHRD_ETHER && ifi->ifi_type != ARPHRD_IEEE80211) {
         if (!m_runtimeOptions.test(RuntimeFlag::IncludeNonIeee802)) {
             spdlog::debug("Discarding interface {}: {} (use RuntimeFlag::IncludeNonIeee802 option to include those)",
                           ifi->ifi_index,
                           itfName.value_or("unknown"));
-            m_stats.msgsDiscarded++;
+            stats.msgsDiscarded++;
             return;
         }
         spdlog::trace("Including non-IEEE 802.X interface {}: {}", ifi->ifi_index, itfName.value_or("unknown"));
     }
     if (nlhdr->nlmsg_type == RTM_DELLINK) {
         spdlog::trace("removing interface with index {}", ifi->ifi_index);
-        m_trackers.erase(static_cast<uint32_t>(ifi->ifi_index));
-        notifyInterfaceRemoved(network::Interface {static_cast<uint32_t>(ifi->ifi_index), itfName.value_or("unknown")});
+        const auto ifIndex = static_cast<uint32_t>(ifi->ifi_index);
+        if (nsid == network::Interface::OWN_NAMESPACE) {
+            m_trackers.erase(ifIndex);
+        } else {
+            m_peerTrackers.erase({nsid, ifIndex});
+        }
+        notifyInterfaceRemoved(network::Interface {ifIndex, itfName.value_or("unknown"), nsid});
         return;
     }
 
-    auto& cacheEntry = ensureNameCurrent(static_cast<uint32_t>(ifi->ifi_index), itfName);
-    const NetworkInterfaceStatusTracker::LinkFlags linkFlags(ifi->ifi_flags);
-    cacheEntry.updateLinkFlags(linkFlags);
+    const LinkInfo link {
+        .type = ifi->ifi_type,
+        .kind = attributes.getNestedString(IFLA_LINKINFO, IFLA_INFO_KIND),
+        .flags = NetworkInterfaceStatusTracker::LinkFlags(ifi->ifi_flags),
+    };
+    auto& cacheEntry = ensureNameCurrent(static_cast<uint32_t>(ifi->ifi_index), itfName, nsid, &link);
+    if (m_resyncing) {
+        m_resync.links.insert({nsid, static_cast<uint32_t>(ifi->ifi_index)});
+    }
 
     if (const auto operationalStateOpt = attributes.getU8(IFLA_OPERSTATE); operationalStateOpt.has_value()) {
         cacheEntry.setOperationalState(static_cast<OperationalState>(operationalStateOpt.value()));
@@ -423,33 +2549,36 @@ void NetworkMonitor::parseLinkMessage(const nlmsghdr* nlhdr, const ifinfomsg* if
     }
 }
 
-void NetworkMonitor::parseAddressMessage(const nlmsghdr* nlhdr, const ifaddrmsg* ifa)
+void NetworkMonitor::parseAddressMessage(const nlmsghdr* nlhdr,
+                                         const ifaddrmsg* ifa,
+                                         const int32_t nsid,
+                                         ParseStatistics& stats)
 {
     spdlog::trace("Parsing address message for interface index {}", ifa->ifa_index);
-    m_stats.addressMessagesSeen++;
-    if (!m_trackers.contains(ifa->ifa_index)) {
-        m_stats.msgsDiscarded++;
+    stats.addressMessagesSeen++;
+    if (findTracker(nsid, ifa->ifa_index) == nullptr) {
+        stats.msgsDiscarded++;
         return;
     }
     if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV4) && ifa->ifa_family != AF_INET) {
-        m_stats.msgsDiscarded++;
+        stats.msgsDiscarded++;
         return;
     }
 
     if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6) && ifa->ifa_family != AF_INET6) {
-        m_stats.msgsDiscarded++;
+        stats.msgsDiscarded++;
         return;
     }
 
     const auto attributes =
-        Attributes::parse(nlhdr, sizeof(*ifa), IFA_MAX, m_stats.seenAttributes, m_stats.unknownAttributes);
+        Attributes::parse(nlhdr, sizeof(*ifa), IFA_MAX, stats.seenAttributes, stats.unknownAttributes);
 
     uint32_t flags = ifa->ifa_flags;  // will be overwritten if IFA_FLAGS is present
     ip::Address address;
     std::optional<ip::Address> broadcast = std::nullopt;  // will be overwritten if IFA_BROADCAST is present
     uint8_t prot = IFAPROT_UNSPEC;  // will be overwritten if IFA_PROTO is present
 
-    auto& cacheEntry = ensureNameCurrent(ifa->ifa_index, attributes.getString(IFA_LABEL));
+    auto& cacheEntry = ensureNameCurrent(ifa->ifa_index, attributes.getString(IFA_LABEL), nsid);
     if (const auto flagsOpt = attributes.getU32(IFA_FLAGS); flagsOpt.has_value()) {
         flags = flagsOpt.value();
     }
@@ -473,40 +2602,52 @@ void NetworkMonitor::parseAddressMessage(const nlmsghdr* nlhdr, const ifaddrmsg*
                                            static_cast<network::AddressAssignmentProtocol>(prot)};
     if (nlhdr->nlmsg_type == RTM_NEWADDR) {
         cacheEntry.addNetworkAddress(networkAddress);
+        if (m_resyncing) {
+            m_resync.addresses[{nsid, ifa->ifa_index}].insert(networkAddress);
+        }
     } else if (nlhdr->nlmsg_type == RTM_DELADDR) {
         cacheEntry.removeNetworkAddress(networkAddress);
     }
 }
 
-void NetworkMonitor::parseRouteMessage(const nlmsghdr* nlhdr, const rtmsg* rtm)
+void NetworkMonitor::parseRouteMessage(const nlmsghdr* nlhdr,
+                                       const rtmsg* rtm,
+                                       const int32_t nsid,
+                                       ParseStatistics& stats)
 {
     spdlog::trace("Parsing route message");
-    m_stats.routeMessagesSeen++;
+    stats.routeMessagesSeen++;
     if (rtm->rtm_family != AF_INET) {
-        m_stats.msgsDiscarded++;
+        stats.msgsDiscarded++;
+        return;
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::DefaultRoutesOnly)
+        && (rtm->rtm_dst_len != 0 || rtm->rtm_table != RT_TABLE_MAIN))
+    {
+        stats.msgsDiscarded++;
         return;
     }
     if (m_runtimeOptions.test(RuntimeFlag::PreferredFamilyV6) && rtm->rtm_family != AF_INET6) {
-        m_stats.msgsDiscarded++;
+        stats.msgsDiscarded++;
         return;
     }
 
     const auto attributes =
-        Attributes::parse(nlhdr, sizeof(*rtm), RTA_MAX, m_stats.seenAttributes, m_stats.unknownAttributes);
+        Attributes::parse(nlhdr, sizeof(*rtm), RTA_MAX, stats.seenAttributes, stats.unknownAttributes);
     const auto ifIndexOpt = attributes.getU32(RTA_OIF);
     const auto gatewayV4Opt = attributes.getIpV4Address(RTA_GATEWAY);
 
     if (nlhdr->nlmsg_type == RTM_DELROUTE) {
         if (ifIndexOpt.has_value()) {
             if ((rtm->rtm_flags & RTNH_F_LINKDOWN) != 0U) {
-                if (const auto itr = m_trackers.find(ifIndexOpt.value()); itr != m_trackers.end()) {
-                    itr->second.clearGatewayAddress(GatewayClearReason::LinkDown);
+                if (auto* tracker = findTracker(nsid, ifIndexOpt.value()); tracker != nullptr) {
+                    tracker->clearGatewayAddress(GatewayClearReason::LinkDown);
                 }
                 return;
             }
             if (gatewayV4Opt.has_value()) {
-                if (const auto itr = m_trackers.find(ifIndexOpt.value()); itr != m_trackers.end()) {
-                    itr->second.clearGatewayAddress(GatewayClearReason::RouteDeleted);
+                if (auto* tracker = findTracker(nsid, ifIndexOpt.value()); tracker != nullptr) {
+                    tracker->clearGatewayAddress(GatewayClearReason::RouteDeleted);
                 }
             }
         }
@@ -514,8 +2655,46 @@ void NetworkMonitor::parseRouteMessage(const nlmsghdr* nlhdr, const rtmsg* rtm)
     }
 
     if (ifIndexOpt.has_value() && gatewayV4Opt.has_value()) {
-        if (const auto itr = m_trackers.find(ifIndexOpt.value()); itr != m_trackers.end()) {
-            itr->second.setGatewayAddress(gatewayV4Opt.value());
+        if (auto* tracker = findTracker(nsid, ifIndexOpt.value()); tracker != nullptr) {
+            tracker->setGatewayAddress(gatewayV4Opt.value());
+            if (m_resyncing && nsid == network::Interface::OWN_NAMESPACE) {
+                m_resync.gateways.insert(ifIndexOpt.value());
+            }
+        }
+    }
+}
+
+/**
+ * @brief Counts the bytes of all change notifications on the unfiltered audit socket.
+ *
+ * A classic BPF program cannot count what it drops, so the bytes the socket filter saved are the difference to the
+ * bytes delivered through the filtered socket. A full audit socket makes that difference a lower bound.
+ */
+// lists the nsid of another namespace in reply to the RTM_GETNSID dump
+void NetworkMonitor::parseNamespaceMessage(const nlmsghdr* nlhdr)
+{
+    const auto nsid = Attributes::findU32(nlhdr, sizeof(rtgenmsg), NETNSA_NSID);
+    if (!m_namespaceDumps.listing || !nsid.has_value()) {
+        spdlog::debug("ignoring unexpected RTM_NEWNSID");
+        return;
+    }
+    m_namespaceDumps.listed->push_back(static_cast<int32_t>(nsid.value()));
+}
+
+void NetworkMonitor::auditFilteredEvents()
+{
+    if (!m_filterAuditSocket) {
+        return;
+    }
+    ssize_t received = 0;
+    while ((received = recv(mnl_socket_get_fd(m_filterAuditSocket.get()), nullptr, 0, MSG_DONTWAIT | MSG_TRUNC)) != 0)
+    {
+        if (received > 0) {
+            m_stats.eventBytesAudited += static_cast<size_t>(received);
+        } else if (errno == ENOBUFS) {
+            m_stats.filterAuditOverflows++;
+        } else {
+            break;
         }
     }
 }
@@ -525,6 +2704,7 @@ void NetworkMonitor::printStatsForNerdsIfEnabled()
     if (isEnumerating() || !m_runtimeOptions.test(RuntimeFlag::StatsForNerds)) {
         return;
     }
+    auditFilteredEvents();
     spdlog::info("{:=^48}", "Stats for nerds");
     spdlog::info(
         "uptime    {}ms",
@@ -532,20 +2712,108 @@ void NetworkMonitor::printStatsForNerdsIfEnabled()
             .count());
     spdlog::info("sent      {} bytes in {} packets", m_stats.bytesSent, m_stats.packetsSent);
     spdlog::info("received  {} bytes in {} packets", m_stats.bytesReceived, m_stats.packetsReceived);
+    spdlog::info("received  {} bytes of change notifications", m_stats.eventBytesDelivered);
+    if (m_stats.batchesReceived > 0) {
+        const auto syscallsSaved = m_stats.packetsReceivedInBatches - m_stats.batchesReceived;
+        spdlog::info("received  {} packets in {} batches", m_stats.packetsReceivedInBatches, m_stats.batchesReceived);
+        spdlog::info("saved     {} syscalls, {:.2f} per batch",
+                     syscallsSaved,
+                     static_cast<double>(syscallsSaved) / static_cast<double>(m_stats.batchesReceived));
+    }
+    if (m_stats.packetsReceivedThroughUring > 0) {
+        spdlog::info("received  {} packets through io_uring, which ran out of buffers {} times",
+                     m_stats.packetsReceivedThroughUring,
+                     m_stats.uringBuffersRanOut);
+    }
+    if (m_shardPool) {
+        spdlog::info("sharded   {} messages across {} shards in {} runs",
+                     m_stats.shardedMessages,
+                     m_shards.size(),
+                     m_stats.shardedRuns);
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::ListenAllNamespaces)) {
+        spdlog::info("received  {} packets from other namespaces, tracking {} of their interfaces",
+                     m_stats.packetsFromOtherNamespaces,
+                     m_peerTrackers.size());
+    }
+    if (m_receiveThread) {
+        spdlog::info("received  {} packets on the receive thread, {} of {} queued, at most {}, stalled {} times",
+                     m_stats.packetsReceivedThroughPipeline,
+                     m_receiveThread->depth(),
+                     m_receiveThread->capacity(),
+                     m_stats.pipelineHighWaterMark,
+                     m_stats.pipelineStalls);
+    }
+    if (m_snapshots) {
+        spdlog::info("published {} snapshots of {} interfaces, {} could not be published",
+                     m_stats.snapshotsPublished,
+                     m_snapshots->size(),
+                     m_stats.snapshotsUnpublished);
+    }
+    if (m_runtimeOptions.test(RuntimeFlag::AdaptiveReceiveBuffer)) {
+        spdlog::info("resized   receive buffer {} times up, {} times down, peeked {} times, now {} bytes",
+                     m_stats.receiveBufferGrows,
+                     m_stats.receiveBufferShrinks,
+                     m_stats.receiveBufferPeeks,
+                     m_receiveBuffer.size());
+    }
+    if (m_stats.receiveOverflows > 0 || m_stats.receiveTruncations > 0) {
+        spdlog::info("overflowed {} times, truncated {} datagrams, resynced {} times",
+                     m_stats.receiveOverflows,
+                     m_stats.receiveTruncations,
+                     m_stats.resyncs);
+    }
+    if (m_filterAuditSocket) {
+        const auto filtered = m_stats.eventBytesAudited > m_stats.eventBytesDelivered
+            ? m_stats.eventBytesAudited - m_stats.eventBytesDelivered
+            : 0U;
+        spdlog::info("filtered  {}{} of {} event bytes in kernel, socket filter updated {} times",
+                     m_stats.filterAuditOverflows > 0 ? "at least " : "",
+                     filtered,
+                     m_stats.eventBytesAudited,
+                     m_stats.socketFilterUpdates);
+    }
+    if (m_stats.linkSocketRedrains > 0) {
+        spdlog::info("drained   link socket again for {} datagrams of unknown interfaces", m_stats.linkSocketRedrains);
+    }
+    if (m_stats.parallelDumpRetries > 0) {
+        spdlog::info("retried   {} parallel dumps", m_stats.parallelDumpRetries);
+    }
+    const auto printLatency = [](std::string_view name, const LatencyHistogram& histogram)
+    {
+        if (histogram.count() > 0) {
+            spdlog::info("latency   of {} {} events p50 <= {} p99 <= {} max {}",
+                         histogram.count(),
+                         name,
+                         histogram.percentile(MEDIAN),
+                         histogram.percentile(P99),
+                         histogram.max());
+        }
+    };
+    printLatency("link", m_stats.linkLatency);
+    printLatency("address", m_stats.addressLatency);
+    printLatency("route", m_stats.routeLatency);
+    if (m_stats.membershipChanges > 0) {
+        spdlog::info("joined or left {} multicast groups", m_stats.membershipChanges);
+    }
     spdlog::info("received  {} rtnl messages", m_stats.msgsReceived);
-    spdlog::info("discarded {} rtnl messages", m_stats.msgsDiscarded);
+    spdlog::info("discarded {} rtnl messages", m_stats.parsing.msgsDiscarded);
     spdlog::info("* seen");
-    spdlog::info("          {} attribute entries", m_stats.seenAttributes);
-    spdlog::info("          {} attributes unknown", m_stats.unknownAttributes);
-    spdlog::info("          {} link messages", m_stats.linkMessagesSeen);
-    spdlog::info("          {} address messages", m_stats.addressMessagesSeen);
-    spdlog::info("          {} route messages", m_stats.routeMessagesSeen);
+    spdlog::info("          {} attribute entries", m_stats.parsing.seenAttributes);
+    spdlog::info("          {} attributes unknown", m_stats.parsing.unknownAttributes);
+    spdlog::info("          {} link messages", m_stats.parsing.linkMessagesSeen);
+    spdlog::info("          {} address messages", m_stats.parsing.addressMessagesSeen);
+    spdlog::info("          {} route messages", m_stats.parsing.routeMessagesSeen);
 
     spdlog::info("{:=^48}", "Interface details in cache");
     for (const auto& [_, tracker] : m_trackers) {
         spdlog::info(tracker);
         tracker.logNerdstats();
     }
+    for (const auto& [key, tracker] : m_peerTrackers) {
+        spdlog::info("nsid {}: {}", key.first, tracker);
+        tracker.logNerdstats();
+    }
     spdlog::info("{:=^48}", "=");
 }
 
@@ -557,72 +2825,257 @@ auto NetworkMonitor::dispatchMnMessageCallbackToSelf(const nlmsghdr* n, void* se
 void NetworkMonitor::notifyChanges(Subscriber* subscriber,
                                    const network::Interface& intf,
                                    const NetworkInterfaceStatusTracker& tracker,
-                                   bool forceNotify)
+                                   const ChangedFlags& changed)
 {
-    if (forceNotify || tracker.isChanged(ChangedFlag::Name)) {
+    if (changed.test(ChangedFlag::Name)) {
         subscriber->onInterfaceNameChanged(intf);
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::OperationalState)) {
+    if (changed.test(ChangedFlag::OperationalState)) {
         subscriber->onOperationalStateChanged(intf, tracker.operationalState());
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::NetworkAddresses)) {
+    if (changed.test(ChangedFlag::NetworkAddresses)) {
         subscriber->onNetworkAddressesChanged(intf, tracker.networkAddresses());
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::GatewayAddress)) {
+    if (changed.test(ChangedFlag::GatewayAddress)) {
         subscriber->onGatewayAddressChanged(intf, tracker.gatewayAddress());
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::MacAddress)) {
+    if (changed.test(ChangedFlag::MacAddress)) {
         subscriber->onMacAddressChanged(intf, tracker.macAddress());
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::BroadcastAddress)) {
+    if (changed.test(ChangedFlag::BroadcastAddress)) {
         subscriber->onBroadcastAddressChanged(intf, tracker.broadcastAddress());
     }
-    if (forceNotify || tracker.isChanged(ChangedFlag::LinkFlags)) {
+    if (changed.test(ChangedFlag::LinkFlags)) {
         subscriber->onLinkFlagsChanged(intf, tracker.linkFlags());
     }
 }
 
+void NetworkMonitor::notifyChanges(Subscriber* subscriber,
+                                   const std::span<const InterfaceChange> changes,
+                                   const bool batched)
+{
+    if (batched) {
+        if (!changes.empty()) {
+            subscriber->onChangesBatch(changes);
+        }
+        return;
+    }
+    for (const auto& change : changes) {
+        notifyChanges(subscriber, change.interface, *change.tracker, change.changed);
+    }
+}
+
+/**
+ * @brief Tells the subscribers what changed, each of them all of its changes at once, then publishes the snapshots and
+ * resumes the waiters interface by interface.
+ *
+ * Only the trackers that listed themselves as changed are looked at. The changes are taken out of m_changes while the
+ * subscribers are told, as resumed coroutines may drive the monitor, which notifies again.
+ */
 void NetworkMonitor::notifyChanges()
 {
-    if (m_subscribers.empty()) {
-        return;  // no subscribers, nothing to notify
+    if (std::exchange(m_matchesChanged, false)) {
+        updateInterest();
     }
-    for (auto& [index, tracker] : m_trackers) {
-        spdlog::trace("checking {} for changes", tracker);
-        const network::Interface intf {index, tracker.name()};
-        for (const auto& [sub, intfs] : m_subscribers) {
-            if (intfs.contains(intf)) {
-                notifyChanges(sub.get(), intf, tracker);
+    if (m_subscribers.empty() && m_changeWaiters.empty() && !m_snapshots) {
+        // the trackers stay listed until somebody is told, but not the ones removed or listed twice meanwhile
+        if (m_dirtyTrackers.size() > m_trackers.size() + m_peerTrackers.size()) {
+            m_dirtyTrackers = takeDirtyTrackers();
+            std::erase_if(m_dirtyTrackers,
+                          [this](const auto& key) { return findTracker(key.first, key.second) == nullptr; });
+        }
+        return;  // nobody to notify
+    }
+    auto dirty = takeDirtyTrackers();
+    auto changes = std::exchange(m_changes, {});
+    for (const auto& [nsid, index] : dirty) {
+        const auto* tracker = findTracker(nsid, index);
+        if (tracker != nullptr && tracker->hasChanges()) {
+            changes.push_back({.interface = network::Interface {index, tracker->name(), nsid},
+                               .changed = tracker->changedFlags(),
+                               .tracker = tracker});
+        }
+    }
+    const DispatchScope dispatch {*this};
+    auto notified = std::exchange(m_notified, {});
+    for (const auto& change : changes) {
+        const auto it = m_subscriptionsByInterface.find(interfaceKey(change.interface));
+        if (it == m_subscriptionsByInterface.end()) {
+            continue;
+        }
+        for (auto* subscription : it->second) {
+            const auto wanted = subscription->matched.erase(change.interface) > 0
+                ? subscription->interest
+                : change.changed & subscription->interest;
+            if (wanted.none() || subscription->heldBack) {
+                continue;
             }
+            if (subscription->changes.empty()) {
+                notified.push_back(subscription);
+            }
+            subscription->changes.push_back(
+                {.interface = change.interface, .changed = wanted, .tracker = change.tracker});
+        }
+    }
+    for (auto* subscription : notified) {
+        if (subscription->subscriber == nullptr) {
+            subscription->changes.clear();  // left while the subscribers before it were called
+            continue;
+        }
+        auto batch = std::exchange(subscription->changes, std::exchange(m_batch, {}));
+        notifyChanges(subscription->subscriber, batch, subscription->batched);
+        batch.clear();
+        m_batch = std::move(batch);
+    }
+    notified.clear();
+    m_notified = std::move(notified);
+    if (m_subscriptionsHeldBack && !isEnumerating() && !m_resyncPending) {
+        releaseHeldBackSubscriptions();
+    }
+    for (const auto& [nsid, index] : dirty) {
+        auto* tracker = findTracker(nsid, index);
+        if (tracker == nullptr) {
+            continue;
         }
-        tracker.clearChangedFlags();
+        if (tracker->hasChanges()) {
+            notifyChanges(network::Interface {index, tracker->name(), nsid}, *tracker);
+        } else {
+            // listed, but its changes were undone since
+            tracker->clearChangedFlags();
+        }
+    }
+    changes.clear();
+    m_changes = std::move(changes);
+    // kept for its capacity, unless trackers listed themselves meanwhile
+    if (m_dirtyTrackers.empty()) {
+        dirty.clear();
+        m_dirtyTrackers = std::move(dirty);
+    }
+    if (m_snapshotsChanged) {
+        m_snapshots->commit();
+        m_snapshotsChanged = false;
     }
 }
 
-void NetworkMonitor::notifyChanges(Subscriber* subscriber, const Interfaces& intfs)
+/**
+ * @brief The listed trackers in the order of m_trackers and m_peerTrackers, each once, leaving m_dirtyTrackers to list
+ * them anew.
+ */
+auto NetworkMonitor::takeDirtyTrackers() -> NetworkInterfaceStatusTracker::DirtyList
+{
+    auto dirty = std::exchange(m_dirtyTrackers, {});
+    std::ranges::sort(dirty);
+    const auto duplicates = std::ranges::unique(dirty);
+    dirty.erase(duplicates.begin(), duplicates.end());
+    return dirty;
+}
+
+void NetworkMonitor::notifyChanges(const network::Interface& intf, NetworkInterfaceStatusTracker& tracker)
+{
+    spdlog::trace("checking {} for changes", tracker);
+    const auto changed = tracker.changedFlags();
+    // snapshots are looked up by index, so only the own namespace is published
+    if (m_snapshots && intf.isInOwnNamespace()) {
+        publishSnapshot(intf, tracker);
+    }
+    tracker.clearChangedFlags();
+    // last, as resumed coroutines may drive the monitor, which changes the tracker anew or removes it
+    m_changeWaiters.resume(intf, tracker, changed);
+}
+
+void NetworkMonitor::publishSnapshot(const network::Interface& intf, const NetworkInterfaceStatusTracker& tracker)
+{
+    if (m_snapshots->publish(intf.index(), tracker)) {
+        m_stats.snapshotsPublished++;
+        m_snapshotsChanged = true;
+    } else if (m_stats.snapshotsUnpublished++ == 0) {
+        spdlog::warn("No room to publish a snapshot of {}, {} interfaces are published already, raise "
+                     "Tunables::snapshotCapacity",
+                     intf,
+                     m_snapshots->size());
+    }
+}
+
+void NetworkMonitor::notifyChanges(Subscriber* subscriber, const Interfaces& intfs, const ChangedFlags& interest)
 {
     if (subscriber == nullptr || intfs.empty()) {
         return;  // no subscriber or no interfaces to notify
     }
-    for (const auto& [index, tracker] : m_trackers) {
-        const auto intf = network::Interface {index, tracker.name()};
-        if (intfs.contains(intf)) {
-            notifyChanges(subscriber, intf, tracker, /*forceNotify=*/true);
+    std::vector<InterfaceChange> changes;
+    for (const auto& intf : intfs) {
+        if (const auto* tracker = findTracker(intf.namespaceId(), intf.index())) {
+            changes.push_back({.interface = network::Interface {intf.index(), tracker->name(), intf.namespaceId()},
+                               .changed = interest,
+                               .tracker = tracker});
         }
     }
+    notifyChanges(subscriber, changes, subscriber->wantsChangesBatch());
 }
 
 void NetworkMonitor::notifyInterfaceAdded(const network::Interface& intf)
 {
-    for (const auto& [subscriber, _] : m_subscribers) {
-        subscriber->onInterfaceAdded(intf);
+    if (m_addedSubscriptions.empty()) {
+        return;
+    }
+    const DispatchScope dispatch {*this};
+    // subscribers may subscribe and unsubscribe while they are told
+    const auto subscriptions = m_addedSubscriptions;
+    for (const auto* subscription : subscriptions) {
+        if (subscription->subscriber != nullptr) {
+            subscription->subscriber->onInterfaceAdded(intf);
+        }
     }
 }
 
 void NetworkMonitor::notifyInterfaceRemoved(const network::Interface& intf)
 {
-    for (const auto& [subscriber, _] : m_subscribers) {
-        subscriber->onInterfaceRemoved(intf);
+    {
+        const DispatchScope dispatch {*this};
+        auto subscriptions = m_removedSubscriptions;
+        // the subscribed ones are told the removal of their interfaces anyway
+        if (const auto it = m_subscriptionsByInterface.find(interfaceKey(intf)); it != m_subscriptionsByInterface.end())
+        {
+            std::ranges::copy_if(it->second, std::back_inserter(subscriptions), [](const Subscription* subscription) {
+                return !subscription->events.test(InterfaceEvent::Removed);
+            });
+        }
+        for (const auto* subscription : subscriptions) {
+            if (subscription->subscriber != nullptr) {
+                subscription->subscriber->onInterfaceRemoved(intf);
+            }
+        }
+    }
+    // matched interfaces leave, to be matched anew if they come back, looked up again as subscribers may have left
+    if (const auto it = m_subscriptionsByInterface.find(interfaceKey(intf)); it != m_subscriptionsByInterface.end()) {
+        std::erase_if(it->second, [&intf](Subscription* subscription) {
+            subscription->matched.erase(intf);
+            return !subscription->patterns.empty() && subscription->interfaces.erase(intf) > 0;
+        });
+        if (it->second.empty()) {
+            m_subscriptionsByInterface.erase(it);
+        }
+    }
+    m_changeWaiters.resumeRemoved(intf);
+    if (m_snapshots && intf.isInOwnNamespace()) {
+        m_snapshots->remove(intf.index());
+        m_snapshotsChanged = true;
+    }
+}
+
+void NetworkMonitor::publishSnapshotsTo(std::shared_ptr<InterfaceSnapshots> snapshots)
+{
+    m_snapshots = std::move(snapshots);
+    m_snapshotsChanged = false;
+    updateMemberships();
+    if (!m_snapshots) {
+        return;
+    }
+    for (const auto& [index, tracker] : m_trackers) {
+        publishSnapshot(network::Interface {index, tracker.name()}, tracker);
+    }
+    if (m_snapshotsChanged) {
+        m_snapshots->commit();
+        m_snapshotsChanged = false;
     }
 }
 }  // namespace monkas::monitor
@@ -0,0 +1,431 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <linux/if_addr.h>
+#include <linux/if_arp.h>
+#include <linux/rtnetlink.h>
+#include <monitor/NetworkMonitor.hpp>
+#include <sys/socket.h>
+
+namespace monkas::monitor
+{
+
+// NOLINTBEGIN(*)
+
+// hands the monitor datagrams as if the kernel notified them, and notifies the subscribers like the receive loop does
+class NetworkMonitorTestPeer
+{
+  public:
+    explicit NetworkMonitorTestPeer(NetworkMonitor& monitor)
+        : m_monitor {monitor}
+    {
+        m_monitor.m_cacheState = NetworkMonitor::CacheState::WaitingForChanges;
+    }
+
+    void feed(const std::span<const uint8_t> datagram)
+    {
+        m_monitor.processDatagram(datagram.data(), datagram.size());
+        m_monitor.notifyChanges();
+    }
+
+  private:
+    NetworkMonitor& m_monitor;
+};
+
+// NOLINTEND(*)
+
+}  // namespace monkas::monitor
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+using monkas::network::Interface;
+
+class Message
+{
+  public:
+    template<typename Payload>
+    Message(const uint16_t type, const Payload& payload)
+        : m_data(NLMSG_SPACE(sizeof(Payload)))
+    {
+        nlmsghdr header {};
+        header.nlmsg_type = type;
+        std::memcpy(m_data.data(), &header, sizeof(header));
+        std::memcpy(m_data.data() + NLMSG_HDRLEN, &payload, sizeof(payload));
+    }
+
+    auto put(const uint16_t type, const void* data, const size_t size) -> Message&
+    {
+        const auto offset = m_data.size();
+        m_data.resize(offset + RTA_SPACE(size));
+        rtattr attribute {};
+        attribute.rta_len = RTA_LENGTH(size);
+        attribute.rta_type = type;
+        std::memcpy(m_data.data() + offset, &attribute, sizeof(attribute));
+        std::memcpy(m_data.data() + offset + RTA_LENGTH(0), data, size);
+        return *this;
+    }
+
+    auto datagram() -> std::span<const uint8_t>
+    {
+        auto length = static_cast<uint32_t>(m_data.size());
+        std::memcpy(m_data.data() + offsetof(nlmsghdr, nlmsg_len), &length, sizeof(length));
+        return m_data;
+    }
+
+  private:
+    std::vector<uint8_t> m_data;
+};
+
+auto link(const uint16_t type, const int index, const std::string& name, const unsigned flags = 0) -> Message
+{
+    ifinfomsg ifi {};
+    ifi.ifi_type = ARPHRD_ETHER;
+    ifi.ifi_index = index;
+    ifi.ifi_flags = flags;
+    const std::array<uint8_t, 6> mac {0x02, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(index)};
+    const std::array<uint8_t, 6> broadcast {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    Message message {type, ifi};
+    message.put(IFLA_IFNAME, name.c_str(), name.size() + 1)
+        .put(IFLA_ADDRESS, mac.data(), mac.size())
+        .put(IFLA_BROADCAST, broadcast.data(), broadcast.size());
+    return message;
+}
+
+auto address(const uint32_t index, const uint8_t lastOctet) -> Message
+{
+    ifaddrmsg ifa {};
+    ifa.ifa_family = AF_INET;
+    ifa.ifa_prefixlen = 24;
+    ifa.ifa_index = index;
+    const std::array<uint8_t, 4> local {192, 0, 2, lastOctet};
+    Message message {RTM_NEWADDR, ifa};
+    message.put(IFA_LOCAL, local.data(), local.size()).put(IFA_ADDRESS, local.data(), local.size());
+    return message;
+}
+
+// counts what it is told, and meddles with the subscriptions when told anything
+struct Meddler : Subscriber
+{
+    void onInterfaceAdded(const Interface& /*unused*/) override { told(); }
+
+    void onInterfaceRemoved(const Interface& /*unused*/) override { told(); }
+
+    void onNetworkAddressesChanged(const Interface& /*unused*/, const Addresses& /*unused*/) override { told(); }
+
+    void told()
+    {
+        ++calls;
+        if (meddle) {
+            meddle();
+        }
+    }
+
+    int calls {};
+    std::function<void()> meddle;
+};
+
+// like the subscribers of a MonitorHub::Handle, owned by whoever unsubscribes it, and done with the call afterwards
+struct Recorder : Subscriber
+{
+    explicit Recorder(std::vector<std::string>& log)
+        : log {log}
+    {
+    }
+
+    ~Recorder() override { log.push_back("destroyed"); }
+
+    void onNetworkAddressesChanged(const Interface& /*unused*/, const Addresses& /*unused*/) override
+    {
+        meddle();
+        log.push_back("told");
+    }
+
+    std::vector<std::string>& log;
+    std::function<void()> meddle;
+};
+
+auto addressesOnly() -> ChangedFlags
+{
+    ChangedFlags interest;
+    interest.set(ChangedFlag::NetworkAddresses);
+    return interest;
+}
+
+// starts right away and keeps its frame until destroyed
+struct Task
+{
+    struct promise_type
+    {
+        auto get_return_object() -> Task { return Task {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+
+        static auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+
+        static auto final_suspend() noexcept -> std::suspend_always { return {}; }
+
+        static void return_void() {}
+
+        static void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> h)
+        : handle {h}
+    {
+    }
+
+    ~Task()
+    {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : handle {std::exchange(other.handle, {})}
+    {
+    }
+
+    auto operator=(const Task&) -> Task& = delete;
+    auto operator=(Task&&) -> Task& = delete;
+
+    [[nodiscard]] auto done() const -> bool { return handle.done(); }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// drives the monitor once resumed, like a coroutine calling processPending()
+auto driveWhenChanged(NetworkMonitor& monitor,
+                      NetworkMonitorTestPeer& peer,
+                      const Interface intf,
+                      std::span<const uint8_t> datagram,
+                      std::vector<ChangedFlags>& seen) -> Task
+{
+    seen.push_back((co_await monitor.nextChange(intf, addressesOnly())).changed);
+    peer.feed(datagram);
+}
+
+auto waitOnce(NetworkMonitor& monitor, const Interface intf, std::optional<InterfaceChange>& result) -> Task
+{
+    result = co_await monitor.nextChange(intf);
+}
+
+// subscribers need an interface to subscribe to
+const Interfaces absent {Interface {99, "absent"}};
+
+auto only(const InterfaceEvent event) -> InterfaceEvents
+{
+    InterfaceEvents events;
+    events.set(event);
+    return events;
+}
+
+TEST_SUITE("[monitor::NetworkMonitor]")
+{
+    TEST_CASE("a subscriber unsubscribing another and itself when told an interface was added")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        auto first = std::make_shared<Meddler>();
+        auto second = std::make_shared<Meddler>();
+        monitor.subscribe(absent, first, addressesOnly(), only(InterfaceEvent::Added));
+        monitor.subscribe(absent, second, addressesOnly(), only(InterfaceEvent::Added));
+        first->meddle = [&] {
+            monitor.unsubscribe(second);
+            monitor.unsubscribe(first);
+        };
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        CHECK(first->calls == 1);
+        CHECK(second->calls == 0);
+        CHECK(first.use_count() == 1);
+        CHECK(second.use_count() == 1);
+
+        peer.feed(link(RTM_NEWLINK, 3, "eth1").datagram());
+        CHECK(first->calls == 1);
+        CHECK(second->calls == 0);
+    }
+
+    TEST_CASE("a subscriber unsubscribing another and itself when told an interface was removed")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        peer.feed(link(RTM_NEWLINK, 3, "eth1").datagram());
+        auto first = std::make_shared<Meddler>();
+        auto second = std::make_shared<Meddler>();
+        monitor.subscribe({Interface {3, "eth1"}}, first, addressesOnly(), only(InterfaceEvent::Removed));
+        monitor.subscribe({Interface {2, "eth0"}}, second, addressesOnly(), InterfaceEvents {});
+        first->meddle = [&] {
+            monitor.unsubscribe(second);
+            monitor.unsubscribe(first);
+        };
+        first->calls = 0;
+        second->calls = 0;
+        peer.feed(link(RTM_DELLINK, 2, "eth0").datagram());
+        CHECK(first->calls == 1);
+        CHECK(second->calls == 0);
+        CHECK(first.use_count() == 1);
+        CHECK(second.use_count() == 1);
+
+        peer.feed(link(RTM_DELLINK, 3, "eth1").datagram());
+        CHECK(first->calls == 1);
+    }
+
+    TEST_CASE("a subscriber unsubscribing another and itself when told a change")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        const Interfaces eth0 {Interface {2, "eth0"}};
+        auto first = std::make_shared<Meddler>();
+        auto second = std::make_shared<Meddler>();
+        monitor.subscribe(eth0, first, addressesOnly(), InterfaceEvents {});
+        monitor.subscribe(eth0, second, addressesOnly(), InterfaceEvents {});
+        first->calls = 0;
+        second->calls = 0;
+        first->meddle = [&] {
+            monitor.unsubscribe(second);
+            monitor.unsubscribe(first);
+        };
+        peer.feed(address(2, 1).datagram());
+        CHECK(first->calls == 1);
+        CHECK(second->calls == 0);
+        CHECK(first.use_count() == 1);
+        CHECK(second.use_count() == 1);
+
+        peer.feed(address(2, 2).datagram());
+        CHECK(first->calls == 1);
+        CHECK(second->calls == 0);
+    }
+
+    TEST_CASE("a subscriber unsubscribed and dropped by its owner while told outlives the call")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        std::vector<std::string> log;
+        std::map<int, SubscriberPtr> owner;
+        {
+            auto recorder = std::make_shared<Recorder>(log);
+            recorder->meddle = [] {};
+            owner.emplace(1, recorder);
+            monitor.subscribe({Interface {2, "eth0"}}, recorder, addressesOnly(), InterfaceEvents {});
+            recorder->meddle = [&] {
+                monitor.unsubscribe(owner.at(1));
+                owner.clear();
+            };
+        }
+        log.clear();
+        peer.feed(address(2, 1).datagram());
+        CHECK(log == std::vector<std::string> {"told", "destroyed"});
+    }
+
+    TEST_CASE("a subscriber leaving and subscribing again while told stays subscribed")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        auto subscriber = std::make_shared<Meddler>();
+        monitor.subscribe(absent, subscriber, addressesOnly(), only(InterfaceEvent::Added));
+        subscriber->meddle = [&] {
+            monitor.unsubscribe(subscriber);
+            monitor.subscribe(absent, subscriber, addressesOnly(), only(InterfaceEvent::Added));
+        };
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        peer.feed(link(RTM_NEWLINK, 3, "eth1").datagram());
+        CHECK(subscriber->calls == 2);
+    }
+
+    TEST_CASE("a coroutine changing the interface it waited for when resumed leaves the change to be notified")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        auto subscriber = std::make_shared<Meddler>();
+        monitor.subscribe({Interface {2, "eth0"}}, subscriber, addressesOnly(), InterfaceEvents {});
+        subscriber->calls = 0;
+        auto second = address(2, 2);
+        std::vector<ChangedFlags> seen;
+        const auto task = driveWhenChanged(monitor, peer, Interface {2, "eth0"}, second.datagram(), seen);
+        peer.feed(address(2, 1).datagram());
+        CHECK(task.done());
+        CHECK(seen == std::vector<ChangedFlags> {addressesOnly()});
+        CHECK(subscriber->calls == 2);
+    }
+
+    TEST_CASE("a coroutine removing the interface it waited for when resumed")
+    {
+        RuntimeFlags flags;
+        flags.set(RuntimeFlag::PublishSnapshots);
+        NetworkMonitor monitor {flags};
+        NetworkMonitorTestPeer peer {monitor};
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        auto removal = link(RTM_DELLINK, 2, "eth0");
+        std::vector<ChangedFlags> seen;
+        std::optional<InterfaceChange> other;
+        const auto task = driveWhenChanged(monitor, peer, Interface {2, "eth0"}, removal.datagram(), seen);
+        const auto waiting = waitOnce(monitor, Interface {2, "eth0"}, other);
+        peer.feed(address(2, 1).datagram());
+        CHECK(task.done());
+        CHECK(seen == std::vector<ChangedFlags> {addressesOnly()});
+        REQUIRE(other.has_value());
+        CHECK(other->tracker == nullptr);
+        CHECK_FALSE(monitor.snapshots()->find(2).has_value());
+    }
+
+    TEST_CASE("an interface is matched anew when its link flags change")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        auto subscriber = std::make_shared<Meddler>();
+        LinkFlags up;
+        up.set(LinkFlag::Up);
+        monitor.subscribeMatching(
+            {InterfacePattern {.requiredFlags = up}}, subscriber, addressesOnly(), InterfaceEvents {});
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        peer.feed(address(2, 1).datagram());
+        CHECK(subscriber->calls == 0);
+        // told the addresses it has once matched, although only its link flags changed
+        peer.feed(link(RTM_NEWLINK, 2, "eth0", IFF_UP).datagram());
+        CHECK(subscriber->calls == 1);
+        peer.feed(address(2, 2).datagram());
+        CHECK(subscriber->calls == 2);
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        peer.feed(address(2, 3).datagram());
+        CHECK(subscriber->calls == 2);
+    }
+
+    TEST_CASE("a renamed interface is matched anew")
+    {
+        NetworkMonitor monitor {RuntimeFlags {}};
+        NetworkMonitorTestPeer peer {monitor};
+        auto subscriber = std::make_shared<Meddler>();
+        monitor.subscribeMatching({InterfacePattern {.name = "eth*"}}, subscriber, addressesOnly(), InterfaceEvents {});
+        peer.feed(link(RTM_NEWLINK, 2, "wlan0").datagram());
+        peer.feed(address(2, 1).datagram());
+        CHECK(subscriber->calls == 0);
+        peer.feed(link(RTM_NEWLINK, 2, "eth0").datagram());
+        CHECK(subscriber->calls == 1);
+        peer.feed(link(RTM_NEWLINK, 2, "wlan0").datagram());
+        peer.feed(address(2, 2).datagram());
+        CHECK(subscriber->calls == 1);
+    }
+}
+// NOLINTEND(*)
+}  // namespace
@@ -0,0 +1,40 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+#include <bit>
+
+#include <monitor/ReceiveBufferPolicy.hpp>
+
+namespace monkas::monitor
+{
+
+ReceiveBufferPolicy::ReceiveBufferPolicy(const std::size_t floor, const std::size_t ceiling)
+    : m_floor {std::min(floor, ceiling)}
+    , m_ceiling {ceiling}
+{
+}
+
+auto ReceiveBufferPolicy::sizeFor(const std::size_t datagramSize) const -> std::size_t
+{
+    return std::clamp(std::bit_ceil(datagramSize), m_floor, m_ceiling);
+}
+
+auto ReceiveBufferPolicy::observe(const std::size_t currentSize, const std::size_t datagramSize)
+    -> std::optional<std::size_t>
+{
+    m_highWater = std::max(m_highWater, datagramSize);
+    if (++m_observed < SHRINK_WINDOW) {
+        return std::nullopt;
+    }
+    const auto wanted = sizeFor(m_highWater);
+    m_highWater = 0;
+    m_observed = 0;
+    // only shrink if at most half of the buffer was used, avoids flapping between two sizes
+    if (wanted * 2 <= currentSize) {
+        return wanted;
+    }
+    return std::nullopt;
+}
+
+}  // namespace monkas::monitor
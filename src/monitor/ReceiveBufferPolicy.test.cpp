@@ -0,0 +1,63 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <doctest/doctest.h>
+#include <monitor/ReceiveBufferPolicy.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+
+constexpr std::size_t FLOOR = 8 * 1024;
+constexpr std::size_t CEILING = 64 * 1024;
+
+TEST_SUITE("[monitor::ReceiveBufferPolicy]")
+{
+    TEST_CASE("sizes are clamped between floor and ceiling")
+    {
+        const ReceiveBufferPolicy policy {FLOOR, CEILING};
+        CHECK(policy.sizeFor(1) == FLOOR);
+        CHECK(policy.sizeFor(FLOOR + 1) == 2 * FLOOR);
+        CHECK(policy.sizeFor(CEILING * 4) == CEILING);
+    }
+
+    TEST_CASE("floor above ceiling is clamped")
+    {
+        const ReceiveBufferPolicy policy {CEILING * 2, CEILING};
+        CHECK(policy.floor() == CEILING);
+        CHECK(policy.sizeFor(1) == CEILING);
+    }
+
+    TEST_CASE("peeking only while the buffer can still grow")
+    {
+        const ReceiveBufferPolicy policy {FLOOR, CEILING};
+        CHECK(policy.shouldPeek(FLOOR));
+        CHECK_FALSE(policy.shouldPeek(CEILING));
+    }
+
+    TEST_CASE("shrinks after a window of small datagrams")
+    {
+        ReceiveBufferPolicy policy {FLOOR, CEILING};
+        for (uint32_t i = 1; i < ReceiveBufferPolicy::SHRINK_WINDOW; ++i) {
+            CHECK_FALSE(policy.observe(CEILING, 512).has_value());
+        }
+        const auto shrinkTo = policy.observe(CEILING, 512);
+        REQUIRE(shrinkTo.has_value());
+        CHECK(shrinkTo.value() == FLOOR);
+    }
+
+    TEST_CASE("does not shrink when more than half of the buffer was used")
+    {
+        ReceiveBufferPolicy policy {FLOOR, CEILING};
+        std::optional<std::size_t> shrinkTo;
+        for (uint32_t i = 0; i < ReceiveBufferPolicy::SHRINK_WINDOW; ++i) {
+            shrinkTo = policy.observe(2 * FLOOR, i == 0 ? FLOOR + 1 : 512);
+        }
+        CHECK_FALSE(shrinkTo.has_value());
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
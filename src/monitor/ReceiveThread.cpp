@@ -0,0 +1,156 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include <monitor/ReceiveThread.hpp>
+#include <poll.h>
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace monkas::monitor
+{
+
+ReceiveThread::ReceiveThread(const int socketFd, const std::size_t depth, const std::size_t bufferSize, Receive receive)
+    : m_ring(depth,
+             Datagram {
+                 .buffer = std::vector<uint8_t>(bufferSize), .size = 0, .error = 0, .nsid = 0, .readableSince = {}})
+    , m_receive {std::move(receive)}
+    , m_socketFd {socketFd}
+{
+}
+
+auto ReceiveThread::create(const int socketFd, const std::size_t depth, const std::size_t bufferSize, Receive receive)
+    -> std::unique_ptr<ReceiveThread>
+{
+    auto thread = std::unique_ptr<ReceiveThread>(new ReceiveThread(socketFd, depth, bufferSize, std::move(receive)));
+    thread->m_readyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    thread->m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (thread->m_readyFd < 0 || thread->m_stopFd < 0) {
+        spdlog::warn("eventfd failed: {}", std::strerror(errno));
+        return nullptr;
+    }
+    thread->m_thread = std::thread([self = thread.get()] { self->receiveLoop(); });
+    pthread_setname_np(thread->m_thread.native_handle(), "monkas-receive");
+    spdlog::debug("Receiving on a thread of its own into a ring of {} buffers", thread->m_ring.capacity());
+    return thread;
+}
+
+ReceiveThread::~ReceiveThread()
+{
+    stop();
+    if (m_readyFd >= 0) {
+        close(m_readyFd);
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+    }
+}
+
+void ReceiveThread::stop()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+    m_stopping = true;
+    const uint64_t wakeup = 1;
+    std::ignore = write(m_stopFd, &wakeup, sizeof(wakeup));
+    m_consumed.fetch_add(1);
+    m_consumed.notify_one();
+    m_thread.join();
+}
+
+/**
+ * @brief Rechecks the ring after clearing fileDescriptor(), a datagram queued meanwhile signalled it before.
+ *
+ * Pairs with the fence in receiveLoop(): either the thread sees the ring empty after queueing and signals, or the
+ * recheck sees the datagram.
+ */
+auto ReceiveThread::front() -> const Datagram*
+{
+    if (const auto* datagram = m_ring.consumerSlot(); datagram != nullptr) {
+        return datagram;
+    }
+    uint64_t signalled = 0;
+    std::ignore = read(m_readyFd, &signalled, sizeof(signalled));
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return m_ring.consumerSlot();
+}
+
+void ReceiveThread::pop()
+{
+    m_ring.pop();
+    m_consumed.fetch_add(1, std::memory_order_release);
+    m_consumed.notify_one();
+}
+
+void ReceiveThread::wakeUpIfPending()
+{
+    if (m_ring.size() > 0) {
+        signalReady();
+    }
+}
+
+void ReceiveThread::signalReady() const
+{
+    const uint64_t ready = 1;
+    std::ignore = write(m_readyFd, &ready, sizeof(ready));
+}
+
+void ReceiveThread::waitUntilReadable()
+{
+    std::array<pollfd, 2> fds {{{.fd = m_socketFd, .events = POLLIN, .revents = 0},
+                                {.fd = m_stopFd, .events = POLLIN, .revents = 0}}};
+    if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+        spdlog::error("poll failed on the receive thread: {}", std::strerror(errno));
+    }
+}
+
+void ReceiveThread::receiveLoop()
+{
+    std::optional<std::chrono::steady_clock::time_point> readableSince;
+    while (!m_stopping.load()) {
+        auto* slot = m_ring.producerSlot();
+        if (slot == nullptr) {
+            const auto consumed = m_consumed.load(std::memory_order_acquire);
+            if (m_ring.producerSlot() == nullptr) {
+                m_stalls.fetch_add(1, std::memory_order_relaxed);
+                m_consumed.wait(consumed);
+            }
+            continue;
+        }
+        const auto size = m_receive(slot->buffer, slot->nsid);
+        const auto err = size < 0 ? errno : 0;
+        if (err == EINTR) {
+            continue;
+        }
+        if (size == 0 || err == EAGAIN) {
+            readableSince.reset();
+            waitUntilReadable();
+            continue;
+        }
+        if (!readableSince.has_value()) {
+            readableSince = std::chrono::steady_clock::now();
+        }
+        slot->size = size;
+        slot->error = err;
+        slot->readableSince = readableSince.value();
+        m_ring.push();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto depth = m_ring.size();
+        if (depth <= 1) {
+            signalReady();
+        }
+        if (depth > m_highWaterMark.load(std::memory_order_relaxed)) {
+            m_highWaterMark.store(depth, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace monkas::monitor
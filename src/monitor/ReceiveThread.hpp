@@ -0,0 +1,102 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+#include <util/SpscRing.hpp>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Drains a socket on a thread of its own into a ring of pooled buffers, for another thread to process.
+ *
+ * A slow consumer no longer keeps the socket from being drained, datagrams queue up in the ring instead of the socket
+ * receive queue. Once the ring is full the thread stalls until the consumer hands a buffer back.
+ */
+class ReceiveThread
+{
+  public:
+    // receives the next datagram into the buffer without blocking, returns like recv() and sets the nsid it came from
+    using Receive = std::function<ssize_t(std::vector<uint8_t>& buffer, int32_t& nsid)>;
+
+    struct Datagram
+    {
+        std::vector<uint8_t> buffer;
+        // the size of the datagram, or -1 if receiving failed with error
+        ssize_t size {};
+        int error {};
+        // the nsid the datagram came from, as set by the receive function
+        int32_t nsid {};
+        // when the thread first saw the socket readable without seeing it empty since
+        std::chrono::steady_clock::time_point readableSince;
+    };
+
+    /* @note: returns nullptr if the thread could not be set up */
+    static auto create(int socketFd, std::size_t depth, std::size_t bufferSize, Receive receive)
+        -> std::unique_ptr<ReceiveThread>;
+
+    ~ReceiveThread();
+    ReceiveThread(const ReceiveThread&) = delete;
+    ReceiveThread(ReceiveThread&&) = delete;
+    auto operator=(const ReceiveThread&) -> ReceiveThread& = delete;
+    auto operator=(ReceiveThread&&) -> ReceiveThread& = delete;
+
+    // stops receiving and joins the thread, the queued datagrams stay valid
+    void stop();
+
+    /* @note: readable while datagrams are queued, e.g. for epoll */
+    [[nodiscard]] auto fileDescriptor() const -> int { return m_readyFd; }
+
+    /**
+     * @brief The next queued datagram, nullptr if there is none, consumer only.
+     *
+     * Finding the ring empty clears fileDescriptor(), the datagram stays valid until pop().
+     */
+    [[nodiscard]] auto front() -> const Datagram*;
+    void pop();
+    // keeps fileDescriptor() readable for datagrams left queued, e.g. once a budget was used up
+    void wakeUpIfPending();
+
+    [[nodiscard]] auto depth() const -> std::size_t { return m_ring.size(); }
+
+    [[nodiscard]] auto capacity() const -> std::size_t { return m_ring.capacity(); }
+
+    [[nodiscard]] auto highWaterMark() const -> std::size_t { return m_highWaterMark.load(std::memory_order_relaxed); }
+
+    // how often the thread found the ring full and had to wait for the consumer
+    [[nodiscard]] auto stalls() const -> uint64_t { return m_stalls.load(std::memory_order_relaxed); }
+
+  private:
+    ReceiveThread(int socketFd, std::size_t depth, std::size_t bufferSize, Receive receive);
+
+    void receiveLoop();
+    void waitUntilReadable();
+    void signalReady() const;
+
+    util::SpscRing<Datagram> m_ring;
+    Receive m_receive;
+    int m_socketFd;
+    // an eventfd the thread signals once it queued a datagram into the empty ring
+    int m_readyFd {-1};
+    // wakes up the thread waiting for the socket to stop it
+    int m_stopFd {-1};
+    std::atomic<bool> m_stopping {false};
+    // bumped by pop() and stop, the thread waits on it while the ring is full
+    std::atomic<uint32_t> m_consumed {0};
+    std::atomic<std::size_t> m_highWaterMark {0};
+    std::atomic<uint64_t> m_stalls {0};
+    std::thread m_thread;
+};
+
+}  // namespace monkas::monitor
@@ -0,0 +1,144 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <monitor/ReceiveThread.hpp>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+
+constexpr std::size_t BUFFER_SIZE = 64;
+
+class SocketPair
+{
+  public:
+    SocketPair() { REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, m_fds.data()) == 0); }
+
+    ~SocketPair()
+    {
+        close(m_fds[0]);
+        close(m_fds[1]);
+    }
+
+    void send(const std::string_view payload) const
+    {
+        REQUIRE(::send(m_fds[0], payload.data(), payload.size(), 0) == static_cast<ssize_t>(payload.size()));
+    }
+
+    [[nodiscard]] auto receiving() const -> int { return m_fds[1]; }
+
+    [[nodiscard]] auto receive() const -> ReceiveThread::Receive
+    {
+        return [fd = m_fds[1]](std::vector<uint8_t>& buffer, int32_t& /*nsid*/)
+        {
+            const auto received = recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT | MSG_TRUNC);
+            if (received > static_cast<ssize_t>(buffer.size())) {
+                errno = ENOSPC;
+                return ssize_t {-1};
+            }
+            return received;
+        };
+    }
+
+  private:
+    std::array<int, 2> m_fds {};
+};
+
+// waits for the thread to queue a datagram, like the monitor does through epoll
+auto next(ReceiveThread& thread) -> const ReceiveThread::Datagram*
+{
+    for (;;) {
+        if (const auto* datagram = thread.front(); datagram != nullptr) {
+            return datagram;
+        }
+        pollfd ready {.fd = thread.fileDescriptor(), .events = POLLIN, .revents = 0};
+        REQUIRE(poll(&ready, 1, 5000) == 1);
+    }
+}
+
+auto asString(const ReceiveThread::Datagram& datagram) -> std::string
+{
+    return {reinterpret_cast<const char*>(datagram.buffer.data()), static_cast<std::size_t>(datagram.size)};
+}
+
+TEST_SUITE("[monitor::ReceiveThread]")
+{
+    TEST_CASE("datagrams are queued in order")
+    {
+        const SocketPair pair;
+        const auto thread = ReceiveThread::create(pair.receiving(), 4, BUFFER_SIZE, pair.receive());
+        REQUIRE(thread != nullptr);
+        CHECK(thread->capacity() == 4);
+        pair.send("first");
+        pair.send("second");
+        CHECK(asString(*next(*thread)) == "first");
+        thread->pop();
+        CHECK(asString(*next(*thread)) == "second");
+        thread->pop();
+        CHECK(thread->front() == nullptr);
+    }
+
+    TEST_CASE("a full ring stalls the thread without losing datagrams")
+    {
+        const SocketPair pair;
+        const auto thread = ReceiveThread::create(pair.receiving(), 2, BUFFER_SIZE, pair.receive());
+        REQUIRE(thread != nullptr);
+        for (int i = 0; i < 10; ++i) {
+            pair.send(std::to_string(i));
+        }
+        std::vector<std::string> received;
+        for (int i = 0; i < 10; ++i) {
+            received.push_back(asString(*next(*thread)));
+            thread->pop();
+        }
+        CHECK(received == std::vector<std::string> {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"});
+        CHECK(thread->stalls() > 0);
+        CHECK(thread->highWaterMark() == 2);
+    }
+
+    TEST_CASE("receive errors are queued with the datagrams")
+    {
+        const SocketPair pair;
+        const auto thread = ReceiveThread::create(pair.receiving(), 4, BUFFER_SIZE, pair.receive());
+        REQUIRE(thread != nullptr);
+        pair.send(std::string(BUFFER_SIZE + 1, 'x'));
+        pair.send("next");
+        const auto* truncated = next(*thread);
+        CHECK(truncated->size == -1);
+        CHECK(truncated->error == ENOSPC);
+        thread->pop();
+        CHECK(asString(*next(*thread)) == "next");
+        thread->pop();
+    }
+
+    TEST_CASE("the descriptor stays readable for datagrams left queued")
+    {
+        const SocketPair pair;
+        const auto thread = ReceiveThread::create(pair.receiving(), 4, BUFFER_SIZE, pair.receive());
+        REQUIRE(thread != nullptr);
+        pair.send("first");
+        pair.send("second");
+        std::ignore = next(*thread);
+        thread->pop();
+        std::ignore = next(*thread);
+        thread->wakeUpIfPending();
+        pollfd ready {.fd = thread->fileDescriptor(), .events = POLLIN, .revents = 0};
+        CHECK(poll(&ready, 1, 0) == 1);
+        thread->pop();
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
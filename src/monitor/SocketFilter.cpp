@@ -0,0 +1,146 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <arpa/inet.h>
+#include <linux/if_arp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <monitor/SocketFilter.hpp>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+
+namespace monkas::monitor
+{
+namespace
+{
+constexpr uint32_t ACCEPT = 0xFFFFFFFFU;
+constexpr uint32_t DROP = 0U;
+
+// offsets of the fields the program looks at, relative to the start of the datagram
+constexpr uint32_t NLMSG_TYPE_OFFSET = 4;
+constexpr uint32_t NLMSG_PID_OFFSET = 12;
+constexpr uint32_t PAYLOAD_OFFSET = NLMSG_HDRLEN;
+constexpr uint32_t IFI_TYPE_OFFSET = PAYLOAD_OFFSET + 2;
+constexpr uint32_t IFA_FAMILY_OFFSET = PAYLOAD_OFFSET;
+constexpr uint32_t IFA_INDEX_OFFSET = PAYLOAD_OFFSET + 4;
+constexpr uint32_t RTM_FAMILY_OFFSET = PAYLOAD_OFFSET;
+constexpr uint32_t RTM_DST_LEN_OFFSET = PAYLOAD_OFFSET + 1;
+constexpr uint32_t RTM_TABLE_OFFSET = PAYLOAD_OFFSET + 4;
+
+constexpr auto stmt(const uint16_t code, const uint32_t k) -> sock_filter
+{
+    return {code, 0, 0, k};
+}
+
+constexpr auto jump(const uint16_t code, const uint32_t k, const uint8_t jt, const uint8_t jf) -> sock_filter
+{
+    return {code, jt, jf, k};
+}
+
+// drops the datagram unless A equals k
+void requireEqual(std::vector<sock_filter>& block, const uint32_t k)
+{
+    block.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, k, 1, 0));
+    block.push_back(stmt(BPF_RET | BPF_K, DROP));
+}
+}  // namespace
+
+SocketFilter::SocketFilter(const Options& options)
+{
+    addPortIdCheck(options.portid);
+    addMessageTypeBlock(RTM_NEWLINK, RTM_DELLINK, linkBlock(options));
+    addMessageTypeBlock(RTM_NEWADDR, RTM_DELADDR, addressBlock(options));
+    addMessageTypeBlock(RTM_NEWROUTE, RTM_DELROUTE, routeBlock(options));
+    m_instructions.push_back(stmt(BPF_RET | BPF_K, ACCEPT));
+}
+
+auto SocketFilter::attachTo(const int fd) const -> bool
+{
+    const sock_fprog program {static_cast<unsigned short>(m_instructions.size()),
+                              const_cast<sock_filter*>(m_instructions.data())};  // NOLINT(*-const-cast)
+    return setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) == 0;
+}
+
+void SocketFilter::addPortIdCheck(const uint32_t portid)
+{
+    m_instructions.push_back(stmt(BPF_LD | BPF_W | BPF_ABS, NLMSG_PID_OFFSET));
+    m_instructions.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, htonl(portid), 0, 1));
+    m_instructions.push_back(stmt(BPF_RET | BPF_K, ACCEPT));
+}
+
+/**
+ * @brief Runs the block for messages of either type and skips it otherwise.
+ *
+ * Every block ends with a return, so control never falls through into the next block.
+ */
+void SocketFilter::addMessageTypeBlock(const uint16_t newType,
+                                       const uint16_t delType,
+                                       const std::vector<sock_filter>& block)
+{
+    if (block.empty()) {
+        return;
+    }
+    m_instructions.push_back(stmt(BPF_LD | BPF_H | BPF_ABS, NLMSG_TYPE_OFFSET));
+    m_instructions.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, htons(newType), 1, 0));
+    m_instructions.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, htons(delType), 0, static_cast<uint8_t>(block.size())));
+    m_instructions.insert(m_instructions.end(), block.begin(), block.end());
+}
+
+auto SocketFilter::linkBlock(const Options& options) -> std::vector<sock_filter>
+{
+    if (options.includeNonIeee802) {
+        return {};
+    }
+    return {
+        stmt(BPF_LD | BPF_H | BPF_ABS, IFI_TYPE_OFFSET),
+        jump(BPF_JMP | BPF_JEQ | BPF_K, htons(ARPHRD_ETHER), 1, 0),
+        jump(BPF_JMP | BPF_JEQ | BPF_K, htons(ARPHRD_IEEE80211), 0, 1),
+        stmt(BPF_RET | BPF_K, ACCEPT),
+        stmt(BPF_RET | BPF_K, DROP),
+    };
+}
+
+auto SocketFilter::addressBlock(const Options& options) -> std::vector<sock_filter>
+{
+    std::vector<sock_filter> block;
+    if (options.addressFamily.has_value()) {
+        block.push_back(stmt(BPF_LD | BPF_B | BPF_ABS, IFA_FAMILY_OFFSET));
+        requireEqual(block, options.addressFamily.value());
+    }
+    if (options.ifIndexes.size() > MAX_INTERFACES) {
+        spdlog::debug("Not filtering address messages by {} interfaces", options.ifIndexes.size());
+    } else if (!options.ifIndexes.empty()) {
+        block.push_back(stmt(BPF_LD | BPF_W | BPF_ABS, IFA_INDEX_OFFSET));
+        // each match jumps over the remaining comparisons and the drop to the accept
+        auto remaining = options.ifIndexes.size();
+        for (const auto ifIndex : options.ifIndexes) {
+            block.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, htonl(ifIndex), static_cast<uint8_t>(remaining), 0));
+            --remaining;
+        }
+        block.push_back(stmt(BPF_RET | BPF_K, DROP));
+    }
+    if (!block.empty()) {
+        block.push_back(stmt(BPF_RET | BPF_K, ACCEPT));
+    }
+    return block;
+}
+
+auto SocketFilter::routeBlock(const Options& options) -> std::vector<sock_filter>
+{
+    if (!options.routes) {
+        return {stmt(BPF_RET | BPF_K, DROP)};
+    }
+    std::vector<sock_filter> block;
+    block.push_back(stmt(BPF_LD | BPF_B | BPF_ABS, RTM_FAMILY_OFFSET));
+    requireEqual(block, AF_INET);
+    if (options.defaultRoutesOnly) {
+        block.push_back(stmt(BPF_LD | BPF_B | BPF_ABS, RTM_DST_LEN_OFFSET));
+        requireEqual(block, 0);
+        block.push_back(stmt(BPF_LD | BPF_B | BPF_ABS, RTM_TABLE_OFFSET));
+        requireEqual(block, RT_TABLE_MAIN);
+    }
+    block.push_back(stmt(BPF_RET | BPF_K, ACCEPT));
+    return block;
+}
+
+}  // namespace monkas::monitor
@@ -0,0 +1,58 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include <linux/filter.h>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Classic BPF program dropping rtnetlink messages the NetworkMonitor would discard anyway.
+ *
+ * The program only looks at the first message of a datagram, which is the only one for change notifications. Replies to
+ * our own requests are always accepted, as dumps pack many messages into a datagram. Netlink headers are in host byte
+ * order while BPF loads are big endian, so constants are converted with htons/htonl. Route messages cannot be filtered
+ * by interface, as RTA_OIF has no fixed offset.
+ */
+class SocketFilter
+{
+  public:
+    // keeps every jump of the interface list within the 8 bit jump offsets of classic BPF
+    static constexpr std::size_t MAX_INTERFACES = 128;
+
+    struct Options
+    {
+        uint32_t portid {};
+        bool includeNonIeee802 {false};
+        std::optional<uint8_t> addressFamily;
+        bool routes {true};
+        bool defaultRoutesOnly {false};
+        // address messages of other interfaces are dropped, empty accepts all of them
+        std::set<uint32_t> ifIndexes;
+    };
+
+    explicit SocketFilter(const Options& options);
+
+    [[nodiscard]] auto instructions() const -> const std::vector<sock_filter>& { return m_instructions; }
+
+    /* @note: replaces a filter attached before */
+    [[nodiscard]] auto attachTo(int fd) const -> bool;
+
+  private:
+    void addPortIdCheck(uint32_t portid);
+    void addMessageTypeBlock(uint16_t newType, uint16_t delType, const std::vector<sock_filter>& block);
+    static auto linkBlock(const Options& options) -> std::vector<sock_filter>;
+    static auto addressBlock(const Options& options) -> std::vector<sock_filter>;
+    static auto routeBlock(const Options& options) -> std::vector<sock_filter>;
+
+    std::vector<sock_filter> m_instructions;
+};
+
+}  // namespace monkas::monitor
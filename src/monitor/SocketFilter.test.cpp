@@ -0,0 +1,159 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <cstring>
+
+#include <doctest/doctest.h>
+#include <linux/if_arp.h>
+#include <linux/rtnetlink.h>
+#include <monitor/SocketFilter.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+
+constexpr uint32_t OUR_PORTID = 4242;
+constexpr uint32_t OTHER_PORTID = 1337;
+
+// runs the filter by sending a datagram through a socket pair, the filter is attached to the receiving end
+class FilteredSocketPair
+{
+  public:
+    explicit FilteredSocketPair(const SocketFilter& filter)
+    {
+        REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM, 0, m_fds.data()) == 0);
+        REQUIRE(filter.attachTo(m_fds[1]));
+    }
+
+    ~FilteredSocketPair()
+    {
+        close(m_fds[0]);
+        close(m_fds[1]);
+    }
+
+    template<typename Payload>
+    auto passes(const uint16_t type, const Payload& payload, const uint32_t portid = OTHER_PORTID) -> bool
+    {
+        std::array<uint8_t, NLMSG_SPACE(sizeof(Payload))> datagram {};
+        nlmsghdr header {};
+        header.nlmsg_len = datagram.size();
+        header.nlmsg_type = type;
+        header.nlmsg_pid = portid;
+        std::memcpy(datagram.data(), &header, sizeof(header));
+        std::memcpy(datagram.data() + NLMSG_HDRLEN, &payload, sizeof(payload));
+        REQUIRE(send(m_fds[0], datagram.data(), datagram.size(), 0) == static_cast<ssize_t>(datagram.size()));
+        std::array<uint8_t, 256> received {};
+        return recv(m_fds[1], received.data(), received.size(), MSG_DONTWAIT) == static_cast<ssize_t>(datagram.size());
+    }
+
+  private:
+    std::array<int, 2> m_fds {};
+};
+
+auto link(const uint16_t type) -> ifinfomsg
+{
+    ifinfomsg ifi {};
+    ifi.ifi_type = type;
+    return ifi;
+}
+
+auto address(const uint8_t family, const uint32_t ifIndex) -> ifaddrmsg
+{
+    ifaddrmsg ifa {};
+    ifa.ifa_family = family;
+    ifa.ifa_index = ifIndex;
+    return ifa;
+}
+
+auto route(const uint8_t family, const uint8_t dstLen, const uint8_t table) -> rtmsg
+{
+    rtmsg rtm {};
+    rtm.rtm_family = family;
+    rtm.rtm_dst_len = dstLen;
+    rtm.rtm_table = table;
+    return rtm;
+}
+
+auto defaultOptions() -> SocketFilter::Options
+{
+    SocketFilter::Options options;
+    options.portid = OUR_PORTID;
+    return options;
+}
+
+TEST_SUITE("[monitor::SocketFilter]")
+{
+    TEST_CASE("non IEEE 802 links are dropped unless included")
+    {
+        auto options = defaultOptions();
+        FilteredSocketPair excluding {SocketFilter {options}};
+        CHECK(excluding.passes(RTM_NEWLINK, link(ARPHRD_ETHER)));
+        CHECK(excluding.passes(RTM_DELLINK, link(ARPHRD_IEEE80211)));
+        CHECK_FALSE(excluding.passes(RTM_NEWLINK, link(ARPHRD_LOOPBACK)));
+        CHECK_FALSE(excluding.passes(RTM_DELLINK, link(ARPHRD_NONE)));
+
+        options.includeNonIeee802 = true;
+        FilteredSocketPair including {SocketFilter {options}};
+        CHECK(including.passes(RTM_NEWLINK, link(ARPHRD_LOOPBACK)));
+    }
+
+    TEST_CASE("addresses are filtered by family and interface")
+    {
+        auto options = defaultOptions();
+        FilteredSocketPair all {SocketFilter {options}};
+        CHECK(all.passes(RTM_NEWADDR, address(AF_INET6, 7)));
+
+        options.addressFamily = AF_INET;
+        options.ifIndexes = {2, 7};
+        FilteredSocketPair filtered {SocketFilter {options}};
+        CHECK(filtered.passes(RTM_NEWADDR, address(AF_INET, 2)));
+        CHECK(filtered.passes(RTM_DELADDR, address(AF_INET, 7)));
+        CHECK_FALSE(filtered.passes(RTM_NEWADDR, address(AF_INET6, 2)));
+        CHECK_FALSE(filtered.passes(RTM_NEWADDR, address(AF_INET, 3)));
+    }
+
+    TEST_CASE("routes are filtered by family and destination")
+    {
+        auto options = defaultOptions();
+        FilteredSocketPair all {SocketFilter {options}};
+        CHECK(all.passes(RTM_NEWROUTE, route(AF_INET, 24, RT_TABLE_MAIN)));
+        CHECK_FALSE(all.passes(RTM_NEWROUTE, route(AF_INET6, 0, RT_TABLE_MAIN)));
+
+        options.defaultRoutesOnly = true;
+        FilteredSocketPair defaults {SocketFilter {options}};
+        CHECK(defaults.passes(RTM_DELROUTE, route(AF_INET, 0, RT_TABLE_MAIN)));
+        CHECK_FALSE(defaults.passes(RTM_NEWROUTE, route(AF_INET, 24, RT_TABLE_MAIN)));
+        CHECK_FALSE(defaults.passes(RTM_NEWROUTE, route(AF_INET, 0, RT_TABLE_LOCAL)));
+
+        options.routes = false;
+        FilteredSocketPair none {SocketFilter {options}};
+        CHECK_FALSE(none.passes(RTM_NEWROUTE, route(AF_INET, 0, RT_TABLE_MAIN)));
+    }
+
+    TEST_CASE("replies to our requests and unknown messages pass")
+    {
+        auto options = defaultOptions();
+        options.routes = false;
+        FilteredSocketPair pair {SocketFilter {options}};
+        CHECK(pair.passes(RTM_NEWROUTE, route(AF_INET6, 64, RT_TABLE_LOCAL), OUR_PORTID));
+        CHECK(pair.passes(RTM_NEWNEIGH, ndmsg {}));
+    }
+
+    TEST_CASE("too many interfaces disable filtering by interface")
+    {
+        auto options = defaultOptions();
+        for (uint32_t ifIndex = 1; ifIndex <= SocketFilter::MAX_INTERFACES + 1; ++ifIndex) {
+            options.ifIndexes.insert(ifIndex);
+        }
+        FilteredSocketPair pair {SocketFilter {options}};
+        CHECK(pair.passes(RTM_NEWADDR, address(AF_INET, 1000)));
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
@@ -0,0 +1,261 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <linux/sock_diag.h>
+#include <monitor/UringReceiver.hpp>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+
+#ifdef MONKAS_WITH_IO_URING
+#    include <liburing.h>
+#endif
+
+namespace monkas::monitor
+{
+
+#ifdef MONKAS_WITH_IO_URING
+
+namespace
+{
+// must be a power of two
+constexpr unsigned BUFFER_COUNT = 64U;
+constexpr int BUFFER_GROUP = 0;
+// a single receive is ever armed
+constexpr unsigned SUBMISSION_ENTRIES = 2U;
+// every buffer ends up in a completion, leave room for the completion ending the receive
+constexpr unsigned COMPLETION_ENTRIES = 2U * BUFFER_COUNT;
+
+// how many datagrams the kernel dropped as the socket receive queue was full
+auto socketDrops(const int fd) -> uint32_t
+{
+    std::array<uint32_t, SK_MEMINFO_VARS> meminfo {};
+    socklen_t size = sizeof(meminfo);
+    if (getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo.data(), &size) < 0
+        || size <= SK_MEMINFO_DROPS * sizeof(uint32_t))
+    {
+        return 0;
+    }
+    return meminfo[SK_MEMINFO_DROPS];
+}
+}  // namespace
+
+struct UringReceiver::Ring
+{
+    Ring(const int fd, const std::size_t size)
+        : socketFd {fd}
+        , bufferSize {size}
+        , storage(BUFFER_COUNT * size)
+        , drops {socketDrops(fd)}
+    {
+    }
+
+    ~Ring()
+    {
+        if (buffers != nullptr) {
+            io_uring_free_buf_ring(&ring, buffers, BUFFER_COUNT, BUFFER_GROUP);
+        }
+        if (initialized) {
+            io_uring_queue_exit(&ring);
+        }
+    }
+
+    Ring(const Ring&) = delete;
+    Ring(Ring&&) = delete;
+    auto operator=(const Ring&) -> Ring& = delete;
+    auto operator=(Ring&&) -> Ring& = delete;
+
+    void provide(const uint16_t bufferId, const int offset)
+    {
+        io_uring_buf_ring_add(buffers,
+                              storage.data() + (bufferId * bufferSize),
+                              static_cast<unsigned>(bufferSize),
+                              bufferId,
+                              io_uring_buf_ring_mask(BUFFER_COUNT),
+                              offset);
+    }
+
+    auto arm() -> bool
+    {
+        auto* sqe = io_uring_get_sqe(&ring);
+        if (sqe == nullptr) {
+            errno = EBUSY;
+            return false;
+        }
+        // MSG_TRUNC makes the kernel report the full size of a datagram that did not fit
+        io_uring_prep_recv_multishot(sqe, socketFd, nullptr, 0, MSG_TRUNC);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        if (const auto submitted = io_uring_submit(&ring); submitted < 0) {
+            errno = -submitted;
+            return false;
+        }
+        armed = true;
+        return true;
+    }
+
+    io_uring ring {};
+    bool initialized {false};
+    io_uring_buf_ring* buffers {nullptr};
+    int socketFd;
+    std::size_t bufferSize;
+    std::vector<uint8_t> storage;
+    bool armed {false};
+    // the buffer of the datagram handed out last, returned to the kernel on the next receive
+    std::optional<uint16_t> pendingBuffer;
+    uint32_t drops;
+    std::size_t buffersRanOut {};
+};
+
+auto UringReceiver::create(const int socketFd, const std::size_t bufferSize) -> std::unique_ptr<UringReceiver>
+{
+    auto ring = std::make_unique<Ring>(socketFd, bufferSize);
+    io_uring_params params {};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = COMPLETION_ENTRIES;
+    if (const auto err = io_uring_queue_init_params(SUBMISSION_ENTRIES, &ring->ring, &params); err < 0) {
+        spdlog::warn("io_uring_queue_init_params failed: {}", std::strerror(-err));
+        return nullptr;
+    }
+    ring->initialized = true;
+    int err = 0;
+    ring->buffers = io_uring_setup_buf_ring(&ring->ring, BUFFER_COUNT, BUFFER_GROUP, 0, &err);
+    if (ring->buffers == nullptr) {
+        spdlog::warn("io_uring_setup_buf_ring failed: {}", std::strerror(-err));
+        return nullptr;
+    }
+    for (uint16_t bufferId = 0; bufferId < BUFFER_COUNT; ++bufferId) {
+        ring->provide(bufferId, bufferId);
+    }
+    io_uring_buf_ring_advance(ring->buffers, BUFFER_COUNT);
+    if (!ring->arm()) {
+        spdlog::warn("Arming the multishot receive failed: {}", std::strerror(errno));
+        return nullptr;
+    }
+    // kernels without multishot receives reject the request right away
+    io_uring_cqe* cqe = nullptr;
+    if (io_uring_peek_cqe(&ring->ring, &cqe) == 0 && cqe->res == -EINVAL) {
+        spdlog::warn("Kernel does not support multishot receives");
+        return nullptr;
+    }
+    return std::unique_ptr<UringReceiver>(new UringReceiver(std::move(ring)));
+}
+
+auto UringReceiver::fileDescriptor() const -> int
+{
+    return m_ring->ring.ring_fd;
+}
+
+auto UringReceiver::buffersRanOut() const -> std::size_t
+{
+    return m_ring->buffersRanOut;
+}
+
+/**
+ * @brief Picks up the next completion of the multishot receive, arming it again once it ended.
+ *
+ * The receive ends on errors, after the buffers ran out, and when the thread that armed it exits, which cancels it.
+ * The latter two are no errors, the datagrams are still queued on the socket. An ENOBUFS is only passed on if the
+ * socket dropped datagrams since the last one, otherwise it was the buffers that ran out.
+ */
+auto UringReceiver::receive(std::span<const uint8_t>& datagram) -> ssize_t
+{
+    auto& ring = *m_ring;
+    if (ring.pendingBuffer.has_value()) {
+        ring.provide(ring.pendingBuffer.value(), 0);
+        io_uring_buf_ring_advance(ring.buffers, 1);
+        ring.pendingBuffer.reset();
+    }
+    if (!ring.armed && !ring.arm()) {
+        return -1;
+    }
+    io_uring_cqe* cqe = nullptr;
+    if (io_uring_peek_cqe(&ring.ring, &cqe) != 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    const auto result = cqe->res;
+    const auto flags = cqe->flags;
+    io_uring_cqe_seen(&ring.ring, cqe);
+    if ((flags & IORING_CQE_F_BUFFER) != 0) {
+        ring.pendingBuffer = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+    if ((flags & IORING_CQE_F_MORE) == 0) {
+        // the last completion of the receive, every buffer but the pending one is back in the ring
+        ring.armed = false;
+        if (!ring.arm()) {
+            spdlog::error("Arming the multishot receive again failed: {}", std::strerror(errno));
+        }
+    }
+    if (result == -ENOBUFS) {
+        if (const auto drops = socketDrops(ring.socketFd); drops != ring.drops) {
+            ring.drops = drops;
+        } else {
+            ring.buffersRanOut++;
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+    if (result == -ECANCELED) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (result < 0) {
+        errno = -result;
+        return -1;
+    }
+    if (static_cast<std::size_t>(result) > ring.bufferSize) {
+        errno = ENOSPC;
+        return -1;
+    }
+    if (!ring.pendingBuffer.has_value()) {
+        return 0;
+    }
+    datagram = {ring.storage.data() + (ring.pendingBuffer.value() * ring.bufferSize), static_cast<std::size_t>(result)};
+    return result;
+}
+
+#else
+
+struct UringReceiver::Ring
+{
+};
+
+auto UringReceiver::create(const int /*socketFd*/, const std::size_t /*bufferSize*/) -> std::unique_ptr<UringReceiver>
+{
+    spdlog::warn("Built without io_uring support, configure with -DWITH_IO_URING=ON");
+    return nullptr;
+}
+
+auto UringReceiver::fileDescriptor() const -> int
+{
+    return -1;
+}
+
+auto UringReceiver::buffersRanOut() const -> std::size_t
+{
+    return 0;
+}
+
+auto UringReceiver::receive(std::span<const uint8_t>& /*datagram*/) -> ssize_t
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
+
+UringReceiver::UringReceiver(std::unique_ptr<Ring> ring)
+    : m_ring {std::move(ring)}
+{
+}
+
+UringReceiver::~UringReceiver() = default;
+
+}  // namespace monkas::monitor
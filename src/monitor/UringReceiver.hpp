@@ -0,0 +1,59 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include <sys/types.h>
+
+namespace monkas::monitor
+{
+
+/**
+ * @brief Receives the datagrams of a socket through a multishot receive of io_uring into a ring of provided buffers.
+ *
+ * A single armed receive keeps moving datagrams into the buffers as they arrive, so picking one up costs no syscall,
+ * and a buffer goes back to the kernel without copying once its datagram was processed. Only available when built
+ * with WITH_IO_URING, create() returns nullptr otherwise or if the kernel lacks multishot receives (Linux 6.0).
+ *
+ * Running out of buffers ends the multishot receive with ENOBUFS, just like an overflow of the socket receive queue.
+ * Only the latter loses datagrams, it is told apart by the drop counter of the socket.
+ */
+class UringReceiver
+{
+  public:
+    static auto create(int socketFd, std::size_t bufferSize) -> std::unique_ptr<UringReceiver>;
+
+    ~UringReceiver();
+    UringReceiver(const UringReceiver&) = delete;
+    UringReceiver(UringReceiver&&) = delete;
+    auto operator=(const UringReceiver&) -> UringReceiver& = delete;
+    auto operator=(UringReceiver&&) -> UringReceiver& = delete;
+
+    /* @note: readable while completions are pending, e.g. for epoll */
+    [[nodiscard]] auto fileDescriptor() const -> int;
+
+    /**
+     * @brief Picks up the next received datagram without blocking, handing the buffer of the previous one back.
+     *
+     * @param datagram set to the received datagram, valid until the next call.
+     * @return the size of the datagram, or -1 with errno set like recv(), EAGAIN if nothing was received, ENOSPC if the
+     * datagram did not fit a buffer and is lost.
+     */
+    auto receive(std::span<const uint8_t>& datagram) -> ssize_t;
+
+    // how often the multishot receive ended as the kernel had no buffer left
+    [[nodiscard]] auto buffersRanOut() const -> std::size_t;
+
+  private:
+    struct Ring;
+
+    explicit UringReceiver(std::unique_ptr<Ring> ring);
+
+    std::unique_ptr<Ring> m_ring;
+};
+
+}  // namespace monkas::monitor
@@ -0,0 +1,136 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <array>
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <monitor/UringReceiver.hpp>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using namespace monkas::monitor;
+
+constexpr std::size_t BUFFER_SIZE = 64;
+
+class SocketPair
+{
+  public:
+    SocketPair() { REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, m_fds.data()) == 0); }
+
+    ~SocketPair()
+    {
+        close(m_fds[0]);
+        close(m_fds[1]);
+    }
+
+    void send(const std::string_view payload) const
+    {
+        REQUIRE(::send(m_fds[0], payload.data(), payload.size(), 0) == static_cast<ssize_t>(payload.size()));
+    }
+
+    [[nodiscard]] auto receiving() const -> int { return m_fds[1]; }
+
+  private:
+    std::array<int, 2> m_fds {};
+};
+
+auto asString(const std::span<const uint8_t> datagram) -> std::string_view
+{
+    return {reinterpret_cast<const char*>(datagram.data()), datagram.size()};
+}
+
+TEST_SUITE("[monitor::UringReceiver]")
+{
+    TEST_CASE("datagrams are received in order")
+    {
+        const SocketPair pair;
+        const auto receiver = UringReceiver::create(pair.receiving(), BUFFER_SIZE);
+        if (!receiver) {
+            MESSAGE("io_uring multishot receives are not available");
+            return;
+        }
+        std::span<const uint8_t> datagram;
+        CHECK(receiver->receive(datagram) == -1);
+        CHECK(errno == EAGAIN);
+
+        pair.send("first");
+        pair.send("second");
+        REQUIRE(receiver->receive(datagram) == 5);
+        CHECK(asString(datagram) == "first");
+        REQUIRE(receiver->receive(datagram) == 6);
+        CHECK(asString(datagram) == "second");
+        CHECK(receiver->receive(datagram) == -1);
+        CHECK(errno == EAGAIN);
+    }
+
+    TEST_CASE("buffers are handed back to the kernel")
+    {
+        const SocketPair pair;
+        const auto receiver = UringReceiver::create(pair.receiving(), BUFFER_SIZE);
+        if (!receiver) {
+            return;
+        }
+        std::span<const uint8_t> datagram;
+        for (int i = 0; i < 1000; ++i) {
+            const auto payload = std::to_string(i);
+            pair.send(payload);
+            REQUIRE(receiver->receive(datagram) == static_cast<ssize_t>(payload.size()));
+            CHECK(asString(datagram) == payload);
+        }
+    }
+
+    TEST_CASE("running out of buffers loses nothing")
+    {
+        const SocketPair pair;
+        const auto receiver = UringReceiver::create(pair.receiving(), BUFFER_SIZE);
+        if (!receiver) {
+            return;
+        }
+        std::vector<std::string> sent;
+        for (int i = 0; i < 100; ++i) {
+            sent.push_back(std::to_string(i));
+            pair.send(sent.back());
+        }
+        // the datagrams the buffers did not take stayed on the socket and are picked up once the receive is armed again
+        std::vector<std::string> received;
+        std::span<const uint8_t> datagram;
+        for (int attempt = 0; attempt < 1000 && received.size() < sent.size(); ++attempt) {
+            if (receiver->receive(datagram) > 0) {
+                received.emplace_back(asString(datagram));
+            } else {
+                REQUIRE(errno == EAGAIN);
+            }
+        }
+        CHECK(received == sent);
+        CHECK(receiver->buffersRanOut() > 0);
+        CHECK(receiver->receive(datagram) == -1);
+        CHECK(errno == EAGAIN);
+    }
+
+    TEST_CASE("truncated datagrams are reported")
+    {
+        const SocketPair pair;
+        const auto receiver = UringReceiver::create(pair.receiving(), BUFFER_SIZE);
+        if (!receiver) {
+            return;
+        }
+        std::span<const uint8_t> datagram;
+        pair.send(std::string(BUFFER_SIZE + 1, 'x'));
+        pair.send("next");
+        CHECK(receiver->receive(datagram) == -1);
+        CHECK(errno == ENOSPC);
+        REQUIRE(receiver->receive(datagram) == 4);
+        CHECK(asString(datagram) == "next");
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
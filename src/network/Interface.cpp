@@ -33,15 +33,20 @@ auto Interface::fromIndex(std::uint32_t index) -> Interface
     return Interface {index, intfName};
 }
 
-Interface::Interface(const uint32_t index, std::string name)
+Interface::Interface(const uint32_t index, std::string name, const int32_t namespaceId)
     : m_index {index}
     , m_name {std::move(name)}
+    , m_namespaceId {namespaceId}
 {
 }
 
 auto operator<<(std::ostream& os, const Interface& iface) -> std::ostream&
 {
-    return os << iface.index() << ": " << iface.name() << ":";
+    os << iface.index() << ": " << iface.name() << ":";
+    if (!iface.isInOwnNamespace()) {
+        os << " nsid " << iface.namespaceId();
+    }
+    return os;
 }
 
 }  // namespace monkas::network
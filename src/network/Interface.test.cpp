@@ -5,6 +5,7 @@
 #include <tuple>
 
 #include <doctest/doctest.h>
+#include <fmt/format.h>
 #include <network/Interface.hpp>
 
 namespace
@@ -61,6 +62,19 @@ TEST_SUITE("[network::Interface]")
         CHECK(someInterface >= defaultInterface);
         CHECK(renamedSomeInterface >= defaultInterface);
     }
+
+    TEST_CASE("interfaces of other namespaces")
+    {
+        const Interface peerInterface(1, "some", 3);
+        CHECK(someInterface.isInOwnNamespace());
+        CHECK_FALSE(peerInterface.isInOwnNamespace());
+        CHECK(peerInterface.namespaceId() == 3);
+        CHECK(peerInterface != someInterface);
+        CHECK(someInterface < peerInterface);
+        CHECK(peerInterface == Interface(1, "renamed", 3));
+        CHECK(fmt::format("{}", someInterface) == "1: some:");
+        CHECK(fmt::format("{}", peerInterface) == "1: some: nsid 3");
+    }
 }
 
 // NOLINTEND(*)
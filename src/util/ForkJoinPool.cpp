@@ -0,0 +1,70 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <pthread.h>
+#include <util/ForkJoinPool.hpp>
+
+namespace monkas::util
+{
+
+ForkJoinPool::ForkJoinPool(const std::size_t lanes, const std::string& threadName)
+{
+    for (std::size_t lane = 1; lane < lanes; ++lane) {
+        m_threads.emplace_back([this, lane] { workerLoop(lane); });
+        // thread names are cut at 15 characters by the kernel
+        const auto name = (threadName + "-" + std::to_string(lane)).substr(0, 15);
+        pthread_setname_np(m_threads.back().native_handle(), name.c_str());
+    }
+}
+
+ForkJoinPool::~ForkJoinPool()
+{
+    m_stopping = true;
+    m_generation.fetch_add(1, std::memory_order_release);
+    m_generation.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ForkJoinPool::run(const Work& work)
+{
+    if (m_threads.empty()) {
+        work(0);
+        return;
+    }
+    m_work = &work;
+    m_pending.store(m_threads.size(), std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+    m_generation.notify_all();
+    work(0);
+    for (auto pending = m_pending.load(std::memory_order_acquire); pending != 0;
+         pending = m_pending.load(std::memory_order_acquire))
+    {
+        m_pending.wait(pending, std::memory_order_acquire);
+    }
+}
+
+/**
+ * @brief Runs the work of every generation once.
+ *
+ * run() waits for all lanes before bumping the generation again, so no generation is missed. A thread starting late
+ * finds the generation bumped already and does not wait.
+ */
+void ForkJoinPool::workerLoop(const std::size_t lane)
+{
+    uint32_t seen = 0;
+    for (;;) {
+        m_generation.wait(seen, std::memory_order_acquire);
+        seen = m_generation.load(std::memory_order_acquire);
+        if (m_stopping.load()) {
+            return;
+        }
+        (*m_work)(lane);
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_pending.notify_one();
+        }
+    }
+}
+
+}  // namespace monkas::util
@@ -0,0 +1,53 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace monkas::util
+{
+
+/**
+ * @brief Runs the same work on a fixed number of lanes in parallel and waits until all of them are done.
+ *
+ * Lane 0 runs on the calling thread, every other lane on a thread of its own kept for the lifetime of the pool. The
+ * threads sleep on a futex in between, so an idle pool costs nothing but its threads.
+ */
+class ForkJoinPool
+{
+  public:
+    using Work = std::function<void(std::size_t lane)>;
+
+    /* @note: a pool of a single lane runs everything on the calling thread */
+    ForkJoinPool(std::size_t lanes, const std::string& threadName);
+    ~ForkJoinPool();
+    ForkJoinPool(const ForkJoinPool&) = delete;
+    ForkJoinPool(ForkJoinPool&&) = delete;
+    auto operator=(const ForkJoinPool&) -> ForkJoinPool& = delete;
+    auto operator=(ForkJoinPool&&) -> ForkJoinPool& = delete;
+
+    [[nodiscard]] auto lanes() const -> std::size_t { return m_threads.size() + 1; }
+
+    /* @note: work must not throw, it runs once per lane and everything it did is visible once run() returns */
+    void run(const Work& work);
+
+  private:
+    void workerLoop(std::size_t lane);
+
+    const Work* m_work {nullptr};
+    // bumped once per run() and to stop, the threads wait on it
+    std::atomic<uint32_t> m_generation {0};
+    // the lanes of the current run() still working, the calling thread waits on it
+    std::atomic<std::size_t> m_pending {0};
+    std::atomic<bool> m_stopping {false};
+    std::vector<std::thread> m_threads;
+};
+
+}  // namespace monkas::util
@@ -0,0 +1,62 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <util/ForkJoinPool.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using monkas::util::ForkJoinPool;
+
+TEST_SUITE("[util::ForkJoinPool]")
+{
+    TEST_CASE("a single lane runs on the calling thread")
+    {
+        ForkJoinPool pool(1, "test");
+        CHECK(pool.lanes() == 1);
+        std::thread::id ranOn;
+        pool.run([&ranOn](std::size_t) { ranOn = std::this_thread::get_id(); });
+        CHECK(ranOn == std::this_thread::get_id());
+    }
+
+    TEST_CASE("every lane runs once per run on a thread of its own")
+    {
+        ForkJoinPool pool(4, "test");
+        CHECK(pool.lanes() == 4);
+        std::vector<std::thread::id> threads(4);
+        std::vector<int> runs(4);
+        for (int round = 0; round < 100; ++round) {
+            pool.run(
+                [&](std::size_t lane)
+                {
+                    threads[lane] = std::this_thread::get_id();
+                    ++runs[lane];
+                });
+        }
+        CHECK(runs == std::vector<int> {100, 100, 100, 100});
+        CHECK(threads[0] == std::this_thread::get_id());
+        CHECK(std::set<std::thread::id>(threads.begin(), threads.end()).size() == 4);
+    }
+
+    TEST_CASE("the results of all lanes are visible once run returns")
+    {
+        ForkJoinPool pool(3, "test");
+        std::vector<uint64_t> sums(3);
+        for (uint64_t round = 1; round <= 1000; ++round) {
+            pool.run([&](std::size_t lane) { sums[lane] += round; });
+            CHECK(sums[0] == sums[1]);
+            CHECK(sums[1] == sums[2]);
+        }
+        CHECK(sums[0] == 500500);
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
@@ -0,0 +1,78 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace monkas::util
+{
+
+/**
+ * @brief Holds a trivially copyable value written by a single thread and read by any number of threads without locks.
+ *
+ * The writer never waits for readers, a reader copies the value and retries if the writer stored a new one meanwhile.
+ * The value is kept in atomic words, so a torn copy is discarded rather than being a data race.
+ */
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock only holds trivially copyable values");
+    static_assert(std::is_default_constructible_v<T>, "SeqLock only holds default constructible values");
+
+  public:
+    SeqLock() { store(T {}); }
+
+    explicit SeqLock(const T& value) { store(value); }
+
+    // writer only
+    void store(const T& value)
+    {
+        std::array<uint64_t, WORDS> words {};
+        std::memcpy(words.data(), &value, sizeof(T));
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto load() const -> T
+    {
+        std::array<uint64_t, WORDS> words {};
+        for (;;) {
+            const auto before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1U) != 0) {
+                // the writer may have been preempted in the middle of a store
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; ++i) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+  private:
+    static constexpr std::size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    // odd while the writer stores a value
+    std::atomic<uint64_t> m_sequence {0};
+    std::array<std::atomic<uint64_t>, WORDS> m_words {};
+};
+
+}  // namespace monkas::util
@@ -0,0 +1,85 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace monkas::util
+{
+
+/**
+ * @brief A bounded lock-free queue between a single producer and a single consumer thread, filled and drained in place.
+ *
+ * The slots are allocated once and reused, the producer fills the one of producerSlot() and publishes it with push(),
+ * the consumer reads the one of consumerSlot() and hands it back with pop(). Each side caches the index of the other,
+ * so the cache line of the other side is only read once the ring looked full or empty.
+ */
+template<typename T>
+class SpscRing
+{
+  public:
+    /* @note: the capacity is rounded up to a power of two */
+    explicit SpscRing(const std::size_t capacity, const T& prototype = {})
+        : m_slots(std::bit_ceil(capacity == 0 ? 1U : capacity), prototype)
+        , m_mask {m_slots.size() - 1}
+    {
+    }
+
+    [[nodiscard]] auto capacity() const -> std::size_t { return m_slots.size(); }
+
+    /* @note: exact only on the producer or consumer thread while the other side is idle */
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    // the slot to fill next, nullptr if the ring is full, producer only
+    [[nodiscard]] auto producerSlot() -> T*
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_slots.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_slots.size()) {
+                return nullptr;
+            }
+        }
+        return &m_slots[tail & m_mask];
+    }
+
+    // publishes the slot of producerSlot()
+    void push() { m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // the slot to read next, nullptr if the ring is empty, consumer only
+    [[nodiscard]] auto consumerSlot() -> T*
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return nullptr;
+            }
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    // hands the slot of consumerSlot() back to the producer
+    void pop() { m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+    // written by the consumer
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_head {0};
+    std::size_t m_cachedTail {0};
+    // written by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail {0};
+    std::size_t m_cachedHead {0};
+};
+
+}  // namespace monkas::util
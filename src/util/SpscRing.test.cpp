@@ -0,0 +1,99 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <doctest/doctest.h>
+#include <util/SpscRing.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using monkas::util::SpscRing;
+
+TEST_SUITE("[util::SpscRing]")
+{
+    TEST_CASE("capacity is rounded up to a power of two")
+    {
+        CHECK(SpscRing<int>(0).capacity() == 1);
+        CHECK(SpscRing<int>(5).capacity() == 8);
+        CHECK(SpscRing<int>(64).capacity() == 64);
+    }
+
+    TEST_CASE("slots are handed over in order until the ring is full")
+    {
+        SpscRing<int> ring(4);
+        CHECK(ring.consumerSlot() == nullptr);
+        for (int i = 0; i < 4; ++i) {
+            auto* slot = ring.producerSlot();
+            REQUIRE(slot != nullptr);
+            *slot = i;
+            ring.push();
+        }
+        CHECK(ring.size() == 4);
+        CHECK(ring.producerSlot() == nullptr);
+        for (int i = 0; i < 4; ++i) {
+            const auto* slot = ring.consumerSlot();
+            REQUIRE(slot != nullptr);
+            CHECK(*slot == i);
+            ring.pop();
+            CHECK(ring.producerSlot() != nullptr);
+        }
+        CHECK(ring.consumerSlot() == nullptr);
+        CHECK(ring.size() == 0);
+    }
+
+    TEST_CASE("slots are reused in place")
+    {
+        SpscRing<std::vector<int>> ring(2, std::vector<int>(16));
+        auto* first = ring.producerSlot();
+        REQUIRE(first != nullptr);
+        CHECK(first->size() == 16);
+        (*first)[0] = 42;
+        ring.push();
+        CHECK(ring.consumerSlot() == first);
+        ring.pop();
+        ring.push();
+        ring.pop();
+        CHECK(ring.producerSlot() == first);
+        CHECK((*first)[0] == 42);
+    }
+
+    TEST_CASE("a producer and a consumer thread exchange everything in order")
+    {
+        constexpr uint64_t COUNT = 200000;
+        SpscRing<uint64_t> ring(8);
+        std::thread producer(
+            [&ring]
+            {
+                for (uint64_t i = 0; i < COUNT;) {
+                    if (auto* slot = ring.producerSlot(); slot != nullptr) {
+                        *slot = i++;
+                        ring.push();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        uint64_t expected = 0;
+        bool inOrder = true;
+        while (expected < COUNT) {
+            if (const auto* slot = ring.consumerSlot(); slot != nullptr) {
+                inOrder = inOrder && *slot == expected;
+                ++expected;
+                ring.pop();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        CHECK(inOrder);
+        CHECK(ring.size() == 0);
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
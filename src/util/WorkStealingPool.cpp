@@ -0,0 +1,93 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <algorithm>
+
+#include <pthread.h>
+#include <util/WorkStealingPool.hpp>
+
+namespace monkas::util
+{
+namespace
+{
+// the pool the current thread belongs to and its queue, if any
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local std::size_t t_worker = 0;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(const std::size_t threads, const std::string& threadName)
+    : m_queueCount {std::max<std::size_t>(threads, 1U)}
+    , m_queues {std::make_unique<Queue[]>(m_queueCount)}
+{
+    for (std::size_t worker = 0; worker < m_queueCount; ++worker) {
+        m_threads.emplace_back([this, worker] { workerLoop(worker); });
+        // thread names are cut at 15 characters by the kernel
+        const auto name = (threadName + "-" + std::to_string(worker)).substr(0, 15);
+        pthread_setname_np(m_threads.back().native_handle(), name.c_str());
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    m_stopping = true;
+    m_queued.fetch_add(1, std::memory_order_release);
+    m_queued.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    const auto queue = t_pool == this ? t_worker : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % threads();
+    {
+        const std::scoped_lock lock {m_queues[queue].mutex};
+        m_queues[queue].tasks.push_back(std::move(task));
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+    m_queued.notify_one();
+}
+
+void WorkStealingPool::workerLoop(const std::size_t worker)
+{
+    t_pool = this;
+    t_worker = worker;
+    Task task;
+    while (!m_stopping.load()) {
+        if (take(worker, task)) {
+            task();
+            task = nullptr;
+            m_tasksRun.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // a task counted but not taken yet keeps this from sleeping, it is taken right away
+        m_queued.wait(0, std::memory_order_acquire);
+    }
+}
+
+/**
+ * @brief Takes the newest task of the own queue, or else the oldest of another queue.
+ */
+auto WorkStealingPool::take(const std::size_t worker, Task& task) -> bool
+{
+    for (std::size_t offset = 0; offset < threads(); ++offset) {
+        auto& queue = m_queues[(worker + offset) % threads()];
+        const std::scoped_lock lock {queue.mutex};
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            m_tasksStolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_queued.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace monkas::util
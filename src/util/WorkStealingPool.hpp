@@ -0,0 +1,75 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace monkas::util
+{
+
+/**
+ * @brief Runs independent tasks on a fixed number of threads, each with a queue of its own.
+ *
+ * A task submitted from a thread of the pool is queued on that thread, which runs its own queue newest first while
+ * the data of the task is still warm. A thread running out of tasks steals the oldest task of the others, so a few
+ * busy queues keep all threads busy. Idle threads sleep on a futex.
+ */
+class WorkStealingPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    /* @note: a pool has at least one thread */
+    WorkStealingPool(std::size_t threads, const std::string& threadName);
+    /* @note: waits for the running tasks, the queued ones are dropped */
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool(WorkStealingPool&&) = delete;
+    auto operator=(const WorkStealingPool&) -> WorkStealingPool& = delete;
+    auto operator=(WorkStealingPool&&) -> WorkStealingPool& = delete;
+
+    [[nodiscard]] auto threads() const -> std::size_t { return m_queueCount; }
+
+    /* @note: thread safe, a task must not throw */
+    void submit(Task task);
+
+    [[nodiscard]] auto tasksRun() const -> uint64_t { return m_tasksRun.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] auto tasksStolen() const -> uint64_t { return m_tasksStolen.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    struct alignas(CACHE_LINE_SIZE) Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(std::size_t worker);
+    auto take(std::size_t worker, Task& task) -> bool;
+
+    // one per thread, fixed before the threads start
+    const std::size_t m_queueCount;
+    std::unique_ptr<Queue[]> m_queues;
+    // the tasks queued on all queues, the idle threads wait on it
+    std::atomic<std::size_t> m_queued {0};
+    // where tasks submitted from outside the pool go next
+    std::atomic<std::size_t> m_nextQueue {0};
+    std::atomic<bool> m_stopping {false};
+    std::atomic<uint64_t> m_tasksRun {0};
+    std::atomic<uint64_t> m_tasksStolen {0};
+    std::vector<std::thread> m_threads;
+};
+
+}  // namespace monkas::util
@@ -0,0 +1,82 @@
+// Copyright 2023-2025 hrzlgnm
+// SPDX-License-Identifier: MIT-0
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <set>
+#include <thread>
+
+#include <doctest/doctest.h>
+#include <util/WorkStealingPool.hpp>
+
+namespace
+{
+
+// NOLINTBEGIN(*)
+using monkas::util::WorkStealingPool;
+
+TEST_SUITE("[util::WorkStealingPool]")
+{
+    TEST_CASE("every submitted task runs once on a thread of the pool")
+    {
+        std::atomic<int> runs {0};
+        std::latch done {1000};
+        {
+            WorkStealingPool pool(3, "test");
+            CHECK(pool.threads() == 3);
+            for (int i = 0; i < 1000; ++i) {
+                pool.submit(
+                    [&]
+                    {
+                        CHECK(std::this_thread::get_id() != std::thread::id {});
+                        ++runs;
+                        done.count_down();
+                    });
+            }
+            done.wait();
+            CHECK(pool.tasksRun() <= 1000);
+        }
+        CHECK(runs.load() == 1000);
+    }
+
+    TEST_CASE("idle threads steal the tasks queued on a busy one")
+    {
+        WorkStealingPool pool(4, "test");
+        std::latch done {64};
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        // all tasks are queued on the thread running the first one, the others only get to them by stealing
+        pool.submit(
+            [&]
+            {
+                for (int i = 0; i < 64; ++i) {
+                    pool.submit(
+                        [&]
+                        {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            {
+                                const std::scoped_lock lock {mutex};
+                                threads.insert(std::this_thread::get_id());
+                            }
+                            done.count_down();
+                        });
+                }
+            });
+        done.wait();
+        CHECK(pool.tasksStolen() > 0);
+        CHECK(threads.size() > 1);
+    }
+
+    TEST_CASE("a pool of no threads has one")
+    {
+        WorkStealingPool pool(0, "test");
+        CHECK(pool.threads() == 1);
+        std::latch done {1};
+        pool.submit([&] { done.count_down(); });
+        done.wait();
+    }
+}
+
+// NOLINTEND(*)
+}  // namespace
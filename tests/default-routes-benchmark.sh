@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Copyright 2023-2025 hrzlgnm
+# SPDX-License-Identifier: MIT-0
+
+# default-routes-benchmark.sh
+# Usage: sudo ./default-routes-benchmark.sh COUNT [RUNS]
+#
+# Fills the main routing table of a scratch network namespace with COUNT prefixes and a default route, then compares
+# the enumeration time of monka with and without --default-routes-only.
+
+set -euo pipefail
+
+if [ "${EUID:-$(id -u)}" -ne 0 ]; then
+    echo "Please run as root (sudo)." >&2
+    exit 1
+fi
+
+if [ ! -x ../build/examples/cli/monka ]; then
+    echo "Error: monka binary not found or not executable. Please build the project first." >&2
+    exit 1
+fi
+
+if ! [[ "${1:-}" =~ ^[0-9]+$ ]] || [ "${1:-0}" -le 0 ] || ! [[ "${2:-5}" =~ ^[0-9]+$ ]] || [ "${2:-5}" -le 0 ]; then
+    echo "Usage: $0 COUNT [RUNS]  (COUNT and RUNS must be positive integers)" >&2
+    exit 1
+fi
+
+COUNT=$1
+RUNS=${2:-5}
+NS=monkas-bench-$$
+
+cleanup() {
+    ip netns del "$NS" >/dev/null 2>&1 || true
+}
+trap cleanup INT TERM EXIT
+
+ip netns add "$NS"
+ip -n "$NS" link set lo up
+ip -n "$NS" link add bench0 type veth peer name bench1
+ip -n "$NS" addr add 192.168.9.1/24 dev bench0
+ip -n "$NS" link set bench0 up
+ip -n "$NS" link set bench1 up
+ip -n "$NS" route add default via 192.168.9.254 dev bench0
+
+printf "Adding %d routes... " "$COUNT"
+for ((i = 0; i < COUNT; i++)); do
+    printf "route add %d.%d.%d.0/24 via 192.168.9.2\n" $((10 + (i >> 16))) $(((i >> 8) & 255)) $((i & 255))
+done | ip -n "$NS" -batch -
+echo "done"
+
+measure() {
+    local total=0
+    for ((run = 0; run < RUNS; run++)); do
+        local start end
+        start=$(date +%s%N)
+        ip netns exec "$NS" ../build/examples/cli/monka --exit-after-enumeration --log-level warn "$@"
+        end=$(date +%s%N)
+        total=$((total + end - start))
+    done
+    echo "$((total / RUNS / 1000000))"
+}
+
+full=$(measure)
+echo "full route dump:           ${full}ms per enumeration"
+default_only=$(measure --default-routes-only)
+echo "main table dump, defaults: ${default_only}ms per enumeration"
@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+# Copyright 2023-2025 hrzlgnm
+# SPDX-License-Identifier: MIT-0
+
+# io-uring-benchmark.sh
+# Usage: sudo ./io-uring-benchmark.sh COUNT [RUNS]
+#
+# Replays the same COUNT route additions and removals in a scratch network namespace while monka follows them, once
+# receiving with recvmsg and once through io_uring, and compares how long monka took to catch up and how much CPU time
+# it used. Requires monka to be built with -DWITH_IO_URING=ON.
+
+set -euo pipefail
+
+if [ "${EUID:-$(id -u)}" -ne 0 ]; then
+    echo "Please run as root (sudo)." >&2
+    exit 1
+fi
+
+if [ ! -x ../build/examples/cli/monka ]; then
+    echo "Error: monka binary not found or not executable. Please build the project first." >&2
+    exit 1
+fi
+
+if ! [[ "${1:-}" =~ ^[0-9]+$ ]] || [ "${1:-0}" -le 0 ] || [ "${1:-0}" -gt 65000 ] || ! [[ "${2:-5}" =~ ^[0-9]+$ ]] \
+    || [ "${2:-5}" -le 0 ]; then
+    echo "Usage: $0 COUNT [RUNS]  (COUNT must be a positive integer up to 65000, RUNS a positive integer)" >&2
+    exit 1
+fi
+
+COUNT=$1
+RUNS=${2:-5}
+NS=monkas-bench-$$
+BATCH=$(mktemp)
+LOG=$(mktemp)
+CLK_TCK=$(getconf CLK_TCK)
+MONKA_PID=
+
+cleanup() {
+    if [ -n "$MONKA_PID" ]; then
+        kill "$MONKA_PID" >/dev/null 2>&1 || true
+    fi
+    ip netns del "$NS" >/dev/null 2>&1 || true
+    rm -f "$BATCH" "$LOG"
+}
+trap cleanup INT TERM EXIT
+
+ip netns add "$NS"
+ip -n "$NS" link set lo up
+ip -n "$NS" link add bench0 type veth peer name bench1
+ip -n "$NS" link set bench0 up
+ip -n "$NS" link set bench1 up
+ip -n "$NS" addr add 192.168.9.1/24 dev bench0
+
+# monka parses every route notification but only logs gateway changes, which these routes are not
+for ((i = 0; i < COUNT; i++)); do
+    printf "route add 10.%d.%d.0/24 via 192.168.9.2\n" $((i >> 8)) $((i & 255))
+done >"$BATCH"
+for ((i = 0; i < COUNT; i++)); do
+    printf "route del 10.%d.%d.0/24 via 192.168.9.2\n" $((i >> 8)) $((i & 255))
+done >>"$BATCH"
+
+wait_for_log() {
+    for ((tries = 0; tries < 6000; tries++)); do
+        if grep -q "$1" "$LOG"; then
+            return 0
+        fi
+        sleep 0.01
+    done
+    echo "Error: monka did not log '$1' in time" >&2
+    exit 1
+}
+
+measure() {
+    local total_ms=0 total_cpu_ms=0
+    for ((run = 0; run < RUNS; run++)); do
+        ip netns exec "$NS" ../build/examples/cli/monka --log-level info "$@" >"$LOG" 2>&1 &
+        MONKA_PID=$!
+        wait_for_log "Found"
+        if grep -q "Falling back" "$LOG"; then
+            echo "Error: monka cannot receive through io_uring, build it with -DWITH_IO_URING=ON" >&2
+            exit 1
+        fi
+        local start end
+        start=$(date +%s%N)
+        ip -n "$NS" -batch "$BATCH"
+        # monka has caught up once it reports the interface added after the replayed changes
+        ip -n "$NS" link add sentinel type veth peer name sentinel1
+        wait_for_log " sentinel"
+        end=$(date +%s%N)
+        local ticks
+        ticks=$(awk '{ print $14 + $15 }' "/proc/$MONKA_PID/stat")
+        kill "$MONKA_PID"
+        wait "$MONKA_PID" || true
+        MONKA_PID=
+        ip -n "$NS" link del sentinel
+        total_ms=$((total_ms + (end - start) / 1000000))
+        total_cpu_ms=$((total_cpu_ms + ticks * 1000 / CLK_TCK))
+    done
+    echo "$((total_ms / RUNS))ms to catch up, $((total_cpu_ms / RUNS))ms of CPU time"
+}
+
+echo "replaying $((2 * COUNT)) route changes, $RUNS runs each"
+printf "recvmsg:  "
+measure
+printf "io_uring: "
+measure --io-uring-receive
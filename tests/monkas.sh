@@ -3,7 +3,8 @@
 # SPDX-License-Identifier: MIT-0
 
 # monkas.sh
-# Usage: ./monkas.sh COUNT
+# Usage: ./monkas.sh COUNT [shared]
+# With shared, a single monka monitors and COUNT monkas read the snapshots it publishes in shared memory
 
 set -euo pipefail
 
@@ -13,11 +14,13 @@ if [ ! -x ../build/examples/cli/monka ]; then
 fi
 
 if [ $# -lt 1 ]; then
-    echo "Usage: $0 COUNT" >&2
+    echo "Usage: $0 COUNT [shared]" >&2
     exit 1
 fi
 
 COUNT="$1"
+MODE="${2:-}"
+SHARED_SNAPSHOTS=/dev/shm/monkas
 
 if ! [[ "$COUNT" =~ ^[0-9]+$ ]] || [ "$COUNT" -le 0 ]; then
     echo "COUNT must be a positive integer" >&2
@@ -50,8 +53,19 @@ trap cleanup INT TERM EXIT
 
 printf "Cleaning up old monka logs... "
 rm -f /tmp/monka-*.log
+if [ "$MODE" = "shared" ]; then
+    ../build/examples/cli/monka --shared_snapshots "$SHARED_SNAPSHOTS" --log-to-file &
+    pids+=("$!")
+    launched_info+=("PID=$! publishing $SHARED_SNAPSHOTS")
+    # the readers need the segment to exist
+    sleep 0.5
+fi
 for ((i = 0; i < COUNT; i++)); do
-    ../build/examples/cli/monka --enum-loop 0 --log-to-file &
+    if [ "$MODE" = "shared" ]; then
+        ../build/examples/cli/monka --read_shared_snapshots "$SHARED_SNAPSHOTS" --log-to-file &
+    else
+        ../build/examples/cli/monka --enum-loop 0 --log-to-file &
+    fi
     pid=$!
     pids+=("$pid")
     # store info to show to user